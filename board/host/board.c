@@ -109,6 +109,10 @@ const unsigned int i2c_ports_used = ARRAY_SIZE(i2c_ports);
 const struct spi_device_t spi_devices[] = {
 	/* Fingerprint sensor (SCLK at 4Mhz) */
 	{ CONFIG_SPI_FP_PORT, 3, GPIO_SPI1_NSS },
+#ifdef CONFIG_SPI_NOR
+	/* Serial NOR Flash */
+	{ CONFIG_SPI_FP_PORT, 0, GPIO_SPI1_NSS },
+#endif
 };
 
 const unsigned int spi_devices_used = ARRAY_SIZE(spi_devices);
@@ -94,6 +94,7 @@ const uint8_t rgbkbd_count = ARRAY_SIZE(rgbkbds);
 
 const uint8_t rgbkbd_hsize = RGB_GRID0_COL;
 const uint8_t rgbkbd_vsize = RGB_GRID0_ROW;
+BUILD_ASSERT(RGB_GRID0_COL * RGB_GRID0_ROW <= RGBKBD_MATRIX_MAX_SIZE);
 
 enum ec_rgbkbd_type rgbkbd_type = EC_RGBKBD_TYPE_FOUR_ZONES_40_LEDS;
 
@@ -0,0 +1,15 @@
+/* This file is generated by util/getversion.sh */
+#define CROS_EC_VERSION32 "host_v0.0.49+4df00c6"
+/* Version string for ectool. */
+#define CROS_ECTOOL_VERSION "v0.0.49+4df00c6"
+/* Version string for stm32mon. */
+#define CROS_STM32MON_VERSION "v0.0.49+4df00c6"
+/* Sub-fields for use in Makefile.rules and to form build info string
+ * in common/version.c. */
+#define VERSION "host_v0.0.49+4df00c6"
+#define BUILDER "@vm"
+/* Repo is dirty, using time of most recent file modification. */
+#define DATE "2026-10-18 19:18:43"
+#define CROS_FWID_MISSING_STR "CROS_FWID_MISSING"
+/* CrOS FWID is not available for this build */
+#define CROS_FWID32 CROS_FWID_MISSING_STR
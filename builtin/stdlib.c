@@ -48,8 +48,31 @@ static int snprintf_addchar(void *context, int c)
 	return 0;
 }
 
+/**
+ * Add characters to the string context.
+ *
+ * @param context	Context receiving characters
+ * @param s		Characters to add
+ * @param len		Number of characters to add
+ * @return 0 if all characters added, 1 if some dropped because no space.
+ */
+static int snprintf_addspan(void *context, const char *s, int len)
+{
+	struct snprintf_context *ctx = (struct snprintf_context *)context;
+	int n = MIN(len, ctx->size);
+
+	memcpy(ctx->str, s, n);
+	ctx->str += n;
+	ctx->size -= n;
+	return n < len;
+}
+
 int crec_vsnprintf(char *str, size_t size, const char *format, va_list args)
 {
+	static const struct printf_sink sink = {
+		.addchar = snprintf_addchar,
+		.addspan = snprintf_addspan,
+	};
 	struct snprintf_context ctx;
 	int rv;
 
@@ -59,7 +82,7 @@ int crec_vsnprintf(char *str, size_t size, const char *format, va_list args)
 	ctx.str = str;
 	ctx.size = size - 1; /* Reserve space for terminating '\0' */
 
-	rv = vfnprintf(snprintf_addchar, &ctx, format, args);
+	rv = vfnprintf_sink(&sink, &ctx, format, args);
 
 	/* Terminate string */
 	*ctx.str = '\0';
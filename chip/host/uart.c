@@ -66,6 +66,7 @@ static void uart_interrupt(void)
 {
 	uart_process_input();
 	uart_process_output();
+	fflush(stdout);
 }
 
 int uart_init_done(void)
@@ -109,7 +110,9 @@ void uart_write_char(char c)
 	if (capture_enabled)
 		test_capture_char(c);
 	printf("%c", c);
-	fflush(stdout);
+	/* Output from the interrupt is flushed once it is done. */
+	if (!in_interrupt_context())
+		fflush(stdout);
 }
 
 int uart_read_char(void)
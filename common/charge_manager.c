@@ -88,6 +88,24 @@ static struct charge_port_info available_charge[CHARGE_SUPPLIER_COUNT]
 /* Keep track of when the supplier on each port is registered. */
 static timestamp_t registration_time[CHARGE_PORT_COUNT];
 
+/*
+ * Best supplier on each port, so that a refresh only compares one candidate
+ * per port instead of scanning the whole available_charge table. Entries are
+ * recomputed lazily for the ports flagged in port_best_dirty, which is set
+ * after every available_charge write.
+ */
+static int port_best_supplier[CHARGE_PORT_COUNT];
+static atomic_t port_best_dirty;
+/* Active port that port_best_supplier[] tie-breaks were computed against. */
+static int port_best_active = CHARGE_PORT_NONE;
+BUILD_ASSERT(CHARGE_PORT_COUNT <= 32);
+
+/* Set while a charge_manager_refresh call is scheduled but has not run. */
+static atomic_t refresh_pending;
+
+/* Number of times charge_manager_refresh has run, for tests. */
+test_export_static int charge_manager_refresh_count;
+
 /*
  * Charge current ceiling (mA) for ports. This can be set to temporarily limit
  * the charge pulled from a port, without influencing the port selection logic.
@@ -240,6 +258,7 @@ static void charge_manager_init(void)
 		if (is_pd_port(i) && !IS_ENABLED(CONFIG_USB_PD_TCPMV2))
 			source_port_rp[i] = CONFIG_USB_PD_PULLUP;
 	}
+	atomic_or(&port_best_dirty, GENMASK(CHARGE_PORT_COUNT - 1, 0));
 }
 #ifndef CONFIG_USB_PDC_POWER_MGMT
 DECLARE_HOOK(HOOK_INIT, charge_manager_init, HOOK_PRIO_INIT_CHARGE_MANAGER);
@@ -665,6 +684,70 @@ static int charge_manager_get_ceil(int port)
 	return ceil;
 }
 
+/**
+ * Select the best supplier on a single port, as defined by the supplier
+ * hierarchy and the available power.
+ *
+ * @param port	Charge port to evaluate.
+ * @return	Best supplier on the port, or CHARGE_SUPPLIER_NONE.
+ */
+static int charge_manager_port_best_supplier(int port)
+{
+	int supplier = CHARGE_SUPPLIER_NONE;
+	int best_power = -1, power;
+	int i;
+
+	for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
+		/* Skip this supplier if there is no available charge. */
+		if (available_charge[i][port].current == 0 ||
+		    available_charge[i][port].voltage == 0)
+			continue;
+
+		power = POWER(available_charge[i][port]);
+
+		/*
+		 * Prefer higher priority, then higher power. On the active
+		 * port the later of two equal suppliers wins, which keeps the
+		 * result identical to a full supplier-major scan.
+		 */
+		if (supplier == CHARGE_SUPPLIER_NONE ||
+		    supplier_priority[i] < supplier_priority[supplier] ||
+		    (supplier_priority[i] == supplier_priority[supplier] &&
+		     (power > best_power ||
+		      (power == best_power && charge_port == port)))) {
+			supplier = i;
+			best_power = power;
+		}
+	}
+
+	return supplier;
+}
+
+/**
+ * Recompute port_best_supplier[] for every port whose available charge
+ * changed since the last call.
+ */
+static void charge_manager_update_port_best(void)
+{
+	uint32_t dirty;
+	int i;
+
+	/* Tie-breaks depend on the active port, so redo both ends. */
+	if (port_best_active != charge_port) {
+		if (port_best_active != CHARGE_PORT_NONE)
+			atomic_or(&port_best_dirty, BIT(port_best_active));
+		if (charge_port != CHARGE_PORT_NONE)
+			atomic_or(&port_best_dirty, BIT(charge_port));
+		port_best_active = charge_port;
+	}
+
+	dirty = atomic_clear(&port_best_dirty);
+	for (i = 0; dirty; ++i, dirty >>= 1)
+		if (dirty & 1)
+			port_best_supplier[i] =
+				charge_manager_port_best_supplier(i);
+}
+
 /**
  * Select the best charge port or the override port, as defined by the supplier
  * hierarchy and the available power.
@@ -677,6 +760,7 @@ static void charge_manager_get_best_port(int *new_port, int *new_supplier)
 	int supplier = CHARGE_SUPPLIER_NONE;
 	int port = CHARGE_PORT_NONE;
 	int best_port_power = -1, candidate_port_power;
+	int dps_port = CHARGE_PORT_NONE;
 	int i, j;
 
 	if (override_port == OVERRIDE_DONT_CHARGE) {
@@ -685,86 +769,101 @@ static void charge_manager_get_best_port(int *new_port, int *new_supplier)
 		return;
 	}
 
+	charge_manager_update_port_best();
+
 	/*
 	 * Charge supplier selection logic:
-	 * 1. Prefer DPS charge port.
+	 * 1. Prefer DPS charge port over suppliers of PD priority or lower.
 	 * 2. Prefer higher priority supply.
 	 * 3. Prefer higher power over lower in case priority is tied.
 	 * 4. Prefer current charge port over new port in case (1)
 	 *    and (2) are tied.
+	 * 5. Otherwise prefer the lower supplier, then the lower port.
 	 * available_charge can be changed at any time by other tasks,
 	 * so make no assumptions about its consistency.
 	 */
-	for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
-		for (j = 0; j < CHARGE_PORT_COUNT; ++j) {
-			/* Skip this port if it is not valid. */
-			if (!is_valid_port(j))
-				continue;
-
-			/*
-			 * Skip this supplier if there is no
-			 * available charge.
-			 */
-			if (available_charge[i][j].current == 0 ||
-			    available_charge[i][j].voltage == 0)
-				continue;
+	for (j = 0; j < CHARGE_PORT_COUNT; ++j) {
+		/* Skip this port if it is not valid. */
+		if (!is_valid_port(j))
+			continue;
 
-			/*
-			 * Don't select this port if we have a
-			 * charge on another override port.
-			 */
-			if (override_port != OVERRIDE_OFF &&
-			    override_port == port && override_port != j)
-				continue;
+		/*
+		 * Don't select this port if we have a
+		 * charge on another override port.
+		 */
+		if (override_port != OVERRIDE_OFF && override_port == port &&
+		    override_port != j)
+			continue;
 
 #ifndef CONFIG_CHARGE_MANAGER_DRP_CHARGING
-			/*
-			 * Don't charge from a dual-role port unless
-			 * it is our override port.
-			 */
-			if (dualrole_capability[j] != CAP_DEDICATED &&
-			    override_port != j &&
-			    !charge_manager_spoof_dualrole_capability())
-				continue;
+		/*
+		 * Don't charge from a dual-role port unless
+		 * it is our override port.
+		 */
+		if (dualrole_capability[j] != CAP_DEDICATED &&
+		    override_port != j &&
+		    !charge_manager_spoof_dualrole_capability())
+			continue;
 #endif
 
-			candidate_port_power = POWER(available_charge[i][j]);
+		/*
+		 * Skip this port if there is no available charge.
+		 */
+		i = port_best_supplier[j];
+		if (i == CHARGE_SUPPLIER_NONE)
+			continue;
 
-			/* Select DPS port if provided. */
-			if (IS_ENABLED(CONFIG_USB_PD_DPS) &&
-			    override_port == OVERRIDE_OFF &&
-			    i == CHARGE_SUPPLIER_PD &&
-			    j == dps_get_charge_port()) {
-				supplier = i;
-				port = j;
-				break;
-				/* Select if no supplier chosen yet. */
-			} else if (supplier == CHARGE_SUPPLIER_NONE ||
-				   /* ..or if supplier priority is higher. */
-				   supplier_priority[i] <
-					   supplier_priority[supplier] ||
-				   /* ..or if this is our override port. */
-				   (j == override_port &&
-				    port != override_port) ||
-				   /* ..or if priority is tied and.. */
-				   (supplier_priority[i] ==
-					    supplier_priority[supplier] &&
-				    /*
-				     * candidate port can supply more power or
-				     * ..
-				     */
-				    (candidate_port_power > best_port_power ||
-				     /*
-				      * candidate port is the active
-				      * port and can supply the same
-				      * amount of power.
-				      */
-				     (candidate_port_power == best_port_power &&
-				      charge_port == j)))) {
-				supplier = i;
+		/*
+		 * Select DPS port if provided, unless a higher priority
+		 * supplier has been selected or is available on this port.
+		 */
+		if (IS_ENABLED(CONFIG_USB_PD_DPS) &&
+		    override_port == OVERRIDE_OFF &&
+		    j == dps_get_charge_port() &&
+		    available_charge[CHARGE_SUPPLIER_PD][j].current != 0 &&
+		    available_charge[CHARGE_SUPPLIER_PD][j].voltage != 0 &&
+		    supplier_priority[i] >=
+			    supplier_priority[CHARGE_SUPPLIER_PD]) {
+			if (supplier == CHARGE_SUPPLIER_NONE ||
+			    supplier_priority[supplier] >=
+				    supplier_priority[CHARGE_SUPPLIER_PD]) {
+				supplier = CHARGE_SUPPLIER_PD;
 				port = j;
-				best_port_power = candidate_port_power;
+				best_port_power =
+					POWER(available_charge[supplier][j]);
+				dps_port = j;
 			}
+			continue;
+		}
+
+		candidate_port_power = POWER(available_charge[i][j]);
+
+		/* Only a higher priority supplier displaces the DPS port. */
+		if (port != CHARGE_PORT_NONE && port == dps_port &&
+		    supplier_priority[i] >= supplier_priority[supplier])
+			continue;
+
+		/* Select if no supplier chosen yet. */
+		if (supplier == CHARGE_SUPPLIER_NONE ||
+		    /* ..or if supplier priority is higher. */
+		    supplier_priority[i] < supplier_priority[supplier] ||
+		    /* ..or if this is our override port. */
+		    (j == override_port && port != override_port) ||
+		    /* ..or if priority is tied and.. */
+		    (supplier_priority[i] == supplier_priority[supplier] &&
+		     /* candidate port can supply more power or.. */
+		     (candidate_port_power > best_port_power ||
+		      /*
+		       * candidate port can supply the same amount of power
+		       * and is the active port, or is reached first in
+		       * supplier order and doesn't displace the active port.
+		       */
+		      (candidate_port_power == best_port_power &&
+		       (charge_port == j ||
+			(charge_port != port && i < supplier)))))) {
+			supplier = i;
+			port = j;
+			best_port_power = candidate_port_power;
 		}
 	}
 
@@ -803,6 +902,9 @@ static void charge_manager_refresh(void)
 	int ceil;
 	int power_changed = 0;
 
+	atomic_clear(&refresh_pending);
+	charge_manager_refresh_count++;
+
 	/* Hunt for an acceptable charge port */
 	while (1) {
 		charge_manager_get_best_port(&new_port, &new_supplier);
@@ -849,6 +951,7 @@ static void charge_manager_refresh(void)
 			available_charge[i][new_port].current = 0;
 			available_charge[i][new_port].voltage = 0;
 		}
+		atomic_or(&port_best_dirty, BIT(new_port));
 	}
 
 	active_charge_port_initialized = 1;
@@ -1044,6 +1147,20 @@ static void charge_manager_refresh(void)
 }
 DECLARE_DEFERRED(charge_manager_refresh);
 
+/**
+ * Schedule a charge_manager_refresh for a supplier update. Updates arriving
+ * while a refresh is already pending are folded into it, so a burst of
+ * supplier reports (e.g. dock attach) results in a single decision.
+ */
+static void charge_manager_schedule_refresh(void)
+{
+	if (atomic_or(&refresh_pending, 1))
+		return;
+
+	hook_call_deferred(&charge_manager_refresh_data,
+			   CONFIG_CHARGE_MANAGER_REFRESH_DELAY_MS * MSEC);
+}
+
 /**
  * Called when charge override times out waiting for power swap.
  */
@@ -1142,6 +1259,7 @@ static void charge_manager_make_change(enum charge_manager_change_type change,
 	if (change == CHANGE_CHARGE) {
 		available_charge[supplier][port].current = charge->current;
 		available_charge[supplier][port].voltage = charge->voltage;
+		atomic_or(&port_best_dirty, BIT(port));
 		registration_time[port] = get_time();
 
 		/*
@@ -1176,7 +1294,7 @@ static void charge_manager_make_change(enum charge_manager_change_type change,
 	 * attached.
 	 */
 	if (charge_manager_is_seeded())
-		hook_call_deferred(&charge_manager_refresh_data, 0);
+		charge_manager_schedule_refresh();
 }
 
 void pd_set_input_current_limit(int port, uint32_t max_ma,
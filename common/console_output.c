@@ -5,14 +5,18 @@
 
 /* Console output module for Chrome EC */
 
+#include "atomic.h"
 #include "console.h"
 #include "host_command.h"
 #include "printf.h"
+#include "task.h"
+#include "timer.h"
 #include "uart.h"
 #include "usb_console.h"
 #include "util.h"
 
 #include <stdarg.h>
+#include <stdio.h>
 
 #ifdef CONFIG_CONSOLE_CHANNEL
 /* Default to all channels active */
@@ -80,13 +84,24 @@ bool console_channel_is_disabled(enum console_channel channel)
 /*****************************************************************************/
 /* Channel-based console output */
 
-int cputs(enum console_channel channel, const char *outstr)
+/* Number of writes per channel that lost some or all of their output */
+static atomic_t channel_drops[CC_CHANNEL_COUNT];
+
+static int console_count_drop(enum console_channel channel, int rv)
 {
-	int rv1, rv2;
+	if (rv != EC_SUCCESS && channel < CC_CHANNEL_COUNT)
+		atomic_add(&channel_drops[channel], 1);
+	return rv;
+}
 
-	/* Filter out inactive channels */
-	if (console_channel_is_disabled(channel))
-		return EC_SUCCESS;
+uint32_t console_channel_drops(enum console_channel channel)
+{
+	return channel < CC_CHANNEL_COUNT ? channel_drops[channel] : 0;
+}
+
+static int __cputs(const char *outstr)
+{
+	int rv1, rv2;
 
 	rv1 = usb_puts(outstr);
 	rv2 = uart_puts(outstr);
@@ -94,15 +109,11 @@ int cputs(enum console_channel channel, const char *outstr)
 	return rv1 == EC_SUCCESS ? rv2 : rv1;
 }
 
-int cvprintf(enum console_channel channel, const char *format, va_list args)
+static int __cvprintf(const char *format, va_list args)
 {
 	int rv1, rv2;
 	va_list temp_args;
 
-	/* Filter out inactive channels */
-	if (console_channel_is_disabled(channel))
-		return EC_SUCCESS;
-
 	va_copy(temp_args, args);
 	rv1 = usb_vprintf(format, temp_args);
 	va_end(temp_args);
@@ -114,6 +125,24 @@ int cvprintf(enum console_channel channel, const char *format, va_list args)
 	return rv1 == EC_SUCCESS ? rv2 : rv1;
 }
 
+int cputs(enum console_channel channel, const char *outstr)
+{
+	/* Filter out inactive channels */
+	if (console_channel_is_disabled(channel))
+		return EC_SUCCESS;
+
+	return console_count_drop(channel, __cputs(outstr));
+}
+
+int cvprintf(enum console_channel channel, const char *format, va_list args)
+{
+	/* Filter out inactive channels */
+	if (console_channel_is_disabled(channel))
+		return EC_SUCCESS;
+
+	return console_count_drop(channel, __cvprintf(format, args));
+}
+
 int cprintf(enum console_channel channel, const char *format, ...)
 {
 	int rv;
@@ -126,6 +155,75 @@ int cprintf(enum console_channel channel, const char *format, ...)
 	return rv;
 }
 
+static int __cprintf(const char *format, ...)
+{
+	int rv;
+	va_list args;
+
+	va_start(args, format);
+	rv = __cvprintf(format, args);
+	va_end(args);
+
+	return rv;
+}
+
+#ifdef CONFIG_CONSOLE_LINE_STAGING
+/*
+ * Each task formats its cprints() lines into its own staging buffer, so the
+ * line can be written to the UART in one piece. Interrupts and code running
+ * before the scheduler starts share the last buffer.
+ */
+static char line_staging[TASK_ID_COUNT + 1][CONFIG_CONSOLE_LINE_STAGING];
+static atomic_t shared_staging_busy;
+
+static char *get_line_staging(void)
+{
+	if (!in_interrupt_context() && task_start_called() &&
+	    task_get_current() < TASK_ID_COUNT)
+		return line_staging[task_get_current()];
+
+	if (atomic_or(&shared_staging_busy, 1))
+		return NULL;
+	return line_staging[TASK_ID_COUNT];
+}
+
+static void put_line_staging(char *line)
+{
+	if (line == line_staging[TASK_ID_COUNT])
+		atomic_clear(&shared_staging_busy);
+}
+
+/*
+ * Length of a staged line after appending to it at <len>, given what
+ * vsnprintf() returned. Overlong lines are truncated.
+ */
+static int staged_len(int len, int rv, int size)
+{
+	return (rv < 0 || rv >= size - len) ? size - 1 : len + rv;
+}
+
+static int cvprints_staged(char *line, const char *format, va_list args)
+{
+	/* Leave room for the closing "]\n" */
+	const int size = CONFIG_CONSOLE_LINE_STAGING - 2;
+	char ts_str[PRINTF_TIMESTAMP_BUF_SIZE];
+	int len, rv1, rv2;
+
+	snprintf_timestamp_now(ts_str, sizeof(ts_str));
+	len = staged_len(0, snprintf(line, size, "[%s ", ts_str), size);
+	len = staged_len(len, vsnprintf(line + len, size - len, format, args),
+			 size);
+
+	memcpy(line + len, "]\n", 3);
+	len += 2;
+
+	rv1 = usb_puts(line);
+	rv2 = uart_put_line(line, len);
+
+	return rv1 == EC_SUCCESS ? rv2 : rv1;
+}
+#endif /* CONFIG_CONSOLE_LINE_STAGING */
+
 int cvprints(enum console_channel channel, const char *format, va_list args)
 {
 	int r, rv;
@@ -135,17 +233,30 @@ int cvprints(enum console_channel channel, const char *format, va_list args)
 	if (console_channel_is_disabled(channel))
 		return EC_SUCCESS;
 
+#ifdef CONFIG_CONSOLE_LINE_STAGING
+	{
+		char *line = get_line_staging();
+
+		if (line) {
+			rv = cvprints_staged(line, format, args);
+			put_line_staging(line);
+			return console_count_drop(channel, rv);
+		}
+	}
+#endif
+
 	snprintf_timestamp_now(ts_str, sizeof(ts_str));
-	rv = cprintf(channel, "[%s ", ts_str);
+	rv = __cprintf("[%s ", ts_str);
 
-	r = cvprintf(channel, format, args);
+	r = __cvprintf(format, args);
 	rv = r ? r : rv;
 
-	r = cputs(channel, "]\n");
-	return r ? r : rv;
+	r = __cputs("]\n");
+	return console_count_drop(channel, r ? r : rv);
 }
 
-int cprints(enum console_channel channel, const char *format, ...)
+/* Parenthesized so that the tokenized cprints() macro is not expanded. */
+int(cprints)(enum console_channel channel, const char *format, ...)
 {
 	int rv;
 	va_list args;
@@ -156,6 +267,152 @@ int cprints(enum console_channel channel, const char *format, ...)
 
 	return rv;
 }
+
+#ifdef CONFIG_CONSOLE_TOKENIZED
+/* Largest encoded message; longer messages are truncated. */
+#define TOKENIZED_MSG_SIZE 52
+
+static const char base64_chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/*
+ * Append a zigzag-encoded varint. Returns the new position, or -1 if it
+ * does not fit.
+ */
+static int tokenized_put_varint(uint8_t *msg, int pos, uint64_t zigzag)
+{
+	do {
+		if (pos >= TOKENIZED_MSG_SIZE)
+			return -1;
+		msg[pos++] = (zigzag & 0x7f) | (zigzag > 0x7f ? 0x80 : 0);
+		zigzag >>= 7;
+	} while (zigzag);
+
+	return pos;
+}
+
+static int tokenized_put_int(uint8_t *msg, int pos, int32_t v)
+{
+	return tokenized_put_varint(msg, pos,
+				    ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+static int tokenized_put_int64(uint8_t *msg, int pos, int64_t v)
+{
+	return tokenized_put_varint(msg, pos,
+				    ((uint64_t)v << 1) ^ (uint64_t)(v >> 63));
+}
+
+/*
+ * Append a string as a length byte followed by its characters. Bit 7 of the
+ * length byte is set if the string was truncated.
+ */
+static int tokenized_put_string(uint8_t *msg, int pos, const char *str)
+{
+	int len, n;
+
+	if (pos >= TOKENIZED_MSG_SIZE)
+		return -1;
+	if (!str)
+		str = "NULL";
+
+	len = strlen(str);
+	n = MIN(MIN(len, TOKENIZED_MSG_SIZE - pos - 1), 0x7f);
+	msg[pos++] = n | (n < len ? 0x80 : 0);
+	memcpy(msg + pos, str, n);
+
+	return pos + n;
+}
+
+/* Base64-encode len bytes of msg into out, which must be large enough. */
+static int tokenized_base64(char *out, const uint8_t *msg, int len)
+{
+	char *p = out;
+	uint32_t v;
+	int i;
+
+	for (i = 0; i < len; i += 3) {
+		v = msg[i] << 16;
+		if (i + 1 < len)
+			v |= msg[i + 1] << 8;
+		if (i + 2 < len)
+			v |= msg[i + 2];
+
+		*p++ = base64_chars[(v >> 18) & 0x3f];
+		*p++ = base64_chars[(v >> 12) & 0x3f];
+		*p++ = i + 1 < len ? base64_chars[(v >> 6) & 0x3f] : '=';
+		*p++ = i + 2 < len ? base64_chars[v & 0x3f] : '=';
+	}
+
+	return p - out;
+}
+
+int cprints_tokenized(enum console_channel channel, uint32_t token,
+		      uint32_t types, ...)
+{
+	uint8_t msg[TOKENIZED_MSG_SIZE];
+	/* '$', base64 of msg, '~' and the terminator */
+	char out[1 + DIV_ROUND_UP(TOKENIZED_MSG_SIZE, 3) * 4 + 2];
+	uint64_t now;
+	uint32_t usec;
+	va_list args;
+	int pos;
+	int i;
+
+	/* Filter out inactive channels */
+	if (console_channel_is_disabled(channel))
+		return EC_SUCCESS;
+
+	memcpy(msg, &token, sizeof(token));
+	pos = sizeof(token);
+
+	/* Timestamp, for the "[%u.%06u " prefix of the format */
+	now = get_time().val;
+	usec = uint64divmod(&now, SECOND);
+	pos = tokenized_put_int(msg, pos, now);
+	pos = tokenized_put_int(msg, pos, usec);
+
+	va_start(args, types);
+	for (i = 0; i < TOKENIZER_TYPE_COUNT(types); i++) {
+		int next = -1;
+		float f;
+
+		switch (TOKENIZER_TYPE(types, i)) {
+		case TOKENIZER_ARG_INT:
+			next = tokenized_put_int(msg, pos, va_arg(args, int));
+			break;
+		case TOKENIZER_ARG_INT64:
+			next = tokenized_put_int64(msg, pos,
+						   va_arg(args, int64_t));
+			break;
+		case TOKENIZER_ARG_DOUBLE:
+			f = va_arg(args, double);
+			if (pos + sizeof(f) <= TOKENIZED_MSG_SIZE) {
+				memcpy(msg + pos, &f, sizeof(f));
+				next = pos + sizeof(f);
+			}
+			break;
+		case TOKENIZER_ARG_STRING:
+			next = tokenized_put_string(msg, pos,
+						    va_arg(args, const char *));
+			break;
+		}
+
+		/* Drop the arguments that do not fit */
+		if (next < 0)
+			break;
+		pos = next;
+	}
+	va_end(args);
+
+	out[0] = '$';
+	i = 1 + tokenized_base64(out + 1, msg, pos);
+	out[i++] = '~';
+	out[i] = '\0';
+
+	return cputs(channel, out);
+}
+#endif /* CONFIG_CONSOLE_TOKENIZED */
 #endif /* CONFIG_ZEPHYR */
 
 void cflush(void)
@@ -181,7 +438,17 @@ static int command_ch(int argc, const char **argv)
 		} else if (strcasecmp(argv[1], "restore") == 0) {
 			channel_mask = channel_mask_saved;
 			return EC_SUCCESS;
-
+#ifndef CONFIG_ZEPHYR
+		} else if (strcasecmp(argv[1], "drops") == 0) {
+			ccputs(" # Drops    Channel\n");
+			for (i = 0; i < CC_CHANNEL_COUNT; i++) {
+				ccprintf("%2d %8u %s\n", i,
+					 console_channel_drops(i),
+					 channel_names[i]);
+				cflush();
+			}
+			return EC_SUCCESS;
+#endif
 		} else {
 			/* Set the mask */
 			int index = console_channel_name_to_index(argv[1]);
@@ -218,7 +485,7 @@ static int command_ch(int argc, const char **argv)
 	return EC_SUCCESS;
 };
 DECLARE_SAFE_CONSOLE_COMMAND(chan, command_ch,
-			     "[ save | restore | <mask> | <name> ]",
+			     "[ save | restore | drops | <mask> | <name> ]",
 			     "Save, restore, get or set console channel mask");
 #endif /* CONFIG_CONSOLE_CHANNEL */
 
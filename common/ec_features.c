@@ -181,7 +181,8 @@ uint32_t get_feature_flags1(void)
 #ifdef CONFIG_DEBUG_ASSERT_REBOOTS
 		| EC_FEATURE_MASK_1(EC_FEATURE_ASSERT_REBOOTS)
 #endif
-#ifdef CONFIG_PIGWEED_LOG_TOKENIZED_LIB
+#if defined(CONFIG_PIGWEED_LOG_TOKENIZED_LIB) || \
+	defined(CONFIG_CONSOLE_TOKENIZED)
 		| EC_FEATURE_MASK_1(EC_FEATURE_TOKENIZED_LOGGING)
 #endif
 #ifdef CONFIG_PLATFORM_EC_AMD_STB_DUMP
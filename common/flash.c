@@ -11,6 +11,7 @@
 #endif /* CONFIG_ZEPHYR */
 #include "common.h"
 #include "console.h"
+#include "crc.h"
 #include "cros_board_info.h"
 #include "flash.h"
 #include "gpio.h"
@@ -1570,6 +1571,243 @@ static enum ec_status flash_command_write(struct host_cmd_handler_args *args)
 DECLARE_HOST_COMMAND(EC_CMD_FLASH_WRITE, flash_command_write,
 		     EC_VER_MASK(0) | EC_VER_MASK(EC_VER_FLASH_WRITE));
 
+#ifdef CONFIG_FLASH_WRITE_STREAM
+#ifdef CONFIG_HW_CRC
+#error "CONFIG_FLASH_WRITE_STREAM needs the crc32_ctx_* software API"
+#endif
+
+#define STREAM_BUF_SIZE CONFIG_FLASH_WRITE_STREAM_BUF_SIZE
+#define STREAM_BUF_COUNT 2
+
+BUILD_ASSERT(STREAM_BUF_SIZE % CONFIG_FLASH_WRITE_SIZE == 0);
+BUILD_ASSERT(STREAM_BUF_SIZE <= UINT16_MAX);
+
+static struct {
+	/* STREAM_BUF_COUNT buffers, taken from shared memory */
+	char *mem;
+	/* Absolute flash offset and length of the stream */
+	uint32_t offset;
+	uint32_t size;
+	/* Bytes accepted from the host, and their running CRC-32 */
+	uint32_t received;
+	uint32_t crc;
+	/* Buffer being filled by the host and how much it holds */
+	uint8_t fill;
+	uint16_t fill_len;
+	/* Next buffer to program; only touched by the deferred writer */
+	uint8_t drain;
+	/* Bytes queued for programming in each buffer; 0 when free */
+	volatile uint16_t pending[STREAM_BUF_COUNT];
+	/* Bytes programmed so far */
+	volatile uint32_t written;
+	/* Sticky result of the deferred writes */
+	volatile enum ec_status rc;
+} stream;
+
+static void flash_write_stream_deferred(void)
+{
+	uint16_t len;
+
+	/* Buffers are queued and programmed in the same round-robin order */
+	while ((len = stream.pending[stream.drain]) != 0) {
+		if (stream.rc == EC_RES_SUCCESS &&
+		    crec_flash_write(stream.offset + stream.written, len,
+				     stream.mem +
+					     stream.drain * STREAM_BUF_SIZE))
+			stream.rc = EC_RES_ERROR;
+
+		stream.written += len;
+		stream.pending[stream.drain] = 0;
+		stream.drain = (stream.drain + 1) % STREAM_BUF_COUNT;
+	}
+}
+DECLARE_DEFERRED(flash_write_stream_deferred);
+
+static bool flash_write_stream_busy(void)
+{
+	int i;
+
+	for (i = 0; i < STREAM_BUF_COUNT; i++)
+		if (stream.pending[i])
+			return true;
+
+	return false;
+}
+
+static void flash_write_stream_queue(void)
+{
+	stream.pending[stream.fill] = stream.fill_len;
+	stream.fill = (stream.fill + 1) % STREAM_BUF_COUNT;
+	stream.fill_len = 0;
+	hook_call_deferred(&flash_write_stream_deferred_data, 0);
+}
+
+/* Drop the stream once the writer is idle. */
+static enum ec_status flash_write_stream_close(enum ec_status rc)
+{
+	if (flash_write_stream_busy())
+		return EC_RES_BUSY;
+
+	if (stream.mem) {
+		shared_mem_release(stream.mem);
+		stream.mem = NULL;
+	}
+
+	return rc;
+}
+
+static enum ec_status
+flash_write_stream_start(const struct ec_params_flash_write_stream *p)
+{
+	enum ec_status rc;
+
+	rc = flash_write_stream_close(EC_RES_SUCCESS);
+	if (rc != EC_RES_SUCCESS)
+		return rc;
+
+	if (crec_flash_get_protect() & EC_FLASH_PROTECT_ALL_NOW)
+		return EC_RES_ACCESS_DENIED;
+
+	if (p->size == 0 ||
+	    !flash_range_ok(p->offset + EC_FLASH_REGION_START, p->size,
+			    CONFIG_FLASH_WRITE_SIZE))
+		return EC_RES_INVALID_PARAM;
+
+#ifdef CONFIG_INTERNAL_STORAGE
+	if (system_unsafe_to_overwrite(p->offset + EC_FLASH_REGION_START,
+				       p->size))
+		return EC_RES_ACCESS_DENIED;
+#endif
+
+	if (shared_mem_acquire(STREAM_BUF_SIZE * STREAM_BUF_COUNT,
+			       &stream.mem) != EC_SUCCESS) {
+		stream.mem = NULL;
+		return EC_RES_BUSY;
+	}
+
+	stream.offset = p->offset + EC_FLASH_REGION_START;
+	stream.size = p->size;
+	stream.received = 0;
+	crc32_ctx_init(&stream.crc);
+	stream.fill = 0;
+	stream.fill_len = 0;
+	stream.drain = 0;
+	stream.written = 0;
+	stream.rc = EC_RES_SUCCESS;
+
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status
+flash_write_stream_data(const struct ec_params_flash_write_stream *p)
+{
+	const uint8_t *data = p->data;
+	uint32_t size = p->size;
+	uint32_t room;
+
+	if (!stream.mem || p->offset != stream.received ||
+	    size > STREAM_BUF_SIZE || size > stream.size - stream.received)
+		return EC_RES_INVALID_PARAM;
+
+	if (stream.rc != EC_RES_SUCCESS)
+		return stream.rc;
+
+	/*
+	 * Refuse the whole packet unless every buffer it touches is free, so
+	 * the host can simply resend it.
+	 */
+	room = STREAM_BUF_SIZE - stream.fill_len;
+	if (stream.pending[stream.fill] ||
+	    (size > room &&
+	     stream.pending[(stream.fill + 1) % STREAM_BUF_COUNT]))
+		return EC_RES_BUSY;
+
+	crc32_ctx_hash(&stream.crc, data, size);
+	stream.received += size;
+
+	while (size) {
+		uint32_t chunk = MIN(size, STREAM_BUF_SIZE - stream.fill_len);
+
+		memcpy(stream.mem + stream.fill * STREAM_BUF_SIZE +
+			       stream.fill_len,
+		       data, chunk);
+		stream.fill_len += chunk;
+		data += chunk;
+		size -= chunk;
+
+		if (stream.fill_len == STREAM_BUF_SIZE)
+			flash_write_stream_queue();
+	}
+
+	return EC_RES_SUCCESS;
+}
+
+static enum ec_status
+flash_write_stream_done(const struct ec_params_flash_write_stream *p)
+{
+	if (!stream.mem || stream.received != stream.size)
+		return EC_RES_INVALID_PARAM;
+
+	if (stream.fill_len)
+		flash_write_stream_queue();
+
+	if (crc32_ctx_result(&stream.crc) != p->crc32)
+		stream.rc = EC_RES_ERROR;
+
+	return flash_write_stream_close(stream.rc);
+}
+
+static enum ec_status
+flash_command_write_stream(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_flash_write_stream *p = args->params;
+	struct ec_response_flash_write_stream *r = args->response;
+	enum ec_status rc;
+	int i;
+
+	if (args->params_size < sizeof(*p) ||
+	    (p->cmd == FLASH_WRITE_STREAM_DATA &&
+	     p->size > args->params_size - sizeof(*p)))
+		return EC_RES_INVALID_PARAM;
+
+	switch (p->cmd) {
+	case FLASH_WRITE_STREAM_START:
+		rc = flash_write_stream_start(p);
+		break;
+	case FLASH_WRITE_STREAM_DATA:
+		rc = flash_write_stream_data(p);
+		break;
+	case FLASH_WRITE_STREAM_DONE:
+		rc = flash_write_stream_done(p);
+		break;
+	case FLASH_WRITE_STREAM_ABORT:
+		stream.rc = EC_RES_ERROR;
+		rc = flash_write_stream_close(EC_RES_SUCCESS);
+		break;
+	default:
+		return EC_RES_INVALID_PARAM;
+	}
+
+	/* Host command errors carry no payload */
+	if (rc != EC_RES_SUCCESS)
+		return rc;
+
+	r->received = stream.received;
+	r->written = stream.written;
+	r->buf_size = STREAM_BUF_SIZE;
+	r->buf_free = 0;
+	for (i = 0; i < STREAM_BUF_COUNT; i++)
+		if (!stream.pending[i])
+			r->buf_free++;
+	r->reserved = 0;
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_FLASH_WRITE_STREAM, flash_command_write_stream,
+		     EC_VER_MASK(0));
+#endif /* CONFIG_FLASH_WRITE_STREAM */
+
 #ifndef CONFIG_FLASH_MULTIPLE_REGION
 /*
  * Make sure our image sizes are a multiple of flash block erase size so that
@@ -331,12 +331,8 @@ host_packet_bad:
 	host_packet_respond(&args0);
 }
 
-const struct host_command *find_host_command(int command)
+static const struct host_command *search_host_command(int command)
 {
-	if (IS_ENABLED(CONFIG_SYSTEM_SAFE_MODE) && system_is_in_safe_mode()) {
-		if (!command_is_allowed_in_safe_mode(command))
-			return NULL;
-	}
 	if (IS_ENABLED(CONFIG_ZEPHYR)) {
 		return zephyr_find_host_command(command);
 	} else if (IS_ENABLED(CONFIG_HOSTCMD_SECTION_SORTED)) {
@@ -373,6 +369,108 @@ const struct host_command *find_host_command(int command)
 	}
 }
 
+#ifdef CONFIG_CMD_HCSTATS
+static struct {
+	uint32_t count;
+	uint32_t indexed;
+	uint32_t lookup_us;
+	uint32_t lookup_max_us;
+	uint32_t handler_us;
+	uint32_t handler_max_us;
+} hcstats;
+#define HCSTATS_INC(field) (hcstats.field++)
+#else
+#define HCSTATS_INC(field)
+#endif
+
+#ifdef CONFIG_HOSTCMD_INDEX
+/*
+ * For each command number below CONFIG_HOSTCMD_INDEX_SIZE, 1 + the position
+ * of the command in the host command table, or 0 if there's no such command.
+ * The linker can only collect the table, not key it by command number, so
+ * the index is built on the first lookup.
+ */
+static uint8_t hcmd_index[CONFIG_HOSTCMD_INDEX_SIZE];
+
+/*
+ * Index entries are 1-based, so a table longer than this can't be indexed.
+ * Its length is only known at link time; build_host_command_index() checks
+ * it and falls back to searching the table.
+ */
+#define HCMD_INDEX_MAX_COMMANDS UINT8_MAX
+BUILD_ASSERT(HCMD_INDEX_MAX_COMMANDS < BIT(8 * sizeof(hcmd_index[0])));
+
+/* Get the i-th entry of the host command table, or NULL past the end. */
+static const struct host_command *get_host_command(int i)
+{
+	if (IS_ENABLED(CONFIG_ZEPHYR))
+		return zephyr_get_host_command(i);
+
+	if (__hcmds + i < __hcmds_end)
+		return __hcmds + i;
+
+	return NULL;
+}
+
+test_export_static enum hcmd_index_state {
+	HCMD_INDEX_EMPTY,
+	HCMD_INDEX_READY,
+	/* More commands than an index entry can point to */
+	HCMD_INDEX_UNUSABLE,
+} hcmd_index_state;
+
+static void build_host_command_index(void)
+{
+	const struct host_command *cmd;
+	int i;
+
+	for (i = 0; (cmd = get_host_command(i)) != NULL; i++) {
+		if (i >= HCMD_INDEX_MAX_COMMANDS) {
+			CPRINTS("HC index: too many commands, using search");
+			hcmd_index_state = HCMD_INDEX_UNUSABLE;
+			return;
+		}
+		/* Like a search, the first of duplicate entries wins. */
+		if (cmd->command < CONFIG_HOSTCMD_INDEX_SIZE &&
+		    !hcmd_index[cmd->command])
+			hcmd_index[cmd->command] = i + 1;
+	}
+
+	hcmd_index_state = HCMD_INDEX_READY;
+}
+
+const struct host_command *find_host_command(int command)
+{
+	if (IS_ENABLED(CONFIG_SYSTEM_SAFE_MODE) && system_is_in_safe_mode()) {
+		if (!command_is_allowed_in_safe_mode(command))
+			return NULL;
+	}
+
+	if (hcmd_index_state == HCMD_INDEX_EMPTY)
+		build_host_command_index();
+
+	if (hcmd_index_state == HCMD_INDEX_READY && command >= 0 &&
+	    command < CONFIG_HOSTCMD_INDEX_SIZE) {
+		HCSTATS_INC(indexed);
+		if (!hcmd_index[command])
+			return NULL;
+		return get_host_command(hcmd_index[command] - 1);
+	}
+
+	return search_host_command(command);
+}
+#else
+const struct host_command *find_host_command(int command)
+{
+	if (IS_ENABLED(CONFIG_SYSTEM_SAFE_MODE) && system_is_in_safe_mode()) {
+		if (!command_is_allowed_in_safe_mode(command))
+			return NULL;
+	}
+
+	return search_host_command(command);
+}
+#endif /* CONFIG_HOSTCMD_INDEX */
+
 void host_command_task(void *u)
 {
 	timestamp_t t0, t1, t_recess;
@@ -554,13 +652,32 @@ uint16_t host_command_process(struct host_cmd_handler_args *args)
 	} else
 #endif
 	{
+#ifdef CONFIG_CMD_HCSTATS
+		timestamp_t t0, t1, t2;
+		uint32_t dt;
+
+		t0 = get_time();
+#endif
 		cmd = find_host_command(args->command);
+#ifdef CONFIG_CMD_HCSTATS
+		t1 = get_time();
+#endif
 		if (!cmd)
 			rv = EC_RES_INVALID_COMMAND;
 		else if (!(EC_VER_MASK(args->version) & cmd->version_mask))
 			rv = EC_RES_INVALID_VERSION;
 		else
 			rv = cmd->handler(args);
+#ifdef CONFIG_CMD_HCSTATS
+		t2 = get_time();
+		hcstats.count++;
+		dt = t1.val - t0.val;
+		hcstats.lookup_us += dt;
+		hcstats.lookup_max_us = MAX(hcstats.lookup_max_us, dt);
+		dt = t2.val - t1.val;
+		hcstats.handler_us += dt;
+		hcstats.handler_max_us = MAX(hcstats.handler_max_us, dt);
+#endif
 	}
 
 	if (rv != EC_RES_SUCCESS)
@@ -730,3 +847,35 @@ DECLARE_CONSOLE_COMMAND(hcdebug, command_hcdebug,
 			"hcdebug [off | normal | every | params]",
 			"Set host command debug output mode");
 #endif /* CONFIG_CMD_HCDEBUG */
+
+#ifdef CONFIG_CMD_HCSTATS
+static int command_hcstats(int argc, const char **argv)
+{
+	uint32_t count;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(&hcstats, 0, sizeof(hcstats));
+		return EC_SUCCESS;
+	}
+
+	count = MAX(hcstats.count, 1);
+
+	ccprintf("Commands:        %u\n", hcstats.count);
+	ccprintf("Indexed lookups: %u\n", hcstats.indexed);
+#ifdef CONFIG_HOSTCMD_INDEX
+	if (hcmd_index_state == HCMD_INDEX_UNUSABLE)
+		ccprintf("Index disabled:  more than %d commands\n",
+			 HCMD_INDEX_MAX_COMMANDS);
+#endif
+	ccprintf("Lookup time:     avg %u us, max %u us\n",
+		 hcstats.lookup_us / count, hcstats.lookup_max_us);
+	ccprintf("Handler time:    avg %u us, max %u us\n",
+		 hcstats.handler_us / count, hcstats.handler_max_us);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(hcstats, command_hcstats, "[clear]",
+			"Show host command dispatch statistics");
+#endif /* CONFIG_CMD_HCSTATS */
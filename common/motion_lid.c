@@ -82,6 +82,15 @@ static intv3_t smoothed_base, smoothed_lid;
 
 #define MOTION_SCALING_FACTOR2 (MOTION_SCALING_FACTOR * MOTION_SCALING_FACTOR)
 
+/*
+ * The lid angle is only recalculated when one of the scaled accel vectors has
+ * moved by more than this on any axis since the last calculation. 0.3 m/s^2
+ * changes the lid angle by less than 2 degrees. The check is integer only;
+ * the calculation itself still runs in fp_t, i.e. float with CONFIG_FPU.
+ */
+#define LID_ANGLE_MOVE_THRESHOLD \
+	((int)((0.3f * MOTION_SCALING_FACTOR) / MOTION_ONE_G))
+
 /*
  * Define the accelerometer orientation matrices based on the standard
  * reference frame in use (note: accel data is converted to standard ref
@@ -95,6 +104,20 @@ static const intv3_t hinge_axis = { 1, 0, 0 };
 #define HINGE_AXIS X
 #endif
 
+/*
+ * Scaled inputs of the last lid angle calculation, and whether its result can
+ * be reused while the inputs stay within LID_ANGLE_MOVE_THRESHOLD.
+ */
+static intv3_t calc_scaled_base, calc_scaled_lid;
+static bool calc_reusable;
+#ifdef CONFIG_TABLET_MODE
+static bool calc_lid_open;
+#endif
+
+test_export_static int lid_angle_move_threshold = LID_ANGLE_MOVE_THRESHOLD;
+/* Number of full lid angle calculations, for benchmarking decimation. */
+test_export_static unsigned int lid_angle_calc_count;
+
 static const struct motion_sensor_t *const accel_base =
 	&motion_sensors[CONFIG_LID_ANGLE_SENSOR_BASE];
 static const struct motion_sensor_t *const accel_lid =
@@ -297,6 +320,9 @@ static int calculate_lid_angle(const intv3_t base, const intv3_t lid,
 	int base_magnitude2, lid_magnitude2, largest_hinge_accel;
 	int reliable = 1, i;
 
+	lid_angle_calc_count++;
+	calc_reusable = true;
+
 	/*
 	 * Scale the vectors by their range, to be able to compare them.
 	 * If a single measurement is greated than 1g, we may overflow fixed
@@ -373,6 +399,13 @@ static int calculate_lid_angle(const intv3_t base, const intv3_t lid,
 		goto end_calculate_lid_angle;
 	}
 
+	/*
+	 * Smoothing feeds back the previous vectors, so the same inputs only
+	 * give the same angle when it is off.
+	 */
+	if (smoothed_ratio != INT_TO_FP(0))
+		calc_reusable = false;
+
 	/* Smooth input to reduce calculation error due to noise. */
 	vector_scale(smoothed_base, smoothed_ratio);
 	vector_scale(smoothed_lid, smoothed_ratio);
@@ -461,12 +494,6 @@ end_calculate_lid_angle:
 	 * angle is known to be positive.
 	 */
 	*lid_angle = FP_TO_INT(last_lid_angle_fp + FLOAT_TO_FP(0.5));
-
-	if (board_is_lid_angle_tablet_mode())
-		motion_lid_set_tablet_mode(reliable);
-
-	if (IS_ENABLED(MOTION_LID_SET_DPTF_PROFILE))
-		motion_lid_set_dptf_profile(reliable);
 #else /* CONFIG_TABLET_MODE */
 end_calculate_lid_angle:
 	if (reliable)
@@ -483,14 +510,65 @@ int motion_lid_get_angle(void)
 		return LID_ANGLE_UNRELIABLE;
 }
 
+/**
+ * Check whether the lid angle needs to be calculated again, and save the
+ * inputs of the calculation if it does.
+ *
+ * @return true if either accel moved beyond the threshold or the last result
+ *	can't be reused.
+ */
+static bool lid_angle_needs_calc(void)
+{
+	intv3_t scaled_base, scaled_lid;
+	bool moved = !calc_reusable;
+	int i;
+
+	for (i = X; i <= Z; i++) {
+		scaled_base[i] = accel_base->xyz[i] * accel_base->current_range;
+		scaled_lid[i] = accel_lid->xyz[i] * accel_lid->current_range;
+		if (ABS(scaled_base[i] - calc_scaled_base[i]) >
+			    lid_angle_move_threshold ||
+		    ABS(scaled_lid[i] - calc_scaled_lid[i]) >
+			    lid_angle_move_threshold)
+			moved = true;
+	}
+
+#ifdef CONFIG_TABLET_MODE
+	/* The lid switch is part of the reliability checks. */
+	if (lid_is_open() != calc_lid_open) {
+		calc_lid_open = lid_is_open();
+		moved = true;
+	}
+#endif
+
+	if (moved) {
+		memcpy(calc_scaled_base, scaled_base, sizeof(intv3_t));
+		memcpy(calc_scaled_lid, scaled_lid, sizeof(intv3_t));
+	}
+	return moved;
+}
+
 /*
  * Calculate lid angle and massage the results
  */
 void motion_lid_calc(void)
 {
-	/* Calculate angle of lid accel. */
-	lid_angle_is_reliable = calculate_lid_angle(
-		accel_base->xyz, accel_lid->xyz, &lid_angle_deg);
+	/*
+	 * Calculate angle of lid accel, only when the accels moved. Otherwise
+	 * the previous angle stands, but it still counts towards the debounce
+	 * of the modes below.
+	 */
+	if (lid_angle_needs_calc())
+		lid_angle_is_reliable = calculate_lid_angle(
+			accel_base->xyz, accel_lid->xyz, &lid_angle_deg);
+
+#ifdef CONFIG_TABLET_MODE
+	if (board_is_lid_angle_tablet_mode())
+		motion_lid_set_tablet_mode(lid_angle_is_reliable);
+
+	if (IS_ENABLED(MOTION_LID_SET_DPTF_PROFILE))
+		motion_lid_set_dptf_profile(lid_angle_is_reliable);
+#endif
 
 	if (IS_ENABLED(CONFIG_LID_ANGLE_UPDATE))
 		lid_angle_update(motion_lid_get_angle());
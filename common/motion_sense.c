@@ -44,6 +44,23 @@ static atomic_t motion_sense_task_loops;
 /* When we started the task the last time */
 static timestamp_t ts_begin_task;
 
+/* Processing stats of each sensor, since they were last printed */
+static struct {
+	uint32_t runs;
+	uint32_t time_us;
+} sensor_stats[MAX_MOTION_SENSORS];
+
+/* Task loops and time when the stats were last printed */
+static uint32_t stats_loops;
+static timestamp_t ts_stats;
+
+/*
+ * Sensors collected on a timer rather than on interrupts, and the earliest
+ * collection time among them. Updated at the end of each task loop.
+ */
+static uint32_t timed_sensors;
+static uint32_t next_timed_collection;
+
 /* Minimum time in between running motion sense task loop. */
 unsigned int motion_min_interval = CONFIG_MOTION_MIN_SENSE_WAIT_TIME * MSEC;
 STATIC_IF(CONFIG_CMD_ACCEL_INFO) int accel_disp;
@@ -448,6 +465,9 @@ static void motion_sense_print_stats(const char *event)
 {
 	unsigned int active = 0;
 	unsigned int states = 0;
+	timestamp_t now;
+	uint64_t period_ms;
+	uint32_t loops;
 	int i;
 
 	for (i = 0; i < motion_sensor_count; i++) {
@@ -461,6 +481,24 @@ static void motion_sense_print_stats(const char *event)
 		event, (unsigned int)motion_sense_task_loops,
 		(unsigned int)(get_time().val - ts_begin_task.val) / 1000,
 		active, states);
+
+	now = get_time();
+	period_ms = (now.val - ts_stats.val) / MSEC;
+	loops = (uint32_t)motion_sense_task_loops - stats_loops;
+	CPRINTS("Motion %u wakeups/s over %u ms",
+		period_ms ? (unsigned int)(loops * 1000ULL / period_ms) : 0,
+		(unsigned int)period_ms);
+	for (i = 0; i < motion_sensor_count; i++) {
+		if (sensor_stats[i].runs == 0)
+			continue;
+		CPRINTS("  %s: %u runs, %u us", motion_sensors[i].name,
+			(unsigned int)sensor_stats[i].runs,
+			(unsigned int)sensor_stats[i].time_us);
+	}
+
+	memset(sensor_stats, 0, sizeof(sensor_stats));
+	stats_loops = motion_sense_task_loops;
+	ts_stats = now;
 }
 
 static void motion_sense_shutdown(void)
@@ -881,6 +919,43 @@ static void check_and_queue_gestures(uint32_t *event)
 }
 #endif
 
+/*
+ * Get the sensors to process in this loop: the ones that raised an
+ * interrupt, have an ODR change or a flush pending, or are due for a timed
+ * collection. Other sensors are skipped without being looked at.
+ */
+static uint32_t motion_sense_due_sensors(uint32_t event, const timestamp_t *ts)
+{
+	uint32_t due;
+	uint32_t timed;
+	int i;
+
+	/* The interrupt of sensor i is event bit i. */
+	due = event & TASK_EVENT_MOTION_INTERRUPT_MASK;
+
+	if (event & TASK_EVENT_MOTION_ODR_CHANGE)
+		due |= odr_event_required;
+
+	if (IS_ENABLED(CONFIG_ACCEL_FIFO) &&
+	    (event & TASK_EVENT_MOTION_FLUSH_PENDING))
+		due |= BIT(motion_sensor_count) - 1;
+
+	/* No timed sensor is due before the earliest collection time. */
+	if (timed_sensors &&
+	    time_after(ts->le.lo,
+		       next_timed_collection - motion_min_interval)) {
+		timed = timed_sensors;
+		while (timed) {
+			i = __builtin_ctz(timed);
+			timed &= timed - 1;
+			if (motion_sensor_time_to_read(ts, &motion_sensors[i]))
+				due |= BIT(i);
+		}
+	}
+
+	return due & (BIT(motion_sensor_count) - 1);
+}
+
 /*
  * Motion Sense Task
  * Requirement: motion_sensors[] are defined in board.c file.
@@ -894,6 +969,8 @@ void motion_sense_task(void *u)
 	timestamp_t ts_end_task;
 	int32_t time_diff;
 	uint32_t event = 0;
+	uint32_t due;
+	timestamp_t ts_sensor;
 	uint16_t ready_status = 0;
 	struct motion_sensor_t *sensor;
 	uint8_t *lpc_status;
@@ -910,17 +987,25 @@ void motion_sense_task(void *u)
 	while (1) {
 		ts_begin_task = get_time();
 		atomic_add(&motion_sense_task_loops, 1);
-		for (i = 0; i < motion_sensor_count; ++i) {
+		due = motion_sense_due_sensors(event, &ts_begin_task);
+		while (due) {
+			i = __builtin_ctz(due);
+			due &= due - 1;
 			sensor = &motion_sensors[i];
 
 			/* if the sensor is active in the current power state */
-			if (SENSOR_ACTIVE(sensor)) {
-				ret = motion_sense_process(sensor, &event,
-							   &ts_begin_task);
-				if (ret != EC_SUCCESS)
-					continue;
-				ready_status |= BIT(i);
-			}
+			if (!SENSOR_ACTIVE(sensor))
+				continue;
+
+			ts_sensor = get_time();
+			ret = motion_sense_process(sensor, &event,
+						   &ts_begin_task);
+			sensor_stats[i].runs++;
+			sensor_stats[i].time_us +=
+				get_time().val - ts_sensor.val;
+			if (ret != EC_SUCCESS)
+				continue;
+			ready_status |= BIT(i);
 		}
 		if (IS_ENABLED(CONFIG_GESTURE_DETECTION))
 			check_and_queue_gestures(&event);
@@ -990,6 +1075,7 @@ void motion_sense_task(void *u)
 
 		ts_end_task = get_time();
 		wait_us = -1;
+		timed_sensors = 0;
 
 		for (i = 0; i < motion_sensor_count; i++) {
 			struct motion_sensor_t *sensor = &motion_sensors[i];
@@ -1001,6 +1087,12 @@ void motion_sense_task(void *u)
 			    sensor->collection_rate == 0)
 				continue;
 
+			if (timed_sensors == 0 ||
+			    time_after(next_timed_collection,
+				       sensor->next_collection))
+				next_timed_collection = sensor->next_collection;
+			timed_sensors |= BIT(i);
+
 			if (IS_ENABLED(CONFIG_SENSOR_EC_RATE_FORCE_MODE) &&
 			    cfg_index != SENSOR_CONFIG_EC_S0) {
 				ec_rate = sensor->config[cfg_index].ec_rate;
@@ -1013,7 +1105,7 @@ void motion_sense_task(void *u)
 			/* We missed our collection time so wake soon */
 			if (time_diff <= 0) {
 				wait_us = 0;
-				break;
+				continue;
 			}
 
 			if (wait_us == -1 || wait_us > time_diff)
@@ -294,12 +294,12 @@ fifo_stage_unit(struct ec_response_motion_sensor_data *data,
 			sensor->oversampling %= sensor->oversampling_ratio;
 		}
 		if (removed) {
-			mutex_unlock(&g_sensor_mutex);
 			if (IS_ENABLED(CONFIG_ONLINE_CALIB) &&
 			    !is_new_timestamp(data->sensor_num))
-				online_calibration_process_data(
+				online_calibration_stage_data(
 					data, sensor,
 					next_timestamp[data->sensor_num].next);
+			mutex_unlock(&g_sensor_mutex);
 			return;
 		}
 	}
@@ -496,9 +496,18 @@ void motion_sense_fifo_commit_data(void)
 	struct ec_response_motion_sensor_data *data;
 	int i, window, sensor_num;
 
-	/* Nothing staged, no work to do. */
-	if (!fifo_staged.count)
+	/*
+	 * Nothing staged, no work to do other than calibrating the samples
+	 * that were not forwarded to the AP.
+	 */
+	if (!fifo_staged.count) {
+		if (IS_ENABLED(CONFIG_ONLINE_CALIB)) {
+			mutex_lock(&g_sensor_mutex);
+			online_calibration_commit();
+			mutex_unlock(&g_sensor_mutex);
+		}
 		return;
+	}
 
 	mutex_lock(&g_sensor_mutex);
 	/*
@@ -603,10 +612,10 @@ commit_data_end:
 				data_periods[sensor_num] :
 				expected_data_periods[sensor_num];
 
-		/* Update online calibration if enabled. */
+		/* Queue the sample for online calibration if enabled. */
 		data = peek_fifo_staged(i);
 		if (IS_ENABLED(CONFIG_ONLINE_CALIB))
-			online_calibration_process_data(
+			online_calibration_stage_data(
 				data, &motion_sensors[sensor_num],
 				next_timestamp[sensor_num].prev);
 	}
@@ -617,6 +626,10 @@ commit_data_end:
 	/* Reset metadata for next staging cycle. */
 	memset(&fifo_staged, 0, sizeof(fifo_staged));
 
+	/* Run online calibration on everything queued. */
+	if (IS_ENABLED(CONFIG_ONLINE_CALIB))
+		online_calibration_commit();
+
 	mutex_unlock(&g_sensor_mutex);
 }
 
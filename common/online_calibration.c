@@ -30,6 +30,31 @@ static uint32_t sensor_calib_cache_dirty_map;
 
 struct mutex g_calib_cache_mutex;
 
+/**
+ * Samples waiting to be run through the calibration algorithms, from all
+ * sensors, in the order they were queued. Each field is kept in its own
+ * array so that the batch pass walks memory linearly.
+ *
+ * @timestamp: The time associated with each sample.
+ * @data: The raw sensor readings, one array per axis.
+ * @sensor_num: The sensor that generated each sample.
+ * @count: The number of samples in the batch.
+ */
+BUILD_ASSERT(CONFIG_ONLINE_CALIB_BATCH_SIZE <= UINT8_MAX);
+BUILD_ASSERT(MAX_MOTION_SENSORS <= UINT8_MAX);
+
+struct online_calib_batch {
+	uint32_t timestamp[CONFIG_ONLINE_CALIB_BATCH_SIZE];
+	int16_t data[3][CONFIG_ONLINE_CALIB_BATCH_SIZE];
+	uint8_t sensor_num[CONFIG_ONLINE_CALIB_BATCH_SIZE];
+	uint8_t count;
+};
+
+static struct online_calib_batch calib_batch;
+
+/* Batch converted to fixed point. */
+static fp_t batch_fp[3][CONFIG_ONLINE_CALIB_BATCH_SIZE];
+
 static int get_temperature(struct motion_sensor_t *sensor, int *temp)
 {
 	struct online_calib_data *entry = sensor->online_calib_data;
@@ -57,19 +82,29 @@ static int get_temperature(struct motion_sensor_t *sensor, int *temp)
 	return EC_SUCCESS;
 }
 
-static void data_int16_to_fp(const struct motion_sensor_t *s,
-			     const int16_t *data, fpv3_t out)
+/**
+ * Convert the samples [start, end) of the batch, all from sensor s, to fixed
+ * point. The scale factors only depend on the range, so they are computed
+ * once instead of dividing every sample.
+ */
+static void batch_int16_to_fp(const struct motion_sensor_t *s, int start,
+			      int end,
+			      fp_t out[3][CONFIG_ONLINE_CALIB_BATCH_SIZE])
 {
-	int i;
+	int i, n;
 	fp_t range = INT_TO_FP(s->current_range);
+	fp_t pos_scale = fp_div(range, INT_TO_FP(0x7fff));
+	fp_t neg_scale = fp_div(range, INT_TO_FP(0x8000));
 
 	for (i = 0; i < 3; ++i) {
-		fp_t v = INT_TO_FP((int32_t)data[i]);
+		for (n = start; n < end; ++n) {
+			int16_t d = calib_batch.data[i][n];
+			fp_t v = fp_mul(INT_TO_FP((int32_t)d),
+					d >= 0 ? pos_scale : neg_scale);
 
-		out[i] = fp_div(v, INT_TO_FP((data[i] >= 0) ? 0x7fff : 0x8000));
-		out[i] = fp_mul(out[i], range);
-		/* Check for overflow */
-		out[i] = CLAMP(out[i], -range, range);
+			/* Check for overflow */
+			out[i][n] = CLAMP(v, -range, range);
+		}
 	}
 }
 
@@ -136,17 +171,20 @@ static void set_gyro_cal_cache_values(struct motion_sensor_t *sensor,
 }
 
 /**
- * Update the data stream (accel/mag) for a given sensor and data in all
+ * Update the data stream (accel/mag) for a given sensor and batch in all
  * gyroscopes that are interested.
  *
  * @param sensor Pointer to the sensor that generated the data.
- * @param data 3 floats/fixed point data points generated by the sensor.
- * @param timestamp The timestamp at which the data was generated.
+ * @param start Index of the first sample of the sensor in the batch.
+ * @param end Index past the last sample of the sensor in the batch.
+ * @param data The batch converted to fixed point, one array per axis.
  */
-static void update_gyro_cal(struct motion_sensor_t *sensor, fpv3_t data,
-			    uint32_t timestamp)
+static void update_gyro_cal(struct motion_sensor_t *sensor, int start,
+			    int end,
+			    fp_t data[3][CONFIG_ONLINE_CALIB_BATCH_SIZE])
 {
-	int i;
+	int i, n;
+	int sensor_num = sensor - motion_sensors;
 	fpv3_t gyro_cal_data_out;
 
 	/*
@@ -159,7 +197,6 @@ static void update_gyro_cal(struct motion_sensor_t *sensor, fpv3_t data,
 		struct gyro_cal_data *gyro_cal_data =
 			(struct gyro_cal_data *)
 				s->online_calib_data->type_specific_data;
-		bool has_new_gyro_cal_bias = false;
 
 		/*
 		 * If we're not looking at a gyroscope OR if the calibration
@@ -173,22 +210,25 @@ static void update_gyro_cal(struct motion_sensor_t *sensor, fpv3_t data,
 		 * which sensors the gyroscope is tracking.
 		 */
 		if (sensor->type == MOTIONSENSE_TYPE_ACCEL &&
-		    gyro_cal_data->accel_sensor_id == sensor - motion_sensors) {
-			gyro_cal_update_accel(&gyro_cal_data->gyro_cal,
-					      timestamp, data[X], data[Y],
-					      data[Z]);
-			has_new_gyro_cal_bias =
-				check_gyro_cal_new_bias(s, gyro_cal_data_out);
+		    gyro_cal_data->accel_sensor_id == sensor_num) {
+			for (n = start; n < end; ++n)
+				gyro_cal_update_accel(&gyro_cal_data->gyro_cal,
+						      calib_batch.timestamp[n],
+						      data[X][n], data[Y][n],
+						      data[Z][n]);
 		} else if (sensor->type == MOTIONSENSE_TYPE_MAG &&
-			   gyro_cal_data->mag_sensor_id ==
-				   sensor - motion_sensors) {
-			gyro_cal_update_mag(&gyro_cal_data->gyro_cal, timestamp,
-					    data[X], data[Y], data[Z]);
-			has_new_gyro_cal_bias =
-				check_gyro_cal_new_bias(s, gyro_cal_data_out);
+			   gyro_cal_data->mag_sensor_id == sensor_num) {
+			for (n = start; n < end; ++n)
+				gyro_cal_update_mag(&gyro_cal_data->gyro_cal,
+						    calib_batch.timestamp[n],
+						    data[X][n], data[Y][n],
+						    data[Z][n]);
+		} else {
+			continue;
 		}
 
-		if (has_new_gyro_cal_bias)
+		/* The bias only needs to be checked once per run. */
+		if (check_gyro_cal_new_bias(s, gyro_cal_data_out))
 			set_gyro_cal_cache_values(s, gyro_cal_data_out);
 	}
 }
@@ -197,6 +237,8 @@ void online_calibration_init(void)
 {
 	size_t i;
 
+	calib_batch.count = 0;
+
 	for (i = 0; i < SENSOR_COUNT; i++) {
 		struct motion_sensor_t *s = motion_sensors + i;
 		void *type_specific_data = NULL;
@@ -259,12 +301,22 @@ bool online_calibration_read(struct motion_sensor_t *sensor,
 	return has_valid;
 }
 
-int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
-				    struct motion_sensor_t *sensor,
-				    uint32_t timestamp)
+/**
+ * Run the calibration algorithms on a run of consecutive samples of the batch
+ * from the same sensor, and publish the new calibration values, if any, once
+ * for the whole run.
+ *
+ * @param sensor Pointer to the sensor that generated the samples.
+ * @param start Index of the first sample of the run in the batch.
+ * @param end Index past the last sample of the run in the batch.
+ * @return EC_SUCCESS when successful.
+ */
+static int process_batch(struct motion_sensor_t *sensor, int start, int end)
 {
 	int sensor_num = sensor - motion_sensors;
-	int rc;
+	int last = end - 1;
+	int n;
+	int rc = EC_SUCCESS;
 	int temperature;
 	struct online_calib_data *calib_data;
 	fpv3_t fdata;
@@ -273,7 +325,7 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 	bool has_new_calibration_values = false;
 
 	/* Convert data to fp. */
-	data_int16_to_fp(sensor, data->data, fdata);
+	batch_int16_to_fp(sensor, start, end, batch_fp);
 
 	calib_data = sensor->online_calib_data;
 	switch (sensor->type) {
@@ -283,13 +335,13 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 
 		if (is_spoofed) {
 			/* Copy the data to the calibration result. */
-			cal->bias[X] = fdata[X];
-			cal->bias[Y] = fdata[Y];
-			cal->bias[Z] = fdata[Z];
+			cal->bias[X] = batch_fp[X][last];
+			cal->bias[Y] = batch_fp[Y][last];
+			cal->bias[Z] = batch_fp[Z][last];
 			has_new_calibration_values = true;
 		} else {
 			/* Possibly update the gyroscope calibration. */
-			update_gyro_cal(sensor, fdata, timestamp);
+			update_gyro_cal(sensor, start, end, batch_fp);
 
 			/*
 			 * Temperature is required for accelerometer
@@ -297,11 +349,14 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 			 */
 			rc = get_temperature(sensor, &temperature);
 			if (rc != EC_SUCCESS)
-				return rc;
-
-			has_new_calibration_values = accel_cal_accumulate(
-				cal, timestamp, fdata[X], fdata[Y], fdata[Z],
-				temperature);
+				break;
+
+			for (n = start; n <= last; ++n)
+				has_new_calibration_values |=
+					accel_cal_accumulate(
+						cal, calib_batch.timestamp[n],
+						batch_fp[X][n], batch_fp[Y][n],
+						batch_fp[Z][n], temperature);
 		}
 
 		if (has_new_calibration_values) {
@@ -320,23 +375,25 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 	case MOTIONSENSE_TYPE_MAG: {
 		struct mag_cal_t *cal =
 			(struct mag_cal_t *)(calib_data->type_specific_data);
-		int idata[] = {
-			(int)data->data[X],
-			(int)data->data[Y],
-			(int)data->data[Z],
-		};
+		int idata[3];
 
 		if (is_spoofed) {
 			/* Copy the data to the calibration result. */
-			cal->bias[X] = INT_TO_FP(idata[X]);
-			cal->bias[Y] = INT_TO_FP(idata[Y]);
-			cal->bias[Z] = INT_TO_FP(idata[Z]);
+			cal->bias[X] = INT_TO_FP(calib_batch.data[X][last]);
+			cal->bias[Y] = INT_TO_FP(calib_batch.data[Y][last]);
+			cal->bias[Z] = INT_TO_FP(calib_batch.data[Z][last]);
 			has_new_calibration_values = true;
 		} else {
 			/* Possibly update the gyroscope calibration. */
-			update_gyro_cal(sensor, fdata, timestamp);
-
-			has_new_calibration_values = mag_cal_update(cal, idata);
+			update_gyro_cal(sensor, start, end, batch_fp);
+
+			for (n = start; n <= last; ++n) {
+				idata[X] = calib_batch.data[X][n];
+				idata[Y] = calib_batch.data[Y][n];
+				idata[Z] = calib_batch.data[Z][n];
+				has_new_calibration_values |=
+					mag_cal_update(cal, idata);
+			}
 		}
 
 		if (has_new_calibration_values) {
@@ -358,8 +415,11 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 		if (is_spoofed) {
 			/*
 			 * Gyroscope uses fdata to store the calibration
-			 * result, so there's no need to copy anything.
+			 * result, so copy the latest sample.
 			 */
+			fdata[X] = batch_fp[X][last];
+			fdata[Y] = batch_fp[Y][last];
+			fdata[Z] = batch_fp[Z][last];
 			has_new_calibration_values = true;
 		} else {
 			struct gyro_cal_data *gyro_cal_data =
@@ -370,11 +430,16 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 			/* Temperature is required for gyro calibration. */
 			rc = get_temperature(sensor, &temperature);
 			if (rc != EC_SUCCESS)
-				return rc;
+				break;
 
 			/* Update gyroscope calibration. */
-			gyro_cal_update_gyro(gyro_cal, timestamp, fdata[X],
-					     fdata[Y], fdata[Z], temperature);
+			for (n = start; n <= last; ++n)
+				gyro_cal_update_gyro(gyro_cal,
+						     calib_batch.timestamp[n],
+						     batch_fp[X][n],
+						     batch_fp[Y][n],
+						     batch_fp[Z][n],
+						     temperature);
 			has_new_calibration_values =
 				check_gyro_cal_new_bias(sensor, fdata);
 		}
@@ -387,5 +452,67 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 		break;
 	}
 
-	return EC_SUCCESS;
+	return rc;
+}
+
+/**
+ * Run everything queued through the calibration algorithms, in the order it
+ * was queued. The gyroscope stillness windows are closed by whichever sensor
+ * has the first sample past their end, so samples from different sensors must
+ * not be reordered. Consecutive samples from the same sensor are processed
+ * together.
+ *
+ * @return EC_SUCCESS, or the first error from the algorithms.
+ */
+static int process_staged(void)
+{
+	int start, end;
+	int sensor_num;
+	int rc, ret = EC_SUCCESS;
+
+	for (start = 0; start < calib_batch.count; start = end) {
+		sensor_num = calib_batch.sensor_num[start];
+		end = start + 1;
+		while (end < calib_batch.count &&
+		       calib_batch.sensor_num[end] == sensor_num)
+			end++;
+
+		rc = process_batch(&motion_sensors[sensor_num], start, end);
+		if (ret == EC_SUCCESS)
+			ret = rc;
+	}
+	calib_batch.count = 0;
+
+	return ret;
+}
+
+void online_calibration_stage_data(struct ec_response_motion_sensor_data *data,
+				   struct motion_sensor_t *sensor,
+				   uint32_t timestamp)
+{
+	int n;
+
+	/* Make room by running the algorithms on the full batch. */
+	if (calib_batch.count == CONFIG_ONLINE_CALIB_BATCH_SIZE)
+		process_staged();
+
+	n = calib_batch.count++;
+	calib_batch.timestamp[n] = timestamp;
+	calib_batch.data[X][n] = data->data[X];
+	calib_batch.data[Y][n] = data->data[Y];
+	calib_batch.data[Z][n] = data->data[Z];
+	calib_batch.sensor_num[n] = sensor - motion_sensors;
+}
+
+void online_calibration_commit(void)
+{
+	process_staged();
+}
+
+int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
+				    struct motion_sensor_t *sensor,
+				    uint32_t timestamp)
+{
+	online_calibration_stage_data(data, sensor, timestamp);
+	return process_staged();
 }
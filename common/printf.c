@@ -249,9 +249,25 @@ int snprintf_hex_buffer(char *str, size_t size,
 	return (rv == EC_SUCCESS) ? (context.str - str) : -rv;
 }
 
-int vfnprintf(int (*addchar)(void *context, int c), void *context,
-	      const char *format, va_list args)
+/* Send <len> characters to a sink, in one call if the sink takes spans. */
+static int sink_put(const struct printf_sink *sink, void *context,
+		    const char *s, int len)
+{
+	if (sink->addspan)
+		return sink->addspan(context, s, len);
+
+	while (len-- > 0) {
+		if (sink->addchar(context, *s++))
+			return 1;
+	}
+
+	return 0;
+}
+
+int vfnprintf_sink(const struct printf_sink *sink, void *context,
+		   const char *format, va_list args)
 {
+	int (*addchar)(void *context, int c) = sink->addchar;
 	/*
 	 * Longest uint64 in decimal = 20
 	 * Longest uint32 in binary  = 32
@@ -269,9 +285,13 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		int c = *format++;
 		char sign = 0;
 
-		/* Copy normal characters */
+		/* Copy normal characters, up to the next format, at once */
 		if (c != '%') {
-			if (addchar(context, c))
+			const char *run = format - 1;
+
+			while (*format && *format != '%')
+				format++;
+			if (sink_put(sink, context, run, format - run))
 				return EC_ERROR_OVERFLOW;
 			continue;
 		}
@@ -527,9 +547,8 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 		}
 
 		/* output all permissible string chars */
-		while (--precision >= 0 && *vstr)
-			if (addchar(context, *vstr++))
-				return EC_ERROR_OVERFLOW;
+		if (sink_put(sink, context, vstr, strnlen(vstr, precision)))
+			return EC_ERROR_OVERFLOW;
 
 		if (flags & PF_LEFT) {
 			/* left justified string, output padding now */
@@ -544,3 +563,13 @@ int vfnprintf(int (*addchar)(void *context, int c), void *context,
 	/* If we're still here, we consumed all output */
 	return EC_SUCCESS;
 }
+
+int vfnprintf(int (*addchar)(void *context, int c), void *context,
+	      const char *format, va_list args)
+{
+	const struct printf_sink sink = {
+		.addchar = addchar,
+	};
+
+	return vfnprintf_sink(&sink, context, format, args);
+}
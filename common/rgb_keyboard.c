@@ -35,6 +35,21 @@ test_export_static enum ec_rgbkbd_demo demo =
 const int default_demo_interval_ms = 250;
 test_export_static int demo_interval_ms = -1;
 
+/* Minimum time between two frames pushed to the LED drivers. */
+#define RGBKBD_FRAME_US (SECOND / CONFIG_RGBKBD_MAX_FPS)
+
+/* Set when the framebuffer has changes waiting to be flushed. */
+#define TASK_EVENT_RGBKBD_FLUSH TASK_EVENT_CUSTOM_BIT(0)
+
+/* Protects dirty ranges and serializes flushes to the LED drivers. */
+static K_MUTEX_DEFINE(rgbkbd_fb_mutex);
+
+/* Earliest time the next frame may be flushed. */
+static uint64_t next_frame_time;
+
+/* Driver result of the last flush that sent anything, under rgbkbd_fb_mutex. */
+static int rgbkbd_flush_rv;
+
 test_export_static uint8_t rgbkbd_table[EC_RGBKBD_MAX_KEY_COUNT];
 
 static enum rgbkbd_state rgbkbd_state;
@@ -69,10 +84,231 @@ static struct rgbkbd *find_grid_from_x(int x, uint8_t *col)
 	return ctx;
 }
 
+test_export_static uint8_t get_grid_size(const struct rgbkbd *ctx)
+{
+	return ctx->cfg->col_len * ctx->cfg->row_len;
+}
+
+/*
+ * Record that LEDs [offset, offset + len) of a grid changed. The dirty range
+ * of a grid only grows until it's flushed, so scattered updates are sent to
+ * the LED driver as one burst.
+ */
+static void rgbkbd_mark_dirty_locked(struct rgbkbd *ctx, uint8_t offset,
+				     uint8_t len)
+{
+	if (ctx->dirty_lo >= ctx->dirty_hi) {
+		ctx->dirty_lo = offset;
+		ctx->dirty_hi = offset + len;
+	} else {
+		ctx->dirty_lo = MIN(ctx->dirty_lo, offset);
+		ctx->dirty_hi = MAX(ctx->dirty_hi, offset + len);
+	}
+}
+
+static void rgbkbd_mark_dirty(struct rgbkbd *ctx, uint8_t offset, uint8_t len)
+{
+	mutex_lock(&rgbkbd_fb_mutex);
+	rgbkbd_mark_dirty_locked(ctx, offset, len);
+	mutex_unlock(&rgbkbd_fb_mutex);
+}
+
+static bool rgbkbd_is_dirty(void)
+{
+	int i;
+
+	for (i = 0; i < rgbkbd_count; i++) {
+		if (rgbkbds[i].dirty_lo < rgbkbds[i].dirty_hi)
+			return true;
+	}
+
+	return false;
+}
+
+/* Push the dirty range of each grid to its LED driver. */
+static int rgbkbd_flush(void)
+{
+	struct rgbkbd *ctx;
+	uint8_t lo, hi;
+	int e, i, rv = EC_SUCCESS;
+	bool sent = false;
+
+	mutex_lock(&rgbkbd_fb_mutex);
+	for (i = 0; i < rgbkbd_count; i++) {
+		ctx = &rgbkbds[i];
+		lo = ctx->dirty_lo;
+		hi = ctx->dirty_hi;
+		if (lo >= hi)
+			continue;
+		ctx->dirty_lo = 0;
+		ctx->dirty_hi = 0;
+
+		e = ctx->cfg->drv->set_color(ctx, lo, &ctx->buf[lo], hi - lo);
+		if (e) {
+			CPRINTS("Failed to set color of LED %u-%u Grid%d (%d)",
+				lo, hi - 1, i, e);
+			rv = e;
+		}
+		sent = true;
+	}
+	if (sent)
+		rgbkbd_flush_rv = rv;
+	mutex_unlock(&rgbkbd_fb_mutex);
+
+	/* Return EC_SUCCESS or the last error. */
+	return rv;
+}
+
+#ifdef CONFIG_RGBKBD_BACK_BUFFER
+/* Frame uploaded by the AP, indexed by matrix position. */
+static struct rgb_s back_buf[RGBKBD_MATRIX_MAX_SIZE];
+
+/* Set when back_buf should be shown on the next frame tick. */
+static bool swap_pending;
+/* Set when back_buf was written since it was last swapped in or reset. */
+static bool back_written;
+
+static int rgbkbd_write_back(int start, const struct rgb_s *color, int len)
+{
+	int rv = EC_SUCCESS;
+
+	if (start + len > rgbkbd_hsize * rgbkbd_vsize ||
+	    start + len > ARRAY_SIZE(back_buf))
+		return EC_ERROR_OVERFLOW;
+
+	mutex_lock(&rgbkbd_fb_mutex);
+	/* Don't let the next frame leak into the one waiting to be shown. */
+	if (swap_pending) {
+		rv = EC_ERROR_BUSY;
+	} else {
+		memcpy(&back_buf[start], color, len * SIZE_OF_RGB);
+		back_written = true;
+	}
+	mutex_unlock(&rgbkbd_fb_mutex);
+
+	return rv;
+}
+
+static void rgbkbd_reset_back(struct rgb_s color)
+{
+	int i;
+
+	mutex_lock(&rgbkbd_fb_mutex);
+	for (i = 0; i < MIN(rgbkbd_hsize * rgbkbd_vsize, ARRAY_SIZE(back_buf));
+	     i++)
+		back_buf[i] = color;
+	swap_pending = false;
+	back_written = false;
+	mutex_unlock(&rgbkbd_fb_mutex);
+}
+
+/*
+ * Show back_buf on the next frame tick. A swap without a back buffer write
+ * since the last swap or reset is rejected, since it would show a stale frame.
+ */
+static int rgbkbd_request_swap(void)
+{
+	int rv = EC_SUCCESS;
+
+	mutex_lock(&rgbkbd_fb_mutex);
+	if (back_written) {
+		swap_pending = true;
+		back_written = false;
+	} else {
+		rv = EC_ERROR_INVAL;
+	}
+	mutex_unlock(&rgbkbd_fb_mutex);
+
+	return rv;
+}
+
+/* Copy back_buf to the grids, marking only the LEDs that changed dirty. */
+static void rgbkbd_swap_buffers(void)
+{
+	const struct rgb_s *back = back_buf;
+	struct rgbkbd *ctx;
+	int i, j;
+
+	mutex_lock(&rgbkbd_fb_mutex);
+	if (!swap_pending) {
+		mutex_unlock(&rgbkbd_fb_mutex);
+		return;
+	}
+
+	for (i = 0; i < rgbkbd_count; i++) {
+		ctx = &rgbkbds[i];
+		for (j = 0; j < get_grid_size(ctx); j++) {
+			if (!memcmp(&ctx->buf[j], &back[j], SIZE_OF_RGB))
+				continue;
+			ctx->buf[j] = back[j];
+			rgbkbd_mark_dirty_locked(ctx, j, 1);
+		}
+		back += get_grid_size(ctx);
+	}
+	swap_pending = false;
+	mutex_unlock(&rgbkbd_fb_mutex);
+}
+#else
+static bool swap_pending;
+
+static int rgbkbd_write_back(int start, const struct rgb_s *color, int len)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static void rgbkbd_reset_back(struct rgb_s color)
+{
+}
+
+static int rgbkbd_request_swap(void)
+{
+	return EC_ERROR_UNIMPLEMENTED;
+}
+
+static void rgbkbd_swap_buffers(void)
+{
+}
+#endif /* CONFIG_RGBKBD_BACK_BUFFER */
+
+/*
+ * Flush the framebuffer if the frame rate cap allows it. This is the only
+ * place a pending back buffer is swapped in.
+ *
+ * @return Microseconds until the pending changes may be flushed, or -1 if
+ *         nothing is pending.
+ */
+static int rgbkbd_frame_tick(void)
+{
+	uint64_t now = get_time().val;
+
+	if (!rgbkbd_is_dirty() && !swap_pending)
+		return -1;
+
+	if (now < next_frame_time)
+		return next_frame_time - now;
+
+	next_frame_time = now + RGBKBD_FRAME_US;
+	rgbkbd_swap_buffers();
+	rgbkbd_flush();
+
+	return -1;
+}
+
+static void rgbkbd_request_flush(void)
+{
+	task_set_event(TASK_ID_RGBKBD, TASK_EVENT_RGBKBD_FLUSH);
+}
+
+/*
+ * Set the color of one LED. The LED is written on the next frame, so a
+ * driver failure is reported by the writes that follow it.
+ *
+ * @return EC_SUCCESS, or the driver error of the last frame flushed.
+ */
 static int set_color_single(struct rgb_s color, int x, int y)
 {
 	struct rgbkbd *ctx = &rgbkbds[0];
-	uint8_t grid, col, offset;
+	uint8_t col, offset;
 	int rv;
 
 	if (rgbkbd_hsize <= x || rgbkbd_vsize <= y) {
@@ -80,35 +316,56 @@ static int set_color_single(struct rgb_s color, int x, int y)
 	}
 
 	ctx = find_grid_from_x(x, &col);
-	grid = RGBKBD_CTX_TO_GRID(ctx);
 	offset = ctx->cfg->row_len * (x - col) + y;
+	mutex_lock(&rgbkbd_fb_mutex);
 	ctx->buf[offset] = color;
+	rgbkbd_mark_dirty_locked(ctx, offset, 1);
+	rv = rgbkbd_flush_rv;
+	mutex_unlock(&rgbkbd_fb_mutex);
 
-	rv = ctx->cfg->drv->set_color(ctx, offset, &ctx->buf[offset], 1);
-
-	CPRINTS("%set (%d,%d) to color=(%d,%d,%d) grid=%u offset=%u (%d)",
-		rv ? "Failed to s" : "S", x, y, color.r, color.g, color.b, grid,
-		offset, rv);
+	rgbkbd_request_flush();
 
 	return rv;
 }
 
-test_export_static uint8_t get_grid_size(const struct rgbkbd *ctx)
+/*
+ * Copy <len> colors to the framebuffer starting at matrix position <start>,
+ * which is counted as x * rgbkbd_vsize + y. Since every grid is rgbkbd_vsize
+ * tall, a run of matrix positions is a run of LEDs within each grid.
+ */
+static int rgbkbd_write_frame(int start, const struct rgb_s *color, int len)
 {
-	return ctx->cfg->col_len * ctx->cfg->row_len;
+	struct rgbkbd *ctx;
+	uint8_t col, offset, n;
+
+	if (start + len > rgbkbd_hsize * rgbkbd_vsize)
+		return EC_ERROR_OVERFLOW;
+
+	/* Don't let a flush see half of the run. */
+	mutex_lock(&rgbkbd_fb_mutex);
+	while (len > 0) {
+		ctx = find_grid_from_x(start / rgbkbd_vsize, &col);
+		offset = start - col * rgbkbd_vsize;
+		n = MIN(len, get_grid_size(ctx) - offset);
+		memcpy(&ctx->buf[offset], color, n * SIZE_OF_RGB);
+		rgbkbd_mark_dirty_locked(ctx, offset, n);
+		start += n;
+		color += n;
+		len -= n;
+	}
+	mutex_unlock(&rgbkbd_fb_mutex);
+
+	rgbkbd_request_flush();
+
+	return EC_SUCCESS;
 }
 
 static void sync_grids(void)
 {
-	struct rgbkbd *ctx;
-	uint8_t len;
 	int i;
 
-	for (i = 0; i < rgbkbd_count; i++) {
-		ctx = &rgbkbds[i];
-		len = get_grid_size(ctx);
-		ctx->cfg->drv->set_color(ctx, 0, ctx->buf, len);
-	}
+	for (i = 0; i < rgbkbd_count; i++)
+		rgbkbd_mark_dirty(&rgbkbds[i], 0, get_grid_size(&rgbkbds[i]));
 }
 
 test_export_static struct rgb_s rotate_color(struct rgb_s color, int step)
@@ -135,7 +392,9 @@ static void rgbkbd_reset_color(struct rgb_s color)
 			ctx->buf[j] = color;
 	}
 
+	rgbkbd_reset_back(color);
 	sync_grids();
+	rgbkbd_flush();
 }
 
 static void rgbkbd_demo_flow(void)
@@ -482,11 +741,28 @@ const struct kblight_drv kblight_rgbkbd = {
 
 void rgbkbd_task(void *u)
 {
+	uint32_t event;
+	int timeout, frame_wait;
+	bool frame_only;
+
 	rgbkbd_init_lookup_table();
 
 	while (1) {
-		task_wait_event(demo_interval_ms * MSEC);
-		if (demo)
+		/*
+		 * Sleep until the next demo step, or until the frame rate cap
+		 * lets pending changes out if that comes first.
+		 */
+		timeout = demo_interval_ms * MSEC;
+		frame_wait = rgbkbd_frame_tick();
+		frame_only = frame_wait > 0 &&
+			     (timeout <= 0 || frame_wait < timeout);
+		if (frame_only)
+			timeout = frame_wait;
+
+		event = task_wait_event(timeout);
+		if (frame_only)
+			event &= ~TASK_EVENT_TIMER;
+		if (demo && (event & ~TASK_EVENT_RGBKBD_FLUSH))
 			rgbkbd_demo_run(demo);
 	}
 }
@@ -562,6 +838,48 @@ static enum ec_status hc_rgbkbd(struct host_cmd_handler_args *args)
 }
 DECLARE_HOST_COMMAND(EC_CMD_RGBKBD, hc_rgbkbd, EC_VER_MASK(0));
 
+static enum ec_status hc_rgbkbd_frame(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_rgbkbd_frame *p = args->params;
+	struct ec_response_rgbkbd_frame *r = args->response;
+	int rv;
+
+	if (args->params_size < sizeof(*p) ||
+	    args->params_size < sizeof(*p) + p->length * SIZE_OF_RGB)
+		return EC_RES_INVALID_PARAM;
+
+	if (p->flags & ~(EC_RGBKBD_FRAME_BACK | EC_RGBKBD_FRAME_SWAP))
+		return EC_RES_INVALID_PARAM;
+
+	if (p->flags && !IS_ENABLED(CONFIG_RGBKBD_BACK_BUFFER))
+		return EC_RES_UNAVAILABLE;
+
+	if (rgbkbd_late_init())
+		return EC_RES_ERROR;
+
+	if (p->flags & EC_RGBKBD_FRAME_BACK)
+		rv = rgbkbd_write_back(p->start, p->color, p->length);
+	else
+		rv = rgbkbd_write_frame(p->start, p->color, p->length);
+	if (rv == EC_ERROR_BUSY)
+		return EC_RES_BUSY;
+	if (rv)
+		return EC_RES_INVALID_PARAM;
+
+	if (p->flags & EC_RGBKBD_FRAME_SWAP) {
+		if (rgbkbd_request_swap())
+			return EC_RES_INVALID_PARAM;
+		rgbkbd_request_flush();
+	}
+
+	r->hsize = rgbkbd_hsize;
+	r->vsize = rgbkbd_vsize;
+	args->response_size = sizeof(*r);
+
+	return EC_RES_SUCCESS;
+}
+DECLARE_HOST_COMMAND(EC_CMD_RGBKBD_FRAME, hc_rgbkbd_frame, EC_VER_MASK(0));
+
 static int int_to_rgb(const char *code, struct rgb_s *rgb)
 {
 	int val;
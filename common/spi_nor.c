@@ -29,8 +29,8 @@
 /* This driver only supports v1.* SFDP. */
 #define SPI_NOR_SUPPORTED_SFDP_MAJOR_VERSION 1
 
-/* Ensure a Serial NOR Flash read command in 4B addressing mode fits. */
-BUILD_ASSERT(CONFIG_SPI_NOR_MAX_READ_SIZE + 5 <=
+/* Ensure a Serial NOR Flash fast read command in 4B addressing mode fits. */
+BUILD_ASSERT(CONFIG_SPI_NOR_MAX_READ_SIZE + 6 <=
 	     CONFIG_SPI_NOR_MAX_MESSAGE_SIZE);
 /* The maximum write size must be a power of two so it can be used as an
  * emulated maximum page size. */
@@ -49,6 +49,16 @@ static struct mutex driver_mutex;
  * public APIs (read, write, erase). */
 static uint8_t buf[CONFIG_SPI_NOR_MAX_MESSAGE_SIZE];
 
+/* Erase types used when the part didn't advertise a suitable one. */
+static const struct spi_nor_erase_type default_4kib_erase = {
+	.opcode = SPI_NOR_DRIVER_SPECIFIED_OPCODE_4KIB_ERASE,
+	.size_exp = 12,
+};
+static const struct spi_nor_erase_type default_64kib_erase = {
+	.opcode = SPI_NOR_DRIVER_SPECIFIED_OPCODE_64KIB_ERASE,
+	.size_exp = 16,
+};
+
 /******************************************************************************/
 /* Internal driver functions. */
 
@@ -146,9 +156,11 @@ err_free:
 }
 
 /**
- * Block until the Serial NOR Flash clears the BUSY/WIP bit in its status reg.
+ * Block until the Serial NOR Flash clears the BUSY/WIP bit in its status reg,
+ * or until timeout_usec has elapsed.
  */
-static int spi_nor_wait(const struct spi_nor_device_t *spi_nor_device)
+static int spi_nor_wait_timeout(const struct spi_nor_device_t *spi_nor_device,
+				uint32_t timeout_usec)
 {
 	int rv = EC_SUCCESS;
 	timestamp_t timeout;
@@ -157,7 +169,7 @@ static int spi_nor_wait(const struct spi_nor_device_t *spi_nor_device)
 	rv = spi_nor_read_status(spi_nor_device, &status_register_value);
 	if (rv)
 		return rv;
-	timeout.val = get_time().val + spi_nor_device->timeout_usec;
+	timeout.val = get_time().val + timeout_usec;
 	while (status_register_value & SPI_NOR_STATUS_REGISTER_WIP) {
 		/* Reload the watchdog before sleeping. */
 		watchdog_reload();
@@ -177,6 +189,15 @@ static int spi_nor_wait(const struct spi_nor_device_t *spi_nor_device)
 	return rv;
 }
 
+/**
+ * Block until the Serial NOR Flash clears the BUSY/WIP bit in its status reg.
+ */
+static int spi_nor_wait(const struct spi_nor_device_t *spi_nor_device)
+{
+	return spi_nor_wait_timeout(spi_nor_device,
+				    spi_nor_device->timeout_usec);
+}
+
 /**
  * Read the Manufacturer bank and ID out of the JEDEC ID.
  */
@@ -442,6 +463,148 @@ static int spi_nor_device_discover_sfdp_capacity(
 	return EC_SUCCESS;
 }
 
+/**
+ * Convert a SFDP v1.5 typical erase time to a maximum time in microseconds.
+ */
+static uint32_t sfdp_erase_timeout_usec(uint32_t unit_usec, uint32_t count,
+					uint32_t max_mult)
+{
+	uint64_t usec = (uint64_t)(count + 1) * unit_usec * 2 * (max_mult + 1);
+
+	return MIN(usec, UINT32_MAX);
+}
+
+/**
+ * Helper function to lookup the part's multi-I/O read modes, erase types and
+ * chip erase time in the SFDP Basic SPI Flash NOR Parameter Table.
+ */
+static int spi_nor_device_discover_sfdp_erase_types(
+	struct spi_nor_device_t *spi_nor_device,
+	uint8_t basic_parameter_table_major_version,
+	uint8_t basic_parameter_table_minor_version,
+	uint32_t basic_parameter_table_offset, uint8_t *read_modes,
+	struct spi_nor_erase_type *erase_types,
+	uint32_t *chip_erase_timeout_usec)
+{
+	static const uint32_t erase_unit_usec[] = { 1000, 16 * 1000,
+						    128 * 1000, 1000 * 1000 };
+	static const uint32_t chip_erase_unit_usec[] = { 16 * 1000, 256 * 1000,
+							 4 * 1000 * 1000,
+							 64 * 1000 * 1000 };
+	int rv = EC_SUCCESS;
+	uint32_t dw1, dw8, dw9, dw10 = 0, dw11;
+	uint32_t max_mult = 0;
+	struct spi_nor_erase_type type;
+	size_t i, j, count = 0;
+
+	if (basic_parameter_table_major_version != 1)
+		return EC_SUCCESS;
+
+	rv = spi_nor_read_sfdp_dword(spi_nor_device,
+				     basic_parameter_table_offset, 1, &dw1);
+	rv |= spi_nor_read_sfdp_dword(spi_nor_device,
+				      basic_parameter_table_offset, 8, &dw8);
+	rv |= spi_nor_read_sfdp_dword(spi_nor_device,
+				      basic_parameter_table_offset, 9, &dw9);
+	if (basic_parameter_table_minor_version >= 5) {
+		rv |= spi_nor_read_sfdp_dword(spi_nor_device,
+					      basic_parameter_table_offset, 10,
+					      &dw10);
+		rv |= spi_nor_read_sfdp_dword(spi_nor_device,
+					      basic_parameter_table_offset, 11,
+					      &dw11);
+		max_mult = SFDP_GET_BITFIELD(BFPT_1_5_DW10_ERASE_TIME_MAX_MULT,
+					     dw10);
+	}
+	if (rv)
+		return rv;
+
+	*read_modes = 0;
+	if (SFDP_GET_BITFIELD(BFPT_1_0_DW1_1_1_2_SUPPORTED, dw1))
+		*read_modes |= SPI_NOR_READ_MODE_1_1_2;
+	if (SFDP_GET_BITFIELD(BFPT_1_0_DW1_1_2_2_SUPPORTED, dw1))
+		*read_modes |= SPI_NOR_READ_MODE_1_2_2;
+	if (SFDP_GET_BITFIELD(BFPT_1_0_DW1_1_1_4_SUPPORTED, dw1))
+		*read_modes |= SPI_NOR_READ_MODE_1_1_4;
+	if (SFDP_GET_BITFIELD(BFPT_1_0_DW1_1_4_4_SUPPORTED, dw1))
+		*read_modes |= SPI_NOR_READ_MODE_1_4_4;
+
+	memset(erase_types, 0, sizeof(*erase_types) * SPI_NOR_ERASE_TYPES);
+	for (i = 0; i < SPI_NOR_ERASE_TYPES; i++) {
+		/* Erase types 1 and 2 are in DW8, 3 and 4 in DW9. */
+		uint32_t dw = i < 2 ? dw8 : dw9;
+		uint32_t shift = (i % 2) * 16;
+
+		type.size_exp = (dw >> shift) & 0xFF;
+		type.opcode = (dw >> (shift + 8)) & 0xFF;
+		type.timeout_usec = 0;
+		if (dw10) {
+			/* Each type time is 7 bits, after the max mult. */
+			uint32_t time = dw10 >> (4 + i * 7);
+
+			type.timeout_usec = sfdp_erase_timeout_usec(
+				erase_unit_usec[(time >> 5) & 0x3],
+				time & 0x1F, max_mult);
+		}
+
+		/* Erase types must keep 4KiB alignment without overflowing
+		 * BIT(size_exp), and the larger ones need a known erase time
+		 * to not trip the command timeout. */
+		if (type.size_exp < 12 ||
+		    type.size_exp > SPI_NOR_MAX_ERASE_SIZE_EXP)
+			continue;
+		if (type.size_exp > 12 && !type.timeout_usec &&
+		    !IS_ENABLED(CONFIG_SPI_NOR_BLOCK_ERASE))
+			continue;
+
+		/* Insert, keeping the largest erase types first. */
+		for (j = count; j > 0; j--) {
+			if (erase_types[j - 1].size_exp >= type.size_exp)
+				break;
+			erase_types[j] = erase_types[j - 1];
+		}
+		erase_types[j] = type;
+		count++;
+	}
+
+	*chip_erase_timeout_usec = 0;
+	if (basic_parameter_table_minor_version >= 5)
+		*chip_erase_timeout_usec = sfdp_erase_timeout_usec(
+			chip_erase_unit_usec[SFDP_GET_BITFIELD(
+				BFPT_1_5_DW11_CHIP_ERASE_TIME_UNIT, dw11)],
+			SFDP_GET_BITFIELD(BFPT_1_5_DW11_CHIP_ERASE_TIME_CNT,
+					  dw11),
+			max_mult);
+
+	return EC_SUCCESS;
+}
+
+/**
+ * Pick the largest erase type which is aligned to offset and fits in size.
+ */
+static const struct spi_nor_erase_type *
+spi_nor_select_erase_type(const struct spi_nor_device_t *spi_nor_device,
+			  uint32_t offset, size_t size)
+{
+	const struct spi_nor_erase_type *type;
+	size_t i;
+
+	for (i = 0; i < SPI_NOR_ERASE_TYPES; i++) {
+		type = &spi_nor_device->erase_types[i];
+		if (!type->size_exp)
+			break;
+		if (!(offset & (BIT(type->size_exp) - 1)) &&
+		    size >= BIT(type->size_exp))
+			return type;
+	}
+
+	if (IS_ENABLED(CONFIG_SPI_NOR_BLOCK_ERASE) && !(offset % 65536) &&
+	    size >= 65536)
+		return &default_64kib_erase;
+
+	return &default_4kib_erase;
+}
+
 static int spi_nor_read_internal(const struct spi_nor_device_t *spi_nor_device,
 				 uint32_t offset, size_t size, uint8_t *data)
 {
@@ -455,7 +618,8 @@ static int spi_nor_read_internal(const struct spi_nor_device_t *spi_nor_device,
 		size_t read_command_size;
 
 		/* Set up the read command in the TX buffer. */
-		buf[0] = SPI_NOR_OPCODE_SLOW_READ;
+		buf[0] = spi_nor_device->fast_read ? SPI_NOR_OPCODE_FAST_READ :
+						     SPI_NOR_OPCODE_SLOW_READ;
 		if (spi_nor_device->in_4b_addressing_mode) {
 			buf[1] = (offset & 0xFF000000) >> 24;
 			buf[2] = (offset & 0xFF0000) >> 16;
@@ -468,6 +632,9 @@ static int spi_nor_read_internal(const struct spi_nor_device_t *spi_nor_device,
 			buf[3] = (offset & 0xFF);
 			read_command_size = 4;
 		}
+		/* Fast read has 8 dummy clocks after the address. */
+		if (spi_nor_device->fast_read)
+			buf[read_command_size++] = 0;
 
 		rv = spi_transaction(
 			&spi_devices[spi_nor_device->spi_controller], buf,
@@ -520,6 +687,10 @@ int spi_nor_init(void)
 		if (rv == EC_SUCCESS) {
 			size_t page_size = 0;
 			uint32_t capacity = 0;
+			uint8_t read_modes = 0;
+			struct spi_nor_erase_type
+				erase_types[SPI_NOR_ERASE_TYPES] = {};
+			uint32_t chip_erase_timeout_usec = 0;
 
 			rv |= spi_nor_device_discover_sfdp_page_size(
 				spi_nor_device, table_major_rev,
@@ -527,10 +698,21 @@ int spi_nor_init(void)
 			rv |= spi_nor_device_discover_sfdp_capacity(
 				spi_nor_device, table_major_rev,
 				table_minor_rev, table_offset, &capacity);
+			rv |= spi_nor_device_discover_sfdp_erase_types(
+				spi_nor_device, table_major_rev,
+				table_minor_rev, table_offset, &read_modes,
+				erase_types, &chip_erase_timeout_usec);
 			if (rv == EC_SUCCESS) {
 				mutex_lock(&driver_mutex);
 				spi_nor_device->capacity = capacity;
 				spi_nor_device->page_size = page_size;
+				/* SFDP parts all support Fast Read. */
+				spi_nor_device->fast_read = 1;
+				spi_nor_device->read_modes = read_modes;
+				memcpy(spi_nor_device->erase_types,
+				       erase_types, sizeof(erase_types));
+				spi_nor_device->chip_erase_timeout_usec =
+					chip_erase_timeout_usec;
 				CPRINTS(spi_nor_device,
 					"Updated to SFDP params: %dKiB w/ %dB pages",
 					spi_nor_device->capacity >> 10,
@@ -649,7 +831,9 @@ int spi_nor_read(const struct spi_nor_device_t *spi_nor_device, uint32_t offset,
 }
 
 /**
- * Erase flash on the Serial Flash Device.
+ * Erase flash on the Serial Flash Device. Each step uses the largest erase
+ * type which is aligned and fits in the remaining range, or a chip erase if
+ * the whole part is erased.
  *
  * @param spi_nor_device The Serial NOR Flash device to use.
  * @param offset Flash offset to erase, must be aligned to the minimum physical
@@ -664,6 +848,8 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 	int rv = EC_SUCCESS;
 	size_t erase_command_size, erase_size;
 	uint8_t erase_opcode;
+	const struct spi_nor_erase_type *erase_type;
+	uint32_t wait_usec = spi_nor_device->timeout_usec;
 #ifdef CONFIG_SPI_NOR_SMART_ERASE
 	BUILD_ASSERT((CONFIG_SPI_NOR_MAX_READ_SIZE % 4) == 0);
 	uint8_t buffer[CONFIG_SPI_NOR_MAX_READ_SIZE] __aligned(4);
@@ -677,22 +863,40 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 	/* Claim the driver mutex. */
 	mutex_lock(&driver_mutex);
 
+	/* Erase the whole part in one command if its erase time is known. */
+	if (offset == 0 && size == spi_nor_device->capacity &&
+	    spi_nor_device->chip_erase_timeout_usec) {
+		rv = spi_nor_wait(spi_nor_device);
+		if (rv)
+			goto err_free;
+
+		rv = spi_nor_write_enable(spi_nor_device);
+		if (rv)
+			goto err_free;
+
+		buf[0] = SPI_NOR_OPCODE_CHIP_ERASE;
+		rv = spi_transaction(
+			&spi_devices[spi_nor_device->spi_controller], buf, 1,
+			NULL, 0);
+		if (rv)
+			goto err_free;
+
+		wait_usec = MAX(wait_usec,
+				spi_nor_device->chip_erase_timeout_usec);
+		size = 0;
+	}
+
 	while (size > 0) {
-		erase_opcode = SPI_NOR_DRIVER_SPECIFIED_OPCODE_4KIB_ERASE;
-		erase_size = 4096;
+		erase_type = spi_nor_select_erase_type(spi_nor_device, offset,
+						       size);
+		erase_opcode = erase_type->opcode;
+		erase_size = BIT(erase_type->size_exp);
 
 		/* Wait for the previous operation to finish. */
-		rv = spi_nor_wait(spi_nor_device);
+		rv = spi_nor_wait_timeout(spi_nor_device, wait_usec);
 		if (rv)
 			goto err_free;
 
-#ifdef CONFIG_SPI_NOR_BLOCK_ERASE
-		if (!(offset % 65536) && size >= 65536) {
-			erase_opcode =
-				SPI_NOR_DRIVER_SPECIFIED_OPCODE_64KIB_ERASE;
-			erase_size = 65536;
-		}
-#endif
 #ifdef CONFIG_SPI_NOR_SMART_ERASE
 		read_offset = offset;
 		read_left = erase_size;
@@ -769,12 +973,15 @@ int spi_nor_erase(const struct spi_nor_device_t *spi_nor_device,
 		if (rv)
 			goto err_free;
 
+		/* Larger erase types may take longer than a command. */
+		wait_usec = MAX(spi_nor_device->timeout_usec,
+				erase_type->timeout_usec);
 		offset += erase_size;
 		size -= erase_size;
 	}
 
 	/* Wait for the previous operation to finish. */
-	rv = spi_nor_wait(spi_nor_device);
+	rv = spi_nor_wait_timeout(spi_nor_device, wait_usec);
 
 err_free:
 	/* Release the driver mutex. */
@@ -878,6 +1085,7 @@ static int command_spi_nor_info(int argc, const char **argv)
 	const struct spi_nor_device_t *spi_nor_device = 0;
 	int spi_nor_device_index = 0;
 	int spi_nor_device_index_limit = spi_nor_devices_used - 1;
+	size_t i;
 
 	/* Set the device index limits if a device was specified. */
 	if (argc == 2) {
@@ -903,7 +1111,23 @@ static int command_spi_nor_info(int argc, const char **argv)
 			ccprintf("\tAddressing: %s addressing mode\n",
 				 spi_nor_device->in_4b_addressing_mode ? "4B" :
 									 "3B");
-		ccprintf("\tPage Size: %d Bytes\n", spi_nor_device->page_size);
+		ccprintf("\tPage Size: %zu Bytes\n", spi_nor_device->page_size);
+		ccprintf("\tRead: %s, multi-I/O modes 0x%x\n",
+			 spi_nor_device->fast_read ? "Fast Read" : "Read",
+			 spi_nor_device->read_modes);
+		for (i = 0; i < SPI_NOR_ERASE_TYPES; i++) {
+			const struct spi_nor_erase_type *type =
+				&spi_nor_device->erase_types[i];
+
+			if (!type->size_exp)
+				break;
+			ccprintf("\tErase: %d KiB w/ opcode 0x%02x\n",
+				 BIT(type->size_exp) >> 10, type->opcode);
+		}
+		if (spi_nor_device->chip_erase_timeout_usec)
+			ccprintf("\tChip Erase: up to %d mSec\n",
+				 spi_nor_device->chip_erase_timeout_usec /
+					 MSEC);
 
 		/* Get JEDEC ID info. */
 		rv = spi_nor_read_jedec_mfn_id(spi_nor_device, &mfn_bank,
@@ -922,7 +1146,7 @@ static int command_spi_nor_info(int argc, const char **argv)
 			continue; /* Go on to the next device. */
 		}
 		ccprintf("\tSFDP v%d.%d\n", sfdp_major_rev, sfdp_minor_rev);
-		ccprintf("\tFlash Parameter Table v%d.%d (%dB @ 0x%x)\n",
+		ccprintf("\tFlash Parameter Table v%d.%d (%zuB @ 0x%x)\n",
 			 table_major_rev, table_minor_rev, table_size,
 			 table_offset);
 	}
@@ -59,7 +59,116 @@ static cond_t cond_hot[EC_TEMP_THRESH_COUNT];
 static int first_read_delay = CONFIG_TEMP_SENSOR_FIRST_READ_DELAY_MS;
 #endif
 
-static void thermal_control(void)
+/*
+ * Latest sample of each sensor and what it contributes to the aggregated
+ * limits. A sensor is only re-evaluated when its reading crosses one of its
+ * thresholds, counting their release temperatures, or when its fan request
+ * or its thresholds change.
+ */
+static struct thermal_sensor_state {
+	int temp;
+	int rv;
+	/* Bitmasks of the thresholds that are set, exceeded and released */
+	uint8_t valid;
+	uint8_t over;
+	uint8_t under;
+	/* Fan percent needed, or -1 if the sensor has no fan limits */
+	int8_t fan;
+	bool evaluated;
+	/* Thresholds the contribution was computed with */
+	struct ec_thermal_config params;
+} sensor_state[TEMP_SENSOR_COUNT];
+
+/* Number of thermal_control() runs, for per-sensor read schedules */
+static uint32_t thermal_runs;
+
+#ifdef CONFIG_CMD_THERMALSTATS
+static struct {
+	uint32_t last_us;
+	uint32_t max_us;
+	uint64_t total_us;
+	uint32_t runs;
+	uint32_t reads;
+	uint32_t evaluations;
+} thermal_stats;
+#define THERMAL_STATS_INC(field) (thermal_stats.field++)
+#else
+#define THERMAL_STATS_INC(field)
+#endif
+
+test_mockable_static int thermal_sensor_poll_period(int i)
+{
+	return temp_sensors[i].poll_period_s;
+}
+
+/*
+ * Check if a sensor is due to be read. Sensors with a longer period are
+ * staggered by index so they don't all get read in the same second.
+ */
+static bool thermal_sensor_due(int i)
+{
+	int period = thermal_sensor_poll_period(i);
+
+	if (period <= 1 || !sensor_state[i].evaluated)
+		return true;
+
+	return (thermal_runs + i) % period == 0;
+}
+
+static void thermal_evaluate_sensor(int i, int rv, int t)
+{
+	struct thermal_sensor_state *s = &sensor_state[i];
+	const struct ec_thermal_config *p = &thermal_params[i];
+	uint8_t valid = 0, over = 0, under = 0;
+	int8_t fan = -1;
+	int j;
+
+	s->temp = t;
+
+	if (rv == EC_SUCCESS) {
+		/* check all the limits */
+		for (j = 0; j < EC_TEMP_THRESH_COUNT; j++) {
+			int limit = p->temp_host[j];
+			int release = p->temp_host_release[j];
+			if (limit) {
+				valid |= BIT(j);
+				if (t > limit) {
+					over |= BIT(j);
+				} else if (release) {
+					if (t < release)
+						under |= BIT(j);
+				} else if (t < limit) {
+					under |= BIT(j);
+				}
+			}
+		}
+
+		/* figure out the fan needed, too */
+		if (p->temp_fan_off && p->temp_fan_max)
+			fan = thermal_fan_percent(p->temp_fan_off,
+						  p->temp_fan_max, t);
+	}
+
+	/*
+	 * A reading that moves around between a limit and its release, or
+	 * anywhere else without crossing a threshold, changes nothing.
+	 */
+	if (s->evaluated && rv == s->rv && valid == s->valid &&
+	    over == s->over && under == s->under && fan == s->fan &&
+	    !memcmp(&s->params, p, sizeof(*p)))
+		return;
+
+	THERMAL_STATS_INC(evaluations);
+	s->rv = rv;
+	s->params = *p;
+	s->evaluated = true;
+	s->valid = valid;
+	s->over = over;
+	s->under = under;
+	s->fan = fan;
+}
+
+static void thermal_evaluate(void)
 {
 	int i, j, t, rv;
 	int count_over[EC_TEMP_THRESH_COUNT];
@@ -68,7 +177,6 @@ static void thermal_control(void)
 	int num_sensors_read;
 #ifdef CONFIG_FANS
 #ifndef CONFIG_CUSTOM_FAN_CONTROL
-	int f = 0;
 	int fmax = 0;
 	int temp_fan_configured = 0;
 #else
@@ -93,47 +201,40 @@ static void thermal_control(void)
 
 	/* go through all the sensors */
 	for (i = 0; i < TEMP_SENSOR_COUNT; ++i) {
-		/* read one */
-		rv = temp_sensor_read(i, &t);
+		struct thermal_sensor_state *s = &sensor_state[i];
+
+		/* read the ones that are due, reuse the last reading if not */
+		if (thermal_sensor_due(i)) {
+			t = s->temp;
+			rv = temp_sensor_read(i, &t);
+			THERMAL_STATS_INC(reads);
+			thermal_evaluate_sensor(i, rv, t);
+		}
 
 #if defined(CONFIG_FANS) && defined(CONFIG_CUSTOM_FAN_CONTROL)
 		/* Store all sensors value */
-		temp[i] = K_TO_C(t);
+		temp[i] = K_TO_C(s->temp);
 #endif
 
-		if (rv != EC_SUCCESS)
+		if (s->rv != EC_SUCCESS)
 			continue;
 		else
 			num_sensors_read++;
 
-		/* check all the limits */
 		for (j = 0; j < EC_TEMP_THRESH_COUNT; j++) {
-			int limit = thermal_params[i].temp_host[j];
-			int release = thermal_params[i].temp_host_release[j];
-			if (limit) {
+			if (s->valid & BIT(j))
 				num_valid_limits[j]++;
-				if (t > limit) {
-					count_over[j]++;
-				} else if (release) {
-					if (t < release)
-						count_under[j]++;
-				} else if (t < limit) {
-					count_under[j]++;
-				}
-			}
+			if (s->over & BIT(j))
+				count_over[j]++;
+			if (s->under & BIT(j))
+				count_under[j]++;
 		}
 
 #ifdef CONFIG_FANS
 #ifndef CONFIG_CUSTOM_FAN_CONTROL
 		/* figure out the max fan needed, too */
-		if (thermal_params[i].temp_fan_off &&
-		    thermal_params[i].temp_fan_max) {
-			f = thermal_fan_percent(thermal_params[i].temp_fan_off,
-						thermal_params[i].temp_fan_max,
-						t);
-			if (f > fmax)
-				fmax = f;
-
+		if (s->fan >= 0) {
+			fmax = MAX(fmax, s->fan);
 			temp_fan_configured = 1;
 		}
 #endif
@@ -235,6 +336,25 @@ static void thermal_control(void)
 #endif
 }
 
+static void thermal_control(void)
+{
+#ifdef CONFIG_CMD_THERMALSTATS
+	timestamp_t start = get_time();
+	uint32_t elapsed;
+#endif
+
+	thermal_evaluate();
+	thermal_runs++;
+
+#ifdef CONFIG_CMD_THERMALSTATS
+	elapsed = time_since32(start);
+	thermal_stats.last_us = elapsed;
+	thermal_stats.max_us = MAX(thermal_stats.max_us, elapsed);
+	thermal_stats.total_us += elapsed;
+	thermal_stats.runs++;
+#endif
+}
+
 /* Wait until after the sensors have been read */
 DECLARE_HOOK(HOOK_SECOND, thermal_control, HOOK_PRIO_TEMP_SENSOR_DONE);
 
@@ -306,6 +426,35 @@ DECLARE_CONSOLE_COMMAND(thermalset, command_thermalset,
 			"Set thermal parameters (degrees Kelvin)."
 			" Use -1 to skip.");
 
+#ifdef CONFIG_CMD_THERMALSTATS
+static int command_thermalstats(int argc, const char **argv)
+{
+	uint64_t avg_us;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(&thermal_stats, 0, sizeof(thermal_stats));
+		return EC_SUCCESS;
+	}
+
+	avg_us = thermal_stats.total_us;
+	if (thermal_stats.runs)
+		uint64divmod(&avg_us, thermal_stats.runs);
+
+	ccprintf("runs:        %u\n", thermal_stats.runs);
+	ccprintf("last us:     %u\n", thermal_stats.last_us);
+	ccprintf("max us:      %u\n", thermal_stats.max_us);
+	ccprintf("avg us:      %u\n", (uint32_t)avg_us);
+	ccprintf("reads:       %u\n", thermal_stats.reads);
+	ccprintf("evaluations: %u\n", thermal_stats.evaluations);
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(thermalstats, command_thermalstats, "[clear]",
+			"Print time spent in thermal control");
+#endif /* CONFIG_CMD_THERMALSTATS */
+
 /*****************************************************************************/
 /* Host commands. We'll reuse the host command number, but this is version 1,
  * not version 0. Different structs, different meanings.
@@ -53,17 +53,65 @@ static int tx_snapshot_tail;
 static int tx_last_snapshot_head;
 static int tx_next_snapshot_head;
 static int tx_checksum __preserved_logs(tx_checksum);
+/* Byte sum of the characters between tx_buf_tail and tx_buf_head */
+static uint32_t tx_sum __preserved_logs(tx_sum);
+
+#ifndef CONFIG_POLLING_UART
+/*
+ * Producers reserve space at tx_buf_reserve, fill it outside of any critical
+ * section, and commit it. tx_buf_head only moves up to tx_buf_reserve when
+ * the last outstanding reservation is committed, so the consumer never sees
+ * a partially filled reservation and lines from different contexts do not
+ * interleave.
+ *
+ * This is not lock-free: the index bookkeeping runs with interrupts disabled
+ * (see tx_lock()). Commits are also published in order, so a reservation
+ * whose writer is preempted before committing holds back all output reserved
+ * after it until that writer runs again.
+ */
+static int tx_buf_reserve;
+static int tx_writers;
+/* Byte sum of committed characters not yet published at tx_buf_head */
+static uint32_t tx_pending_sum;
+#endif
 
 static int uart_buffer_calc_checksum(void)
 {
 	return tx_buf_head ^ tx_buf_tail;
 }
 
+static uint32_t uart_buffer_sum(const char *s, int len)
+{
+	uint32_t sum = 0;
+	int i;
+
+	for (i = 0; i < len; i++)
+		sum += (uint8_t)s[i];
+
+	return sum;
+}
+
+/* Sum of the characters in the transmit buffer from <start> to <end> */
+static uint32_t uart_buffer_sum_range(int start, int end)
+{
+	int first;
+
+	if (end >= start)
+		return uart_buffer_sum((const char *)tx_buf + start,
+				       end - start);
+
+	first = CONFIG_UART_TX_BUF_SIZE - start;
+	return uart_buffer_sum((const char *)tx_buf + start, first) +
+	       uart_buffer_sum((const char *)tx_buf, end);
+}
+
 void uart_init_buffer(void)
 {
 	if (tx_checksum != uart_buffer_calc_checksum() ||
 	    !IN_RANGE(tx_buf_head, 0, CONFIG_UART_TX_BUF_SIZE - 1) ||
-	    !IN_RANGE(tx_buf_tail, 0, CONFIG_UART_TX_BUF_SIZE - 1)) {
+	    !IN_RANGE(tx_buf_tail, 0, CONFIG_UART_TX_BUF_SIZE - 1) ||
+	    (IS_ENABLED(CONFIG_PRESERVE_LOGS) &&
+	     tx_sum != uart_buffer_sum_range(tx_buf_tail, tx_buf_head))) {
 		/*
 		 * NOTE:
 		 * We are here because EC cold reset or RO/RW's preserve_logs
@@ -72,47 +120,230 @@ void uart_init_buffer(void)
 		tx_buf_head = 0;
 		tx_buf_tail = 0;
 		tx_checksum = 0;
+		tx_sum = 0;
 	}
+
+#ifndef CONFIG_POLLING_UART
+	tx_buf_reserve = tx_buf_head;
+#endif
 }
 
-int uart_tx_char_raw(void *context, int c)
+#ifndef CONFIG_POLLING_UART
+/*
+ * Reservation bookkeeping only takes a few instructions, so it runs with
+ * interrupts disabled rather than making producers wait on each other.
+ */
+static bool tx_lock(void)
 {
-	int tx_buf_next, tx_buf_new_tail;
+	bool enabled = is_interrupt_enabled();
 
-#if defined CONFIG_POLLING_UART
-	(void)tx_buf_next;
-	(void)tx_buf_new_tail;
-	uart_write_char(c);
-#else
+	interrupt_disable();
+	return enabled;
+}
 
-	tx_buf_next = TX_BUF_NEXT(tx_buf_head);
-	if (tx_buf_next == tx_buf_tail)
-		return 1;
+static void tx_unlock(bool enabled)
+{
+	if (enabled)
+		interrupt_enable();
+}
+
+/* Check if writing n characters at head would step on the given index. */
+static bool tx_span_covers(int index, int head, int n)
+{
+	int diff = TX_BUF_DIFF(index, head);
+
+	return diff >= 1 && diff <= n;
+}
+
+/* Free space for reservations; one slot stays empty to tell full from empty */
+static int tx_free_locked(void)
+{
+	return TX_BUF_DIFF(tx_buf_tail, tx_buf_reserve + 1);
+}
+
+/*
+ * Reserve n characters, which must fit. Returns the index of the first one.
+ */
+static int tx_reserve_locked(int n)
+{
+	int start = tx_buf_reserve;
+	int end = (start + n) & (CONFIG_UART_TX_BUF_SIZE - 1);
 
 	/*
 	 * If we do a READ_RECENT, the buffer may have wrapped around, and
 	 * we'll drop most of the logs in this case. Make sure the place
-	 * we read from in that case is always ahead of the new tx_buf_head.
+	 * we read from in that case is always ahead of the new output.
 	 *
 	 * We also want to make sure that the next time we snapshot and want
 	 * to READ_RECENT, we don't start reading from a stale tail.
 	 */
-	tx_buf_new_tail = TX_BUF_NEXT(tx_buf_next);
-	if (tx_buf_next == tx_last_snapshot_head &&
+	if (tx_span_covers(tx_last_snapshot_head, start, n) &&
 	    tx_last_snapshot_head != tx_snapshot_head)
-		tx_last_snapshot_head = tx_buf_new_tail;
-	if (tx_buf_next == tx_next_snapshot_head)
-		tx_next_snapshot_head = tx_buf_new_tail;
+		tx_last_snapshot_head = TX_BUF_NEXT(end);
+	if (tx_span_covers(tx_next_snapshot_head, start, n))
+		tx_next_snapshot_head = TX_BUF_NEXT(end);
 
-	tx_buf[tx_buf_head] = c;
-	tx_buf_head = tx_buf_next;
+	tx_buf_reserve = end;
+	tx_writers++;
 
-	if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
+	return start;
+}
+
+static void tx_commit_locked(uint32_t sum)
+{
+	tx_pending_sum += sum;
+	if (--tx_writers)
+		return;
+
+	/* Last writer out publishes everything reserved so far. */
+	tx_buf_head = tx_buf_reserve;
+
+	if (IS_ENABLED(CONFIG_PRESERVE_LOGS)) {
+		tx_sum += tx_pending_sum;
 		tx_checksum = uart_buffer_calc_checksum();
+	}
+	tx_pending_sum = 0;
+}
+
+/* Copy a run of characters into the buffer. Returns their sum if needed. */
+static uint32_t tx_copy(int index, const char *s, int len)
+{
+	int first = MIN(len, CONFIG_UART_TX_BUF_SIZE - index);
+
+	memcpy((char *)tx_buf + index, s, first);
+	memcpy((char *)tx_buf, s + first, len - first);
+
+	return IS_ENABLED(CONFIG_PRESERVE_LOGS) ? uart_buffer_sum(s, len) : 0;
+}
+
+int uart_tx_reserve(struct uart_tx_reservation *res, int len)
+{
+	bool enabled = tx_lock();
+
+	if (len > tx_free_locked()) {
+		tx_unlock(enabled);
+		return EC_ERROR_OVERFLOW;
+	}
+
+	res->start = tx_reserve_locked(len);
+	tx_unlock(enabled);
+
+	res->len = len;
+	res->sum = 0;
+
+	return EC_SUCCESS;
+}
+
+void uart_tx_fill(struct uart_tx_reservation *res, int offset, const char *s,
+		  int len)
+{
+	res->sum += tx_copy((res->start + offset) & (CONFIG_UART_TX_BUF_SIZE - 1),
+			    s, len);
+}
+
+void uart_tx_commit(struct uart_tx_reservation *res)
+{
+	bool enabled = tx_lock();
+
+	tx_commit_locked(res->sum);
+	tx_unlock(enabled);
+}
+#endif /* !CONFIG_POLLING_UART */
+
+int uart_tx_char_raw(void *context, int c)
+{
+#if defined CONFIG_POLLING_UART
+	uart_write_char(c);
+#else
+	bool enabled = tx_lock();
+	int index;
+
+	if (!tx_free_locked()) {
+		tx_unlock(enabled);
+		return 1;
+	}
+
+	index = tx_reserve_locked(1);
+	tx_buf[index] = c;
+	tx_commit_locked((uint8_t)c);
+	tx_unlock(enabled);
 #endif
 	return 0;
 }
 
+int uart_tx_span_raw(void *context, const char *s, int len)
+{
+#if defined CONFIG_POLLING_UART
+	int i;
+
+	for (i = 0; i < len; i++)
+		uart_write_char(s[i]);
+	return len;
+#else
+	struct uart_tx_reservation res;
+	bool enabled = tx_lock();
+	int n;
+
+	/* Take as much of the run as fits. */
+	n = MIN(len, tx_free_locked());
+	if (n <= 0) {
+		tx_unlock(enabled);
+		return 0;
+	}
+
+	res.start = tx_reserve_locked(n);
+	tx_unlock(enabled);
+
+	res.len = n;
+	res.sum = 0;
+	uart_tx_fill(&res, 0, s, n);
+	uart_tx_commit(&res);
+
+	return n;
+#endif
+}
+
+int uart_put_line(const char *s, int len)
+{
+#if defined CONFIG_POLLING_UART
+	return uart_put(s, len) == len ? EC_SUCCESS : EC_ERROR_OVERFLOW;
+#else
+	struct uart_tx_reservation res;
+	const char *nl;
+	int done = 0;
+	int offset = 0;
+	int lines = 0;
+	int n;
+
+	/* '\n' goes out as "\r\n" */
+	for (nl = s; (nl = memchr(nl, '\n', len - (nl - s))); nl++)
+		lines++;
+
+	if (uart_tx_reserve(&res, len + lines))
+		return EC_ERROR_OVERFLOW;
+
+	while (done < len) {
+		nl = memchr(s + done, '\n', len - done);
+		n = nl ? nl - (s + done) : len - done;
+
+		uart_tx_fill(&res, offset, s + done, n);
+		done += n;
+		offset += n;
+
+		if (nl) {
+			uart_tx_fill(&res, offset, "\r\n", 2);
+			done++;
+			offset += 2;
+		}
+	}
+
+	uart_tx_commit(&res);
+	uart_tx_start();
+
+	return EC_SUCCESS;
+#endif
+}
+
 #ifdef CONFIG_UART_TX_DMA
 
 /**
@@ -135,8 +366,12 @@ void uart_process_output(void)
 
 	/* If a previous DMA transfer completed, free up the buffer it used */
 	if (tx_dma_in_progress) {
-		tx_buf_tail = (tx_buf_tail + tx_dma_in_progress) &
-			      (CONFIG_UART_TX_BUF_SIZE - 1);
+		int new_tail = (tx_buf_tail + tx_dma_in_progress) &
+			       (CONFIG_UART_TX_BUF_SIZE - 1);
+
+		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
+			tx_sum -= uart_buffer_sum_range(tx_buf_tail, new_tail);
+		tx_buf_tail = new_tail;
 		tx_dma_in_progress = 0;
 
 		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
@@ -167,6 +402,8 @@ void uart_process_output(void)
 	/* Copy output from buffer until TX fifo full or output buffer empty */
 	while (uart_tx_ready() && (tx_buf_head != tx_buf_tail)) {
 		uart_write_char(tx_buf[tx_buf_tail]);
+		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
+			tx_sum -= (uint8_t)tx_buf[tx_buf_tail];
 		tx_buf_tail = TX_BUF_NEXT(tx_buf_tail);
 
 		if (IS_ENABLED(CONFIG_PRESERVE_LOGS))
@@ -6,6 +6,7 @@
 #include "common.h"
 #include "printf.h"
 #include "uart.h"
+#include "util.h"
 
 #include <stddef.h>
 
@@ -19,6 +20,40 @@ static int __tx_char(void *context, int c)
 	return uart_tx_char_raw(context, c);
 }
 
+/*
+ * Put a run of characters, translating '\n' to '\r\n'. Returns the number of
+ * characters of <s> written.
+ */
+static int __tx_span(const char *s, int len)
+{
+	const char *nl;
+	int done = 0;
+	int n, written;
+
+	while (done < len) {
+		nl = memchr(s + done, '\n', len - done);
+		n = nl ? nl - (s + done) : len - done;
+
+		written = uart_tx_span_raw(NULL, s + done, n);
+		done += written;
+		if (written < n)
+			break;
+
+		if (nl) {
+			if (__tx_char(NULL, '\n'))
+				break;
+			done++;
+		}
+	}
+
+	return done;
+}
+
+static int __tx_addspan(void *context, const char *s, int len)
+{
+	return __tx_span(s, len) != len;
+}
+
 int uart_putc(int c)
 {
 	int rv = __tx_char(NULL, c);
@@ -30,29 +65,21 @@ int uart_putc(int c)
 
 int uart_puts(const char *outstr)
 {
+	int len = strlen(outstr);
+
 	/* Put all characters in the output buffer */
-	for (; *outstr != '\0'; ++outstr) {
-		if (__tx_char(NULL, *outstr) != 0) {
-			break;
-		}
-	}
+	int written = __tx_span(outstr, len);
 
 	uart_tx_start();
 
 	/* Successful if we consumed all output */
-	return *outstr ? EC_ERROR_OVERFLOW : EC_SUCCESS;
+	return written < len ? EC_ERROR_OVERFLOW : EC_SUCCESS;
 }
 
 int uart_put(const char *out, int len)
 {
-	int written;
-
 	/* Put all characters in the output buffer */
-	for (written = 0; written < len; written++) {
-		if (__tx_char(NULL, *out++) != 0) {
-			break;
-		}
-	}
+	int written = __tx_span(out, len);
 
 	uart_tx_start();
 
@@ -61,14 +88,8 @@ int uart_put(const char *out, int len)
 
 int uart_put_raw(const char *out, int len)
 {
-	int written;
-
 	/* Put all characters in the output buffer */
-	for (written = 0; written < len; written++) {
-		if (uart_tx_char_raw(NULL, *out++) != 0) {
-			break;
-		}
-	}
+	int written = uart_tx_span_raw(NULL, out, len);
 
 	uart_tx_start();
 
@@ -77,7 +98,11 @@ int uart_put_raw(const char *out, int len)
 
 int uart_vprintf(const char *format, va_list args)
 {
-	int rv = vfnprintf(__tx_char, NULL, format, args);
+	static const struct printf_sink sink = {
+		.addchar = __tx_char,
+		.addspan = __tx_addspan,
+	};
+	int rv = vfnprintf_sink(&sink, NULL, format, args);
 
 	uart_tx_start();
 
@@ -57,6 +57,46 @@ struct {
 	uint32_t top_offset;
 } update_section;
 
+#ifndef CONFIG_FLASH_MULTIPLE_REGION
+/*
+ * In sparse mode the update section is erased one bank at a time, on the
+ * first write into each bank; this bitmap tracks the banks already erased.
+ */
+#define UPDATE_SECTION_BANKS \
+	(GENERIC_MAX(CONFIG_RO_SIZE, CONFIG_RW_SIZE) / CONFIG_FLASH_ERASE_SIZE)
+
+static uint8_t sparse_requested;
+static uint8_t sparse_update;
+static uint32_t sparse_erased[DIV_ROUND_UP(UPDATE_SECTION_BANKS, 32)];
+
+static uint8_t sparse_erase_banks(uint32_t block_offset, size_t body_size)
+{
+	uint32_t base = update_section.base_offset;
+	uint32_t first = (block_offset - base) / CONFIG_FLASH_ERASE_SIZE;
+	uint32_t last = (block_offset + body_size - 1 - base) /
+			CONFIG_FLASH_ERASE_SIZE;
+	uint32_t bank;
+
+	for (bank = first; bank <= last; bank++) {
+		uint32_t offset = base + bank * CONFIG_FLASH_ERASE_SIZE;
+
+		if (sparse_erased[bank / 32] & BIT(bank % 32))
+			continue;
+
+		if (crec_flash_physical_erase(offset,
+					      CONFIG_FLASH_ERASE_SIZE) !=
+		    EC_SUCCESS) {
+			CPRINTF("%s:%d erase failure of 0x%x\n", __func__,
+				__LINE__, offset);
+			return UPDATE_ERASE_FAILURE;
+		}
+		sparse_erased[bank / 32] |= BIT(bank % 32);
+	}
+
+	return UPDATE_SUCCESS;
+}
+#endif /* !CONFIG_FLASH_MULTIPLE_REGION */
+
 #ifdef CONFIG_TOUCHPAD_VIRTUAL_OFF
 /*
  * Check if a block is within touchpad FW virtual address region, and
@@ -90,6 +130,12 @@ static uint8_t check_update_chunk(uint32_t block_offset, size_t body_size)
 	    ((block_offset + body_size) <= update_section.top_offset)) {
 		base = update_section.base_offset;
 		size = update_section.top_offset - update_section.base_offset;
+#ifndef CONFIG_FLASH_MULTIPLE_REGION
+		if (sparse_update)
+			return body_size ? sparse_erase_banks(block_offset,
+							      body_size) :
+					   UPDATE_SUCCESS;
+#endif
 		/*
 		 * If this is the first chunk for this section, it needs to
 		 * be erased.
@@ -184,6 +230,29 @@ static int contents_allowed(uint32_t block_offset, size_t body_size,
 	return 1;
 }
 
+/*
+ * Get the flash range of the image that can be updated, i.e. the one that is
+ * not running. Returns which image it is, or EC_IMAGE_UNKNOWN if there is
+ * none.
+ */
+static enum ec_image get_update_section(uint32_t *base, uint32_t *top)
+{
+	switch (system_get_image_copy()) {
+	case EC_IMAGE_RO:
+		/* RO running, so update RW */
+		*base = CONFIG_RW_MEM_OFF;
+		*top = CONFIG_RW_MEM_OFF + CONFIG_RW_SIZE;
+		return EC_IMAGE_RW;
+	case EC_IMAGE_RW:
+		/* RW running, so update RO */
+		*base = CONFIG_RO_MEM_OFF;
+		*top = CONFIG_RO_MEM_OFF + CONFIG_RO_SIZE;
+		return EC_IMAGE_RO;
+	default:
+		return EC_IMAGE_UNKNOWN;
+	}
+}
+
 /*
  * Setup internal state (e.g. valid sections, and fill first response).
  *
@@ -192,32 +261,28 @@ static int contents_allowed(uint32_t block_offset, size_t body_size,
  */
 void fw_update_start(struct first_response_pdu *rpdu)
 {
+	enum ec_image image;
 	const char *version;
 #ifdef CONFIG_RWSIG_TYPE_RWSIG
 	const struct vb21_packed_key *vb21_key;
 #endif
 
 	rpdu->header_type = htobe16(UPDATE_HEADER_TYPE_COMMON);
+#ifndef CONFIG_FLASH_MULTIPLE_REGION
+	sparse_update = sparse_requested;
+	sparse_requested = 0;
+	memset(sparse_erased, 0, sizeof(sparse_erased));
+#endif
 
 	/* Determine the valid update section. */
-	switch (system_get_image_copy()) {
-	case EC_IMAGE_RO:
-		/* RO running, so update RW */
-		update_section.base_offset = CONFIG_RW_MEM_OFF;
-		update_section.top_offset = CONFIG_RW_MEM_OFF + CONFIG_RW_SIZE;
-		version = system_get_version(EC_IMAGE_RW);
-		break;
-	case EC_IMAGE_RW:
-		/* RW running, so update RO */
-		update_section.base_offset = CONFIG_RO_MEM_OFF;
-		update_section.top_offset = CONFIG_RO_MEM_OFF + CONFIG_RO_SIZE;
-		version = system_get_version(EC_IMAGE_RO);
-		break;
-	default:
+	image = get_update_section(&update_section.base_offset,
+				   &update_section.top_offset);
+	if (image == EC_IMAGE_UNKNOWN) {
 		CPRINTF("%s:%d\n", __func__, __LINE__);
 		rpdu->return_value = htobe32(UPDATE_GEN_ERROR);
 		return;
 	}
+	version = system_get_version(image);
 
 	rpdu->common.maximum_pdu_size = htobe32(CONFIG_UPDATE_PDU_SIZE);
 	rpdu->common.flash_protection = htobe32(crec_flash_get_protect());
@@ -357,3 +422,57 @@ void fw_update_command_handler(void *body, size_t cmd_size,
 void fw_update_complete(void)
 {
 }
+
+int fw_update_request_sparse(uint32_t *erase_size)
+{
+#ifdef CONFIG_FLASH_MULTIPLE_REGION
+	return EC_RES_UNAVAILABLE;
+#else
+	sparse_requested = 1;
+	*erase_size = CONFIG_FLASH_ERASE_SIZE;
+	return EC_RES_SUCCESS;
+#endif
+}
+
+#ifndef CONFIG_FLASH_MULTIPLE_REGION
+BUILD_ASSERT(CONFIG_FLASH_ERASE_SIZE <= UPDATE_FLASH_HASH_MAX_SIZE);
+#endif
+
+int fw_update_flash_hash(uint32_t offset, uint32_t size, uint8_t *digest)
+{
+#if (defined(CONFIG_SHA256_HW_ACCELERATE) || defined(CONFIG_SHA256_SW)) && \
+	!defined(CONFIG_FLASH_MULTIPLE_REGION)
+	struct sha256_ctx ctx;
+	uint8_t chunk[32];
+	uint32_t base, top;
+	uint32_t done;
+
+	/*
+	 * Only hash whole erase banks of the image that can be updated. Hashes
+	 * of small ranges would let the host read the flash a few bytes at a
+	 * time, and the rest of the flash may hold secrets, e.g. the rollback
+	 * secret.
+	 */
+	if (get_update_section(&base, &top) == EC_IMAGE_UNKNOWN || !size ||
+	    size > UPDATE_FLASH_HASH_MAX_SIZE ||
+	    offset % CONFIG_FLASH_ERASE_SIZE ||
+	    size % CONFIG_FLASH_ERASE_SIZE || offset < base || offset > top ||
+	    size > top - offset)
+		return UPDATE_GEN_ERROR;
+
+	SHA256_init(&ctx);
+	for (done = 0; done < size; done += sizeof(chunk)) {
+		uint32_t len = MIN(size - done, sizeof(chunk));
+
+		if (crec_flash_read(offset + done, len, (char *)chunk) !=
+		    EC_SUCCESS)
+			return EC_RES_ERROR;
+		SHA256_update(&ctx, chunk, len);
+	}
+	memcpy(digest, SHA256_final(&ctx), SHA256_DIGEST_SIZE);
+
+	return EC_RES_SUCCESS;
+#else
+	return EC_RES_UNAVAILABLE;
+#endif
+}
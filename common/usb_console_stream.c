@@ -13,6 +13,7 @@
 #include "task.h"
 #include "timer.h"
 #include "usb-stream.h"
+#include "util.h"
 
 #ifdef CONFIG_USB_CONSOLE
 /*
@@ -156,6 +157,56 @@ static int __tx_char(void *context, int c)
 #endif
 }
 
+/* Queue a run of characters containing no '\n'. */
+static int __tx_run(const char *s, int len)
+{
+#ifdef CONFIG_USB_CONSOLE_CRC
+	size_t n;
+
+	crc32_ctx_hash(&usb_tx_crc_ctx, s, len);
+
+	while (len > 0) {
+		n = queue_add_units(&tx_q, s, len);
+		s += n;
+		len -= n;
+		if (len)
+			crec_usleep(500);
+	}
+
+	return EC_SUCCESS;
+#else
+	/* Return 0 on success */
+	return queue_add_units(&tx_q, s, len) == len ? EC_SUCCESS :
+						      EC_ERROR_OVERFLOW;
+#endif
+}
+
+static int __tx_span(void *context, const char *s, int len)
+{
+	const char *nl;
+	int n, ret;
+
+	while (len > 0) {
+		nl = memchr(s, '\n', len);
+		n = nl ? nl - s : len;
+
+		ret = __tx_run(s, n);
+		if (ret)
+			return ret;
+
+		if (nl) {
+			ret = __tx_char(NULL, '\n');
+			if (ret)
+				return ret;
+			n++;
+		}
+		s += n;
+		len -= n;
+	}
+
+	return EC_SUCCESS;
+}
+
 /*
  * Public USB console implementation below.
  */
@@ -183,11 +234,7 @@ int usb_puts(const char *outstr)
 	if (ret)
 		return ret;
 
-	while (*outstr) {
-		ret = __tx_char(NULL, *outstr++);
-		if (ret)
-			break;
-	}
+	ret = __tx_span(NULL, outstr, strlen(outstr));
 	handle_output();
 
 	return ret;
@@ -204,6 +251,10 @@ int usb_putc(int c)
 
 int usb_vprintf(const char *format, va_list args)
 {
+	static const struct printf_sink sink = {
+		.addchar = __tx_char,
+		.addspan = __tx_span,
+	};
 	int ret;
 
 	if (!is_enabled)
@@ -213,7 +264,7 @@ int usb_vprintf(const char *format, va_list args)
 	if (ret)
 		return ret;
 
-	ret = vfnprintf(__tx_char, NULL, format, args);
+	ret = vfnprintf_sink(&sink, NULL, format, args);
 
 	handle_output();
 
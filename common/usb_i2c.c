@@ -13,6 +13,7 @@
 #include "queue_policies.h"
 #include "registers.h"
 #include "task.h"
+#include "timer.h"
 
 #if defined(CONFIG_PLATFORM_EC_USB_I2C)
 #include "drivers/usb_stream.h"
@@ -28,6 +29,10 @@
 
 USB_I2C_CONFIG(i2c, USB_IFACE_I2C, USB_STR_I2C_NAME, USB_EP_I2C)
 
+/* Size of the request at the head of the queue and of its response. */
+static size_t expected_size;
+static size_t response_size;
+
 static int (*cros_cmd_handler)(void *data_in, size_t in_size, void *data_out,
 			       size_t out_size);
 
@@ -49,11 +54,17 @@ static int16_t usb_i2c_map_error(int error)
  * Return value should be large enough to accommodate the entire read queue
  * buffer size. Let's use 4 bytes in case future designs have a lot of RAM and
  * allow for large buffers.
+ *
+ * Only the request at the head of the queue is removed; a pipelined request
+ * behind it stays queued for the next call.
  */
 static uint32_t usb_i2c_read_packet(struct usb_i2c_config const *config)
 {
-	return QUEUE_REMOVE_UNITS(config->consumer.queue, config->buffer,
-				  queue_count(config->consumer.queue));
+	uint32_t count = QUEUE_REMOVE_UNITS(config->consumer.queue,
+					    config->buffer, expected_size);
+
+	expected_size = 0;
+	return count;
 }
 
 static void usb_i2c_write_packet(struct usb_i2c_config const *config,
@@ -64,17 +75,15 @@ static void usb_i2c_write_packet(struct usb_i2c_config const *config,
 
 static uint8_t usb_i2c_executable(struct usb_i2c_config const *config)
 {
-	static size_t expected_size;
-
 	if (!expected_size) {
-		uint8_t peek[4];
+		uint8_t peek[6];
+		size_t read_count;
 
 		/*
 		 * In order to support larger write payload, we need to peek
 		 * the queue to see if we need to wait for more data.
 		 */
-		if (queue_peek_units(config->consumer.queue, peek, 0,
-				     sizeof(peek)) != sizeof(peek)) {
+		if (queue_peek_units(config->consumer.queue, peek, 0, 4) != 4) {
 			/* Not enough data to calculate expected_size. */
 			return 0;
 		}
@@ -83,21 +92,88 @@ static uint8_t usb_i2c_executable(struct usb_i2c_config const *config)
 		 * expected size.
 		 */
 		/* Header bytes  and extra rc bytes, if present. */
-		if (peek[3] & 0x80)
+		if (peek[3] & 0x80) {
+			if (queue_peek_units(config->consumer.queue, peek, 0,
+					     6) != 6)
+				return 0;
 			expected_size = 6;
-		else
+			read_count = ((size_t)peek[4] << 7) | (peek[3] & 0x7f);
+		} else {
 			expected_size = 4;
+			read_count = peek[3];
+		}
 
 		/* write count */
 		expected_size += (((size_t)peek[0] & 0xf0) << 4) | peek[2];
+
+		/*
+		 * Invalid read counts still get a response of that size, but
+		 * never wait for more than the whole transmit queue.
+		 */
+		response_size = MIN(read_count + 4,
+				    config->tx_queue->buffer_units);
 	}
 
-	if (queue_count(config->consumer.queue) >= expected_size) {
-		expected_size = 0;
-		return 1;
+	return queue_count(config->consumer.queue) >= expected_size;
+}
+
+/**
+ * Run a batch of I2C transactions, see "Batched transactions" in usb_i2c.h.
+ *
+ * @param config	USB I2C bridge
+ * @param offset	Offset of the op list in the request payload
+ * @param write_count	Length of the op list
+ * @param read_count	Total read count of all ops
+ * @return USB_I2C status of the batch
+ */
+static int16_t usb_i2c_execute_batch(struct usb_i2c_config const *config,
+				     int offset, int write_count,
+				     int read_count)
+{
+	uint8_t *data = (uint8_t *)(config->buffer + 2);
+	const int size = USB_I2C_BUFFER_SIZE - 4;
+	uint8_t *done = (uint8_t *)config->buffer + 2;
+	uint8_t *op;
+	int reads = 0;
+
+	if (write_count + read_count > size)
+		return USB_I2C_BATCH_INVALID;
+
+	/*
+	 * Read results are stored from the start of the payload, so move the
+	 * ops to the end of the buffer where the results can't reach them.
+	 */
+	op = data + size - write_count;
+	memmove(op, data + offset, write_count);
+	memset(data, 0, read_count);
+
+	while (write_count > 0) {
+		int portindex = op[0];
+		uint16_t addr_flags = op[1] & 0x7f;
+		int wc = op[2];
+		int rc = op[3];
+		int ret;
+
+		if (write_count < 4 || wc > write_count - 4 ||
+		    rc > read_count - reads || *done == UINT8_MAX)
+			return USB_I2C_BATCH_INVALID;
+		if (portindex >= i2c_ports_used)
+			return USB_I2C_PORT_INVALID;
+
+		if (wc || rc) {
+			ret = i2c_xfer(i2c_ports[portindex].port, addr_flags,
+				       op + 4, wc, data + reads, rc);
+			if (ret)
+				return usb_i2c_map_error(ret);
+		}
+
+		reads += rc;
+		op += 4 + wc;
+		write_count -= 4 + wc;
+		(*done)++;
 	}
 
-	return 0;
+	return USB_I2C_SUCCESS;
 }
 
 static void usb_i2c_execute(struct usb_i2c_config const *config)
@@ -130,6 +206,10 @@ static void usb_i2c_execute(struct usb_i2c_config const *config)
 		config->buffer[0] = USB_I2C_WRITE_COUNT_INVALID;
 	} else if (read_count > CONFIG_USB_I2C_MAX_READ_COUNT) {
 		config->buffer[0] = USB_I2C_READ_COUNT_INVALID;
+	} else if (addr_flags == USB_I2C_MULTI_ADDR_FLAGS) {
+		config->buffer[0] = usb_i2c_execute_batch(config, offset,
+							  write_count,
+							  read_count);
 	} else if (portindex >= i2c_ports_used) {
 		config->buffer[0] = USB_I2C_PORT_INVALID;
 	} else if (addr_flags == USB_I2C_CMD_ADDR_FLAGS) {
@@ -164,9 +244,16 @@ static void usb_i2c_execute(struct usb_i2c_config const *config)
 
 void usb_i2c_deferred(struct usb_i2c_config const *config)
 {
-	/* Check if we can proceed the queue. */
-	if (usb_i2c_executable(config))
+	/* Run every complete request that is queued, in order. */
+	while (usb_i2c_executable(config)) {
+		/*
+		 * Wait for the host to collect earlier responses, usb_i2c_read
+		 * runs us again when it does.
+		 */
+		if (queue_space(config->tx_queue) < response_size)
+			return;
 		usb_i2c_execute(config);
+	}
 }
 
 static void usb_i2c_written(struct consumer const *consumer, size_t count)
@@ -181,6 +268,18 @@ struct consumer_ops const usb_i2c_consumer_ops = {
 	.written = usb_i2c_written,
 };
 
+static void usb_i2c_read(struct producer const *producer, size_t count)
+{
+	struct usb_i2c_config const *config =
+		DOWNCAST(producer, struct usb_i2c_config, producer);
+
+	hook_call_deferred(config->deferred, 0);
+}
+
+struct producer_ops const usb_i2c_producer_ops = {
+	.read = usb_i2c_read,
+};
+
 int usb_i2c_register_cros_cmd_handler(int (*cmd_handler)(
 	void *data_in, size_t in_size, void *data_out, size_t out_size))
 {
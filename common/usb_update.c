@@ -442,6 +442,47 @@ static int try_vendor_command(struct consumer const *consumer, size_t count)
 #endif
 			return 1;
 		}
+		case UPDATE_EXTRA_CMD_GET_FLASH_HASH: {
+			struct update_flash_hash_request *req =
+				(void *)(buffer + header_size);
+			uint8_t hash_resp[1 + SHA256_DIGEST_SIZE];
+
+			if (data_count != sizeof(*req)) {
+				response = EC_RES_INVALID_PARAM;
+				break;
+			}
+
+			response = fw_update_flash_hash(be32toh(req->offset),
+							be32toh(req->size),
+							hash_resp + 1);
+			if (response != EC_RES_SUCCESS)
+				break;
+
+			hash_resp[0] = response;
+			QUEUE_ADD_UNITS(&update_to_usb, hash_resp,
+					sizeof(hash_resp));
+			return 1;
+		}
+		case UPDATE_EXTRA_CMD_SPARSE_UPDATE: {
+			struct update_sparse_response sparse_resp;
+			uint32_t erase_size;
+
+			/* Applies to the next session, not a running one. */
+			if (rx_state_ != rx_idle) {
+				response = EC_RES_BUSY;
+				break;
+			}
+
+			response = fw_update_request_sparse(&erase_size);
+			if (response != EC_RES_SUCCESS)
+				break;
+
+			sparse_resp.status = response;
+			sparse_resp.erase_size = htobe32(erase_size);
+			QUEUE_ADD_UNITS(&update_to_usb, &sparse_resp,
+					sizeof(sparse_resp));
+			return 1;
+		}
 		default:
 			response = EC_RES_INVALID_COMMAND;
 		}
@@ -477,6 +518,7 @@ static void update_out_handler(struct consumer const *consumer, size_t count)
 {
 	struct update_frame_header upfr;
 	size_t resp_size;
+	size_t chunk;
 	uint8_t resp_value;
 	uint64_t delta_time;
 
@@ -571,6 +613,13 @@ static void update_out_handler(struct consumer const *consumer, size_t count)
 			}
 		}
 
+		/*
+		 * Vendor commands are also accepted between blocks, so that
+		 * the host can query flash hashes during the transfer.
+		 */
+		if (try_vendor_command(consumer, count))
+			return;
+
 		/*
 		 * At this point we expect a block start message. It is
 		 * sizeof(upfr) bytes in size.
@@ -607,13 +656,18 @@ static void update_out_handler(struct consumer const *consumer, size_t count)
 		return;
 	}
 
-	/* Must be inside block. */
-	QUEUE_REMOVE_UNITS(consumer->queue, block_buffer + block_index, count);
-	block_index += count;
-	block_size -= count;
+	/*
+	 * Must be inside block. Never take more than the rest of the block,
+	 * a host keeping several blocks in flight may already have queued
+	 * the header of the next one.
+	 */
+	chunk = MIN(count, block_size);
+	QUEUE_REMOVE_UNITS(consumer->queue, block_buffer + block_index, chunk);
+	block_index += chunk;
+	block_size -= chunk;
 
 	if (block_size) {
-		if (count <= sizeof(upfr)) {
+		if (chunk <= sizeof(upfr)) {
 			/*
 			 * A block header size instead of chunk size message
 			 * has been received, let's abort the transfer.
@@ -639,6 +693,10 @@ static void update_out_handler(struct consumer const *consumer, size_t count)
 	resp_value = block_buffer[0];
 	QUEUE_ADD_UNITS(&update_to_usb, &resp_value, sizeof(resp_value));
 	rx_state_ = rx_outside_block;
+
+	/* Process whatever followed the block as a new message. */
+	if (count > chunk)
+		update_out_handler(consumer, count - chunk);
 }
 
 struct consumer const update_consumer = {
@@ -73,7 +73,7 @@ void tc_start_event_loop(int port)
 	}
 }
 
-static void pd_task_init(int port)
+test_export_static void pd_task_init(int port)
 {
 	if (IS_ENABLED(CONFIG_USB_TYPEC_SM))
 		tc_state_init(port);
@@ -98,7 +98,7 @@ static void pd_task_init(int port)
 		       GPIO_ODR_HIGH);
 }
 
-static int pd_task_timeout(int port)
+test_export_static int pd_task_timeout(int port)
 {
 	int timeout;
 
@@ -114,11 +114,12 @@ static int pd_task_timeout(int port)
 	return timeout;
 }
 
-static bool pd_task_loop(int port)
+/*
+ * Run the port state machines once for the given set of events. Returns false
+ * when the task needs to be re-initialized.
+ */
+test_export_static bool pd_task_handle_events(int port, uint32_t evt)
 {
-	/* wait for next event/packet or timeout expiration */
-	const uint32_t evt = task_wait_event(pd_task_timeout(port));
-
 	/* Manage expired PD Timers on timeouts */
 	if (evt & TASK_EVENT_TIMER)
 		pd_timer_manage_expired(port);
@@ -160,6 +161,13 @@ static bool pd_task_loop(int port)
 	return true;
 }
 
+static bool pd_task_loop(int port)
+{
+	/* wait for next event/packet or timeout expiration */
+	return pd_task_handle_events(port,
+				     task_wait_event(pd_task_timeout(port)));
+}
+
 void pd_task(void *u)
 {
 	int port = TASK_ID_TO_PD_PORT(task_get_current());
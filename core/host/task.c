@@ -167,7 +167,11 @@ void task_trigger_test_interrupt(void (*isr)(void))
 
 	/* Suspend current task and execute ISR */
 	pending_isr = isr;
-	if (task_started) {
+	if (task_started &&
+	    pthread_equal(tasks[running_task_id].thread, pthread_self())) {
+		/* The running task interrupts itself: skip the signal. */
+		_task_execute_isr(SIGNAL_INTERRUPT);
+	} else if (task_started) {
 		pthread_kill(tasks[running_task_id].thread, SIGNAL_INTERRUPT);
 	} else {
 		main_pid = getpid();
@@ -214,6 +218,8 @@ atomic_t *task_get_event_bitmap(task_id_t tskid)
 	return &tasks[tskid].event;
 }
 
+static task_id_t task_schedule(void);
+
 uint32_t task_wait_event(int timeout_us)
 {
 	int tid = task_get_current();
@@ -222,9 +228,22 @@ uint32_t task_wait_event(int timeout_us)
 	if (timeout_us > 0)
 		tasks[tid].wake_time.val = get_time().val + timeout_us;
 
-	/* Transfer control to scheduler */
-	pthread_cond_signal(&scheduler_cond);
-	pthread_cond_wait(&tasks[tid].resume, &run_lock);
+	if (!task_started) {
+		/* Transfer control to scheduler */
+		pthread_cond_signal(&scheduler_cond);
+		pthread_cond_wait(&tasks[tid].resume, &run_lock);
+	} else {
+		/*
+		 * Hand over to the next task directly, unless it is this one
+		 * (e.g. a task polling on a timeout): then just keep going.
+		 */
+		task_id_t next = task_schedule();
+
+		if (next != tid) {
+			pthread_cond_signal(&tasks[next].resume);
+			pthread_cond_wait(&tasks[tid].resume, &run_lock);
+		}
+	}
 
 	/* Resume */
 	ret = atomic_clear(&tasks[tid].event);
@@ -415,40 +434,53 @@ int task_start_called(void)
 	return task_started;
 }
 
-void task_scheduler(void)
+/*
+ * Pick the next task to run, fast forwarding the time if none is ready yet,
+ * and mark it as running.
+ */
+static task_id_t task_schedule(void)
 {
 	int i;
 	timestamp_t now;
 
-	task_started = 1;
-
-	while (1) {
-		now = get_time();
-		i = TASK_ID_COUNT - 1;
-		while (i >= 0) {
-			/*
-			 * Only tasks with spawned threads are valid to be
-			 * resumed.
-			 */
-			if (tasks[i].thread) {
-				if (tasks[i].event ||
-				    now.val >= tasks[i].wake_time.val)
-					break;
-			}
-			--i;
+	now = get_time();
+	i = TASK_ID_COUNT - 1;
+	while (i >= 0) {
+		/*
+		 * Only tasks with spawned threads are valid to be
+		 * resumed.
+		 */
+		if (tasks[i].thread) {
+			if (tasks[i].event ||
+			    now.val >= tasks[i].wake_time.val)
+				break;
 		}
-		if (i < 0)
-			i = fast_forward();
+		--i;
+	}
+	if (i < 0)
+		i = fast_forward();
 
-		now = get_time();
-		if (now.val >= tasks[i].wake_time.val)
-			tasks[i].event |= TASK_EVENT_TIMER;
-		tasks[i].wake_time.val = ~0ull;
-		running_task_id = i;
-		tasks[i].started = 1;
-		pthread_cond_signal(&tasks[i].resume);
+	now = get_time();
+	if (now.val >= tasks[i].wake_time.val)
+		tasks[i].event |= TASK_EVENT_TIMER;
+	tasks[i].wake_time.val = ~0ull;
+	running_task_id = i;
+	tasks[i].started = 1;
+	return i;
+}
+
+void task_scheduler(void)
+{
+	task_started = 1;
+
+	/*
+	 * Start the first task. From then on, tasks hand over to each other in
+	 * task_wait_event(), so that switching tasks is a single thread wake
+	 * up, and no thread switch at all when a task is the next one to run.
+	 */
+	pthread_cond_signal(&tasks[task_schedule()].resume);
+	while (1)
 		pthread_cond_wait(&scheduler_cond, &run_lock);
-	}
 }
 
 void *_task_start_impl(void *a)
@@ -495,10 +495,73 @@ static bool battery_want_charge(struct batt_params *batt)
 	return false;
 }
 
+/*
+ * Values that change slowly are cached here and only re-read from the gauge
+ * every CONFIG_BATTERY_SLOW_PARAMS_INTERVAL_SEC, after a failed read, or when
+ * the status shows an event that may make the gauge re-learn its capacity.
+ */
+#define SB_STATUS_CAPACITY_EVENTS \
+	(STATUS_FULLY_CHARGED | STATUS_FULLY_DISCHARGED | STATUS_DISCHARGING)
+
+static struct {
+	bool valid;
+	int status;
+	int full_capacity;
+	timestamp_t expires;
+} sb_slow_params;
+
+void sb_flush_params_cache(void)
+{
+	sb_slow_params.valid = false;
+}
+
+#ifdef CONFIG_CMD_BATT_PARAMS_STATS
+static struct {
+	uint32_t passes;
+	uint32_t reads;
+	uint32_t cached;
+	uint32_t last_us;
+	uint32_t max_us;
+	uint64_t total_us;
+} sb_params_stats;
+
+#define PARAMS_STATS_INC(field) (sb_params_stats.field++)
+#else
+#define PARAMS_STATS_INC(field)
+#endif
+
+/* Read one register for battery_get_params(), tracking whether any worked. */
+static int sb_params_read(int cmd, int *param, bool *responsive)
+{
+	int rv = sb_read(cmd, param);
+
+	PARAMS_STATS_INC(reads);
+	if (!rv)
+		*responsive = true;
+	return rv;
+}
+
+static bool sb_slow_params_stale(int status, bool status_ok)
+{
+	if (!sb_slow_params.valid || !status_ok)
+		return true;
+
+	if ((status ^ sb_slow_params.status) & SB_STATUS_CAPACITY_EVENTS)
+		return true;
+
+	return timestamp_expired(sb_slow_params.expires, NULL);
+}
+
 void battery_get_params(struct batt_params *batt)
 {
 	struct batt_params batt_new;
+	bool responsive = false;
+	bool status_ok, mode_ok;
 	int v;
+#ifdef CONFIG_CMD_BATT_PARAMS_STATS
+	timestamp_t start = get_time();
+	uint32_t elapsed;
+#endif
 
 	/*
 	 * Start with a copy so that only valid fields will be updated. Note
@@ -508,7 +571,8 @@ void battery_get_params(struct batt_params *batt)
 	memcpy(&batt_new, batt, sizeof(*batt));
 	batt_new.flags &= ~BATT_FLAG_VOLATILE;
 
-	if (sb_read(SB_TEMPERATURE, &batt_new.temperature) &&
+	if (sb_params_read(SB_TEMPERATURE, &batt_new.temperature,
+			   &responsive) &&
 	    fake_temperature < 0)
 		batt_new.flags |= BATT_FLAG_BAD_TEMPERATURE;
 
@@ -516,40 +580,78 @@ void battery_get_params(struct batt_params *batt)
 	if (fake_temperature >= 0)
 		batt_new.temperature = fake_temperature;
 
-	if (sb_read(SB_RELATIVE_STATE_OF_CHARGE, &batt_new.state_of_charge) &&
+	if (sb_params_read(SB_RELATIVE_STATE_OF_CHARGE,
+			   &batt_new.state_of_charge, &responsive) &&
 	    fake_state_of_charge < 0)
 		batt_new.flags |= BATT_FLAG_BAD_STATE_OF_CHARGE;
 
-	if (sb_read(SB_VOLTAGE, &batt_new.voltage))
+	if (sb_params_read(SB_VOLTAGE, &batt_new.voltage, &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_VOLTAGE;
 
 	/* This is a signed 16-bit value. */
-	if (sb_read(SB_CURRENT, &v))
+	if (sb_params_read(SB_CURRENT, &v, &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_CURRENT;
 	else
 		batt_new.current = (int16_t)v;
 
-	if (sb_read(SB_AVERAGE_CURRENT, &v))
+	if (sb_params_read(SB_AVERAGE_CURRENT, &v, &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_AVERAGE_CURRENT;
 
-	if (sb_read(SB_CHARGING_VOLTAGE, &batt_new.desired_voltage))
+	if (sb_params_read(SB_CHARGING_VOLTAGE, &batt_new.desired_voltage,
+			   &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_DESIRED_VOLTAGE;
 
-	if (sb_read(SB_CHARGING_CURRENT, &batt_new.desired_current))
+	if (sb_params_read(SB_CHARGING_CURRENT, &batt_new.desired_current,
+			   &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_DESIRED_CURRENT;
 
-	if (battery_remaining_capacity(&batt_new.remaining_capacity))
+	status_ok = !sb_params_read(SB_BATTERY_STATUS, &batt_new.status,
+				    &responsive);
+	if (!status_ok)
+		batt_new.flags |= BATT_FLAG_BAD_STATUS;
+
+	/* Both capacities need mAh mode; check it once for the pair. */
+	mode_ok = !sb_params_read(SB_BATTERY_MODE, &v, &responsive);
+	if (mode_ok && (v & MODE_CAPACITY))
+		mode_ok = !sb_write(SB_BATTERY_MODE, v & ~MODE_CAPACITY);
+
+	if (!mode_ok || sb_params_read(SB_REMAINING_CAPACITY,
+				       &batt_new.remaining_capacity,
+				       &responsive))
 		batt_new.flags |= BATT_FLAG_BAD_REMAINING_CAPACITY;
 
-	if (battery_full_charge_capacity(&batt_new.full_capacity))
-		batt_new.flags |= BATT_FLAG_BAD_FULL_CAPACITY;
+	if (sb_slow_params_stale(batt_new.status, status_ok)) {
+		sb_slow_params.valid =
+			mode_ok && !sb_params_read(SB_FULL_CHARGE_CAPACITY,
+						   &sb_slow_params.full_capacity,
+						   &responsive);
+		sb_slow_params.status = batt_new.status;
+		sb_slow_params.expires.val =
+			get_time().val +
+			CONFIG_BATTERY_SLOW_PARAMS_INTERVAL_SEC * SECOND;
+	} else {
+		PARAMS_STATS_INC(cached);
+	}
 
-	if (battery_status(&batt_new.status))
-		batt_new.flags |= BATT_FLAG_BAD_STATUS;
+	if (sb_slow_params.valid)
+		batt_new.full_capacity = sb_slow_params.full_capacity;
+	else
+		batt_new.flags |= BATT_FLAG_BAD_FULL_CAPACITY;
 
 	/* If any of those reads worked, the battery is responsive */
-	if ((batt_new.flags & BATT_FLAG_BAD_ANY) != BATT_FLAG_BAD_ANY)
+	if (responsive)
 		batt_new.flags |= BATT_FLAG_RESPONSIVE;
+	else
+		/* It may be a different pack when it comes back */
+		sb_flush_params_cache();
+
+#ifdef CONFIG_CMD_BATT_PARAMS_STATS
+	elapsed = time_since32(start);
+	sb_params_stats.passes++;
+	sb_params_stats.last_us = elapsed;
+	sb_params_stats.max_us = MAX(sb_params_stats.max_us, elapsed);
+	sb_params_stats.total_us += elapsed;
+#endif
 
 #ifdef CONFIG_BATTERY_MEASURE_IMBALANCE
 	if (battery_imbalance_mv() > CONFIG_BATTERY_MAX_IMBALANCE_MV)
@@ -586,6 +688,34 @@ void battery_get_params(struct batt_params *batt)
 	/* Update visible battery parameters */
 	memcpy(batt, &batt_new, sizeof(*batt));
 }
+
+#ifdef CONFIG_CMD_BATT_PARAMS_STATS
+static int command_batt_params_stats(int argc, const char **argv)
+{
+	uint32_t passes = sb_params_stats.passes;
+
+	if (argc > 1) {
+		if (strcasecmp(argv[1], "clear"))
+			return EC_ERROR_PARAM1;
+		memset(&sb_params_stats, 0, sizeof(sb_params_stats));
+		return EC_SUCCESS;
+	}
+
+	ccprintf("Passes:        %u\n", passes);
+	if (!passes)
+		return EC_SUCCESS;
+
+	ccprintf("Reads/pass:    %u\n", sb_params_stats.reads / passes);
+	ccprintf("Cached passes: %u\n", sb_params_stats.cached);
+	ccprintf("SMBus time:    last %u us, max %u us, avg %u us\n",
+		 sb_params_stats.last_us, sb_params_stats.max_us,
+		 (uint32_t)(sb_params_stats.total_us / passes));
+
+	return EC_SUCCESS;
+}
+DECLARE_CONSOLE_COMMAND(battparamstats, command_batt_params_stats, "[clear]",
+			"Show SMBus cost of battery_get_params()");
+#endif /* CONFIG_CMD_BATT_PARAMS_STATS */
 #endif /* !CONFIG_FUEL_GAUGE */
 
 /* Wait until battery is totally stable */
@@ -152,22 +152,54 @@ static int is31fl3733b_enable(struct rgbkbd *ctx, bool enable)
 static int is31fl3733b_set_color(struct rgbkbd *ctx, uint8_t offset,
 				 struct rgb_s *color, uint8_t len)
 {
+	/* Register address followed by up to one row of PWM values. */
+	uint8_t r[IS31FL3733B_ROW_SIZE + 1];
+	uint8_t g[IS31FL3733B_ROW_SIZE + 1];
+	uint8_t b[IS31FL3733B_ROW_SIZE + 1];
+	const uint8_t row_len = ctx->cfg->row_len;
 	int led_addr, led_addr_row, led_addr_col;
-	int i, rv;
+	int first, i, n, rv;
+
+	/* Every LED must land in a PWM register row before anything is sent. */
+	if (len && (offset + len - 1) / row_len >= IS31FL3733B_ROW_SIZE) {
+		return EC_ERROR_OVERFLOW;
+	}
 
 	rv = is31fl3733b_set_page(ctx, IS31FL3733B_PAGE_PWM);
 	if (rv) {
 		return rv;
 	}
 
-	for (i = 0; i < len; i++) {
-		led_addr_row = (offset + i) % ctx->cfg->row_len;
-		led_addr_col = (offset + i) / ctx->cfg->row_len;
-		led_addr = led_addr_row * 0x30 + led_addr_col;
+	/*
+	 * PWM registers of one row are contiguous and the chip increments the
+	 * register address on each byte written. So write each channel of a
+	 * row in one burst instead of one transfer per LED per channel.
+	 */
+	for (led_addr_row = 0; led_addr_row < row_len; led_addr_row++) {
+		first = (led_addr_row + row_len - offset % row_len) % row_len;
+		n = 0;
+		for (i = first; i < len; i += row_len) {
+			n++;
+			r[n] = color[i].r;
+			g[n] = color[i].g;
+			b[n] = color[i].b;
+		}
+		if (!n) {
+			continue;
+		}
 
-		rv = is31fl3733b_write(ctx, led_addr + 0x00, color[i].r);
-		rv |= is31fl3733b_write(ctx, led_addr + 0x10, color[i].g);
-		rv |= is31fl3733b_write(ctx, led_addr + 0x20, color[i].b);
+		led_addr_col = (offset + first) / row_len;
+		led_addr = led_addr_row * 0x30 + led_addr_col;
+		r[0] = led_addr + 0x00;
+		g[0] = led_addr + 0x10;
+		b[0] = led_addr + 0x20;
+
+		rv = i2c_xfer(ctx->cfg->i2c, IS31FL3733B_ADDR_FLAGS, r, n + 1,
+			      NULL, 0);
+		rv |= i2c_xfer(ctx->cfg->i2c, IS31FL3733B_ADDR_FLAGS, g, n + 1,
+			       NULL, 0);
+		rv |= i2c_xfer(ctx->cfg->i2c, IS31FL3733B_ADDR_FLAGS, b, n + 1,
+			       NULL, 0);
 
 		if (rv) {
 			return rv;
@@ -15,6 +15,7 @@
 #include <fmap.h>
 #include <getopt.h>
 #include <libusb.h>
+#include <openssl/sha.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -69,6 +70,9 @@ struct transfer_descriptor {
 	 */
 	uint32_t offset;
 
+	/* Erase bank size if the target agreed to a sparse update, or 0. */
+	uint32_t sparse_erase_size;
+
 	struct usb_endpoint uep;
 };
 
@@ -78,13 +82,18 @@ static struct first_response_pdu targ;
 static uint16_t protocol_version;
 static uint16_t header_type;
 static char *progname;
-static char *short_opts = "bd:efg:hjlnp:rsS:tuw";
+static char *short_opts = "bd:efFg:hjlnp:rsS:tuwW:";
+/* Number of blocks sent before waiting for their confirmation. */
+static int window_size = 1;
+/* Blocks sent whose confirmation has not been received yet. */
+static int blocks_in_flight;
 static const struct option long_opts[] = {
 	/* name    hasarg *flag val */
 	{ "binvers", 1, NULL, 'b' },
 	{ "device", 1, NULL, 'd' },
 	{ "entropy", 0, NULL, 'e' },
 	{ "fwver", 0, NULL, 'f' },
+	{ "full", 0, NULL, 'F' },
 	{ "tp_debug", 1, NULL, 'g' },
 	{ "help", 0, NULL, 'h' },
 	{ "jump_to_rw", 0, NULL, 'j' },
@@ -97,6 +106,7 @@ static const struct option long_opts[] = {
 	{ "tp_info", 0, NULL, 't' },
 	{ "unlock_rollback", 0, NULL, 'u' },
 	{ "unlock_rw", 0, NULL, 'w' },
+	{ "window", 1, NULL, 'W' },
 	{},
 };
 
@@ -122,6 +132,8 @@ static void usage(int errs)
 	       "  -d,--device  VID:PID     USB device (default %04x:%04x)\n"
 	       "  -e,--entropy             Add entropy to device secret\n"
 	       "  -f,--fwver               Report running firmware versions.\n"
+	       "  -F,--full                Send the whole image, even blocks "
+	       "already in flash\n"
 	       "  -g,--tp_debug <hex data> Touchpad debug command\n"
 	       "  -h,--help                Show this message\n"
 	       "  -j,--jump_to_rw          Tell EC to jump to RW\n"
@@ -133,6 +145,8 @@ static void usage(int errs)
 	       "  -t,--tp_info             Get touchpad information\n"
 	       "  -u,--unlock_rollback     Tell EC to unlock the rollback region\n"
 	       "  -w,--unlock_rw           Tell EC to unlock the RW region\n"
+	       "  -W,--window  N           Keep up to N blocks in flight "
+	       "(default 1, max 64)\n"
 	       "\n",
 	       progname, VID, PID);
 
@@ -506,14 +520,11 @@ static void usb_findit(uint16_t vid, uint16_t pid, char *serialno,
 	printf("READY\n-------\n");
 }
 
-static int transfer_block(struct usb_endpoint *uep,
-			  struct update_frame_header *ufh,
-			  uint8_t *transfer_data_ptr, size_t payload_size)
+static void send_block(struct usb_endpoint *uep,
+		       struct update_frame_header *ufh,
+		       uint8_t *transfer_data_ptr, size_t payload_size)
 {
 	size_t transfer_size;
-	uint32_t reply;
-	int actual;
-	int r;
 
 	/* First send the header. */
 	xfer(uep, ufh, sizeof(*ufh), NULL, 0, 0);
@@ -529,51 +540,67 @@ static int transfer_block(struct usb_endpoint *uep,
 		transfer_size += chunk_size;
 	}
 
-	/* Now get the reply. */
-	r = libusb_bulk_transfer(uep->devh, uep->in_ep.addr, (void *)&reply,
-				 sizeof(reply), &actual, 5000);
-	if (r) {
-		if (r == -7) {
-			fprintf(stderr, "Timeout!\n");
-			return r;
+	blocks_in_flight++;
+}
+
+/*
+ * Read block confirmations until no more than max_in_flight blocks are
+ * outstanding. The target may pack several one byte confirmations in a single
+ * USB packet.
+ */
+static int wait_for_blocks(struct usb_endpoint *uep, int max_in_flight)
+{
+	uint8_t reply[64];
+	int actual;
+	int r;
+	int i;
+
+	while (blocks_in_flight > max_in_flight) {
+		r = libusb_bulk_transfer(uep->devh, uep->in_ep.addr, reply,
+					 sizeof(reply), &actual, 5000);
+		if (r) {
+			if (r == -7) {
+				fprintf(stderr, "Timeout!\n");
+				blocks_in_flight = 0;
+				return r;
+			}
+			USB_ERROR("libusb_bulk_transfer", r);
+			shut_down(uep);
 		}
-		USB_ERROR("libusb_bulk_transfer", r);
-		shut_down(uep);
-	}
 
-	reply = *((uint8_t *)&reply);
-	if (reply) {
-		fprintf(stderr, "Error: status %#x\n", reply);
-		exit(update_error);
+		for (i = 0; i < actual; i++) {
+			if (reply[i]) {
+				fprintf(stderr, "Error: status %#x\n",
+					reply[i]);
+				exit(update_error);
+			}
+		}
+		blocks_in_flight -= actual;
 	}
 
 	return 0;
 }
 
-/**
- * Transfer an image section (typically RW or RO).
- *
- * td           - transfer descriptor to use to communicate with the target
- * data_ptr     - pointer at the section base in the image
- * section_addr - address of the section in the target memory space
- * data_len     - section size
- * smart_update - non-zero to enable the smart trailing of 0xff.
- */
-static void transfer_section(struct transfer_descriptor *td, uint8_t *data_ptr,
-			     uint32_t section_addr, size_t data_len,
-			     uint8_t smart_update)
+static int transfer_block(struct usb_endpoint *uep,
+			  struct update_frame_header *ufh,
+			  uint8_t *transfer_data_ptr, size_t payload_size)
 {
-	/*
-	 * Actually, we can skip trailing chunks of 0xff, as the entire
-	 * section space must be erased before the update is attempted.
-	 *
-	 * FIXME: We can be smarter than this and skip blocks within the image.
-	 */
-	if (smart_update)
-		while (data_len && (data_ptr[data_len - 1] == 0xff))
-			data_len--;
+	send_block(uep, ufh, transfer_data_ptr, payload_size);
 
-	printf("sending 0x%zx bytes to %#x\n", data_len, section_addr);
+	/* Now get the reply. */
+	return wait_for_blocks(uep, 0);
+}
+
+/*
+ * Send data_len bytes of the image as a sequence of blocks. With a window of
+ * one block each block is retried on timeout, otherwise up to window_size
+ * blocks are sent before waiting for the oldest confirmation, which hides the
+ * USB round trip and lets the target program a block while the next one is
+ * on the way.
+ */
+static void transfer_blocks(struct transfer_descriptor *td, uint8_t *data_ptr,
+			    uint32_t section_addr, size_t data_len)
+{
 	while (data_len) {
 		size_t payload_size;
 		uint32_t block_base;
@@ -590,10 +617,16 @@ static void transfer_section(struct transfer_descriptor *td, uint8_t *data_ptr,
 					 sizeof(struct update_frame_header));
 		ufh.cmd.block_base = block_base;
 		ufh.cmd.block_digest = 0;
-		for (max_retries = 10; max_retries; max_retries--)
-			if (!transfer_block(&td->uep, &ufh, data_ptr,
-					    payload_size))
-				break;
+		if (window_size > 1) {
+			send_block(&td->uep, &ufh, data_ptr, payload_size);
+			max_retries =
+				!wait_for_blocks(&td->uep, window_size - 1);
+		} else {
+			for (max_retries = 10; max_retries; max_retries--)
+				if (!transfer_block(&td->uep, &ufh, data_ptr,
+						    payload_size))
+					break;
+		}
 
 		if (!max_retries) {
 			fprintf(stderr, "Failed to transfer block, %zd to go\n",
@@ -606,6 +639,46 @@ static void transfer_section(struct transfer_descriptor *td, uint8_t *data_ptr,
 	}
 }
 
+/*
+ * Wait for the confirmations of all blocks still in flight.
+ */
+static void finish_blocks(struct transfer_descriptor *td)
+{
+	if (wait_for_blocks(&td->uep, 0)) {
+		fprintf(stderr, "Failed to confirm last blocks\n");
+		exit(update_error);
+	}
+}
+
+/**
+ * Transfer an image section (typically RW or RO).
+ *
+ * td           - transfer descriptor to use to communicate with the target
+ * data_ptr     - pointer at the section base in the image
+ * section_addr - address of the section in the target memory space
+ * data_len     - section size
+ * smart_update - non-zero to enable the smart trailing of 0xff.
+ */
+static void transfer_section(struct transfer_descriptor *td, uint8_t *data_ptr,
+			     uint32_t section_addr, size_t data_len,
+			     uint8_t smart_update)
+{
+	/*
+	 * Actually, we can skip trailing chunks of 0xff, as the entire
+	 * section space must be erased before the update is attempted.
+	 *
+	 * Sparse updates (see transfer_section_sparse) skip blocks within
+	 * the image instead.
+	 */
+	if (smart_update)
+		while (data_len && (data_ptr[data_len - 1] == 0xff))
+			data_len--;
+
+	printf("sending 0x%zx bytes to %#x\n", data_len, section_addr);
+	transfer_blocks(td, data_ptr, section_addr, data_len);
+	finish_blocks(td);
+}
+
 /*
  * Each RO or RW section of the new image can be in one of the following
  * states.
@@ -915,6 +988,90 @@ static void send_subcommand(struct transfer_descriptor *td, uint16_t subcommand,
 	printf("sent command %x, resp %x\n", subcommand, response[0]);
 }
 
+/*
+ * Ask the target to erase the update section lazily during the next session,
+ * so that flash banks already holding the right contents can be skipped. Old
+ * targets do not know the command and reply with a single error byte.
+ */
+static void request_sparse_update(struct transfer_descriptor *td)
+{
+	struct update_sparse_response resp;
+	size_t resp_size = sizeof(resp);
+
+	/* The request is only accepted while the target is idle. */
+	send_done(&td->uep);
+
+	memset(&resp, 0, sizeof(resp));
+	ext_cmd_over_usb(&td->uep, UPDATE_EXTRA_CMD_SPARSE_UPDATE, NULL, 0,
+			 &resp, &resp_size, 1);
+	if (!resp.status)
+		td->sparse_erase_size = be32toh(resp.erase_size);
+	if (td->sparse_erase_size)
+		printf("sparse update, erase size %#x\n",
+		       td->sparse_erase_size);
+}
+
+/*
+ * Transfer an image section in sparse mode: the erase banks whose contents on
+ * the target already match the image are skipped, the others are sent in full
+ * (trailing 0xff included) as the target only erases the banks it receives
+ * data for.
+ */
+static void transfer_section_sparse(struct transfer_descriptor *td,
+				    uint8_t *data_ptr, uint32_t section_addr,
+				    size_t data_len)
+{
+	uint32_t bank_size = td->sparse_erase_size;
+	size_t banks = (data_len + bank_size - 1) / bank_size;
+	size_t skipped = 0;
+	size_t offset;
+	uint8_t *needed;
+
+	needed = calloc(banks, 1);
+	if (!needed) {
+		fprintf(stderr, "%s: failed to allocate %zd bytes\n", __func__,
+			banks);
+		exit(update_error);
+	}
+
+	/*
+	 * Query all the hashes before sending any block, hash replies and
+	 * block confirmations share the same endpoint.
+	 */
+	for (offset = 0; offset < data_len; offset += bank_size) {
+		struct update_flash_hash_request req;
+		uint8_t resp[1 + SHA256_DIGEST_LENGTH];
+		uint8_t digest[SHA256_DIGEST_LENGTH];
+		size_t len = MIN(bank_size, data_len - offset);
+		size_t resp_size = sizeof(resp);
+
+		req.offset = htobe32(section_addr + offset);
+		req.size = htobe32(len);
+		memset(resp, 0, sizeof(resp));
+		ext_cmd_over_usb(&td->uep, UPDATE_EXTRA_CMD_GET_FLASH_HASH,
+				 &req, sizeof(req), resp, &resp_size, 1);
+		SHA256(data_ptr + offset, len, digest);
+
+		needed[offset / bank_size] =
+			resp[0] || memcmp(resp + 1, digest, sizeof(digest));
+	}
+
+	for (offset = 0; offset < data_len; offset += bank_size) {
+		size_t len = MIN(bank_size, data_len - offset);
+
+		if (needed[offset / bank_size])
+			transfer_blocks(td, data_ptr + offset,
+					section_addr + offset, len);
+		else
+			skipped += len;
+	}
+	finish_blocks(td);
+	free(needed);
+
+	printf("sent 0x%zx bytes to %#x, 0x%zx bytes already up to date\n",
+	       data_len - skipped, section_addr, skipped);
+}
+
 /* Returns number of successfully transmitted image sections. */
 static int transfer_image(struct transfer_descriptor *td, uint8_t *data,
 			  size_t data_len)
@@ -924,9 +1081,15 @@ static int transfer_image(struct transfer_descriptor *td, uint8_t *data,
 
 	for (i = 0; i < ARRAY_SIZE(sections); i++)
 		if (sections[i].ustatus == needed) {
-			transfer_section(td, data + sections[i].offset,
-					 sections[i].offset, sections[i].size,
-					 1);
+			if (td->sparse_erase_size)
+				transfer_section_sparse(
+					td, data + sections[i].offset,
+					sections[i].offset, sections[i].size);
+			else
+				transfer_section(td,
+						 data + sections[i].offset,
+						 sections[i].offset,
+						 sections[i].size, 1);
 			num_txed_sections++;
 		}
 
@@ -1062,6 +1225,7 @@ int main(int argc, char *argv[])
 	int show_fw_ver = 0;
 	int no_reset_request = 0;
 	int touchpad_update = 0;
+	int full_update = 0;
 	int extra_command = -1;
 	uint8_t extra_command_data[50];
 	int extra_command_data_len = 0;
@@ -1098,6 +1262,9 @@ int main(int argc, char *argv[])
 		case 'f':
 			show_fw_ver = 1;
 			break;
+		case 'F':
+			full_update = 1;
+			break;
 		case 'g':
 			extra_command = UPDATE_EXTRA_CMD_TOUCHPAD_DEBUG;
 			/* Maximum length. */
@@ -1146,6 +1313,13 @@ int main(int argc, char *argv[])
 		case 'w':
 			extra_command = UPDATE_EXTRA_CMD_UNLOCK_RW;
 			break;
+		case 'W':
+			window_size = atoi(optarg);
+			if (window_size < 1 || window_size > 64) {
+				printf("Invalid window size: \"%s\"\n", optarg);
+				errorcnt++;
+			}
+			break;
 		case 0: /* auto-handled option */
 			break;
 		case '?':
@@ -1191,6 +1365,9 @@ int main(int argc, char *argv[])
 
 	usb_findit(vid, pid, serialno, &td.uep);
 
+	if (data && !touchpad_update && !full_update)
+		request_sparse_update(&td);
+
 	setup_connection(&td);
 
 	if (show_fw_ver) {
@@ -12,6 +12,22 @@
 /* Disable hibernate: We never want to exit while fuzzing. */
 #undef CONFIG_HIBERNATE
 
+/*
+ * Run each TCPMv2 input in a single wake up of the PD task, fast forwarding
+ * the (fake) time instead of sleeping through the PD timers. Every input
+ * starts from the same state and time, which makes runs reproducible and lets
+ * each input drive the state machines past their timeouts. That costs some
+ * raw exec/s. Comment out to fuzz with the real PD task.
+ */
+#define FUZZ_IN_PROCESS
+
+/*
+ * (Fake) time at which every fuzz input starts. It sits just below the 32-bit
+ * wrap so that each input crosses the rollover of the low timer word, which
+ * code comparing 32-bit timestamps has to handle.
+ */
+#define FUZZ_START_TIME 0xFFFFFFF0
+
 #ifdef TEST_HOST_COMMAND_FUZZ
 #undef CONFIG_HOSTCMD_DEBUG_MODE
 
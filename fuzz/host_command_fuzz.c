@@ -136,6 +136,22 @@ static int hostcmd_fill(const uint8_t *data, size_t size)
 	return 0;
 }
 
+/*
+ * Start every request from the same state: same (fake) time, which also keeps
+ * the host command task out of its rate limiting recess, no host event left
+ * over from the previous request, and an empty response.
+ */
+static void hostcmd_reset(void)
+{
+	timestamp_t start = { .val = FUZZ_START_TIME };
+
+	force_time(start);
+#ifdef CONFIG_HOSTCMD_EVENTS
+	host_clear_events(~(host_event_t)0);
+#endif
+	memset(resp_buf, 0, sizeof(resp_buf));
+}
+
 static pthread_cond_t done_cond;
 static pthread_mutex_t lock;
 
@@ -146,6 +162,7 @@ void run_test(int argc, const char **argv)
 
 	while (1) {
 		task_wait_event_mask(TASK_EVENT_FUZZ, -1);
+		hostcmd_reset();
 		/* Send the host command (pkt prepared by main thread). */
 		host_packet_receive(&pkt);
 		task_wait_event_mask(TASK_EVENT_HOSTCMD_DONE, -1);
@@ -11,6 +11,7 @@
 #include "timer.h"
 #include "usb_pd.h"
 #include "usb_pd_tcpm.h"
+#include "usb_pd_timer.h"
 #include "util.h"
 
 #include <stdlib.h>
@@ -22,6 +23,21 @@
 
 #define PORT0 0
 
+void pd_task(void *u);
+
+#if defined(FUZZ_IN_PROCESS) && defined(CONFIG_USB_PD_TCPMV2)
+#define PD_FUZZ_IN_PROCESS
+
+/* Tell the PD task to run the input, and the test runner that it is done. */
+#define PD_EVENT_FUZZ TASK_EVENT_CUSTOM_BIT(PD_EVENT_FIRST_FREE_BIT)
+#define TASK_EVENT_FUZZ_DONE TASK_EVENT_CUSTOM_BIT(1)
+
+/* Entry points into common/usbc/usbc_task.c */
+void pd_task_init(int port);
+int pd_task_timeout(int port);
+bool pd_task_handle_events(int port, uint32_t evt);
+#endif
+
 static int mock_tcpm_init(int port)
 {
 	return EC_SUCCESS;
@@ -193,37 +209,137 @@ enum tcpc_cc_voltage_status next_cc1, next_cc2;
 #define MAX_MESSAGES 8
 static struct message messages[MAX_MESSAGES];
 
-void run_test(int argc, const char **argv)
+#ifdef PD_FUZZ_IN_PROCESS
+/*
+ * Start the port over, as the PD task does after PD_EVENT_TCPC_RESET, at the
+ * same time for every input. Called from the PD task.
+ */
+static void pd_fuzz_reset(int port)
 {
-	uint8_t port = PORT0;
-	int i;
+	timestamp_t start = { .val = FUZZ_START_TIME };
 
-	ccprints("Fuzzing task started");
-	wait_for_task_started();
+	force_time(start);
+	atomic_clear(task_get_event_bitmap(task_get_current()));
+	pending = 0;
 
-	while (1) {
-		task_wait_event_mask(TASK_EVENT_FUZZ, -1);
+	pd_timer_init(port);
+	pd_task_init(port);
+}
+
+/*
+ * Run the port state machines for duration_us, as pd_task() would, but fast
+ * forward the time to the next timeout whenever there is no event left to
+ * handle. Called from the PD task.
+ */
+static void pd_fuzz_run(int port, int duration_us)
+{
+	atomic_t *events = task_get_event_bitmap(task_get_current());
+	timestamp_t deadline = get_time();
 
-		memset(&mock_tcpc_state[port], 0,
-		       sizeof(mock_tcpc_state[port]));
+	deadline.val += duration_us;
 
-		task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_TCPC_RESET);
-		task_wait_event(250 * MSEC);
+	while (1) {
+		uint32_t evt = atomic_clear(events);
 
-		mock_tcpc_state[port].cc1 = next_cc1;
-		mock_tcpc_state[port].cc2 = next_cc2;
+		if (!evt) {
+			timestamp_t now = get_time();
+			int timeout = pd_task_timeout(port);
 
-		task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_CC);
-		task_wait_event(50 * MSEC);
+			if (timeout < 0 || now.val + timeout >= deadline.val) {
+				force_time(deadline);
+				return;
+			}
 
-		/* Fake RX messages, one by one. */
-		for (i = 0; i < MAX_MESSAGES && messages[i].cnt; i++) {
-			memcpy(&mock_tcpc_state[port].message, &messages[i],
-			       sizeof(messages[i]));
+			now.val += timeout;
+			force_time(now);
+			evt = TASK_EVENT_TIMER;
+		}
 
-			tcpm_enqueue_message(port);
-			task_wait_event(50 * MSEC);
+		if (!pd_task_handle_events(port, evt)) {
+			pd_timer_init(port);
+			pd_task_init(port);
 		}
+	}
+}
+#else
+static void pd_fuzz_reset(int port)
+{
+	task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_TCPC_RESET);
+}
+
+static void pd_fuzz_run(int port, int duration_us)
+{
+	task_wait_event(duration_us);
+}
+#endif /* PD_FUZZ_IN_PROCESS */
+
+static void pd_fuzz_input(int port)
+{
+	int i;
+
+	memset(&mock_tcpc_state[port], 0, sizeof(mock_tcpc_state[port]));
+
+	pd_fuzz_reset(port);
+	pd_fuzz_run(port, 250 * MSEC);
+
+	mock_tcpc_state[port].cc1 = next_cc1;
+	mock_tcpc_state[port].cc2 = next_cc2;
+
+	task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_CC);
+	pd_fuzz_run(port, 50 * MSEC);
+
+	/* Fake RX messages, one by one. */
+	for (i = 0; i < MAX_MESSAGES && messages[i].cnt; i++) {
+		memcpy(&mock_tcpc_state[port].message, &messages[i],
+		       sizeof(messages[i]));
+
+		tcpm_enqueue_message(port);
+		pd_fuzz_run(port, 50 * MSEC);
+	}
+}
+
+#ifdef PD_FUZZ_IN_PROCESS
+/*
+ * PD task of the TCPMv2 fuzzers (see usb_tcpm_v2_rev20_fuzz.tasklist). Each
+ * input is run from the PD task itself, in a single wake up.
+ */
+void pd_fuzz_task(void *u)
+{
+	int port = TASK_ID_TO_PD_PORT(task_get_current());
+
+	/* Only PORT0 is fuzzed, leave the other ports alone. */
+	if (port != PORT0)
+		return;
+
+	while (1) {
+		task_wait_event_mask(PD_EVENT_FUZZ, -1);
+		pd_fuzz_input(port);
+		task_set_event(TASK_ID_TEST_RUNNER, TASK_EVENT_FUZZ_DONE);
+	}
+}
+#else
+void pd_fuzz_task(void *u)
+{
+	pd_task(u);
+}
+#endif /* PD_FUZZ_IN_PROCESS */
+
+void run_test(int argc, const char **argv)
+{
+	uint8_t port = PORT0;
+
+	ccprints("Fuzzing task started");
+	wait_for_task_started();
+
+	while (1) {
+		task_wait_event_mask(TASK_EVENT_FUZZ, -1);
+
+#ifdef PD_FUZZ_IN_PROCESS
+		task_set_event(PD_PORT_TO_TASK_ID(port), PD_EVENT_FUZZ);
+		task_wait_event_mask(TASK_EVENT_FUZZ_DONE, -1);
+#else
+		pd_fuzz_input(port);
+#endif
 
 		pthread_mutex_lock(&lock);
 		pthread_cond_signal(&done_cond);
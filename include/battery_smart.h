@@ -203,6 +203,12 @@ int sb_read_mfgacc(int cmd, int block, uint8_t *data, int len);
 /* Read manufactures access data from the battery */
 int sb_read_mfgacc_block(int cmd, int block, uint8_t *data, int len);
 
+/**
+ * Drop the values battery_get_params() caches between calls, so that the
+ * next call reads everything from the gauge.
+ */
+void sb_flush_params_cache(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -666,6 +666,13 @@
  */
 #undef CONFIG_BATTERY_MEASURE_IMBALANCE
 
+/*
+ * Smart battery driver re-reads slow-changing values (full charge capacity)
+ * at most this often, unless the battery status shows a capacity event.
+ * Set to 0 to read them on every battery_get_params() call.
+ */
+#define CONFIG_BATTERY_SLOW_PARAMS_INTERVAL_SEC 60
+
 /*
  * Some boards needs to lower input voltage when battery is full and chipset
  * is in S5/G3. This should be defined to integer value in mV.
@@ -927,6 +934,14 @@
 /* Leave safe mode when battery pct meets or exceeds this value */
 #define CONFIG_CHARGE_MANAGER_BAT_PCT_SAFE_MODE_EXIT 2
 
+/*
+ * Delay (ms) between a supplier update and the resulting charge port
+ * selection. Further updates within the window are handled by the same
+ * refresh, which avoids re-selecting the port for every supplier reported
+ * during e.g. a dock attach.
+ */
+#define CONFIG_CHARGE_MANAGER_REFRESH_DELAY_MS 0
+
 /* The hardware has some input current ramping/back-off mechanism */
 #undef CONFIG_CHARGE_RAMP_HW
 
@@ -1662,6 +1677,7 @@
 #undef CONFIG_CMD_BATDEBUG
 #define CONFIG_CMD_BATTFAKE
 #undef CONFIG_CMD_BATT_MFG_ACCESS
+#undef CONFIG_CMD_BATT_PARAMS_STATS
 #undef CONFIG_CMD_BATTERY_CONFIG
 #undef CONFIG_CMD_BUTTON
 #define CONFIG_CMD_CBI
@@ -1707,6 +1723,7 @@
 #undef CONFIG_CMD_GT7288
 #define CONFIG_CMD_HASH
 #define CONFIG_CMD_HCDEBUG
+#undef CONFIG_CMD_HCSTATS
 #undef CONFIG_CMD_HOSTCMD
 #undef CONFIG_CMD_I2CWEDGE
 #undef CONFIG_CMD_I2C_PROTECT
@@ -1765,6 +1782,7 @@
 #undef CONFIG_CMD_TASKREADY
 #undef CONFIG_CMD_TCPC_DUMP
 #define CONFIG_CMD_TEMP_SENSOR
+#undef CONFIG_CMD_THERMALSTATS
 #define CONFIG_CMD_TIMERINFO
 #define CONFIG_CMD_TYPEC
 #undef CONFIG_CMD_USART_INFO
@@ -1948,12 +1966,30 @@
 /* Max length of a single line of input */
 #define CONFIG_CONSOLE_INPUT_LINE_SIZE 80
 
+/*
+ * Size of the per-task buffers cprints() formats its lines into, so each line
+ * is reserved and written to the UART in one piece instead of interleaving
+ * with output from other tasks and interrupts. Lines that do not fit are
+ * truncated. Costs (number of tasks + 1) times this much RAM.
+ */
+#undef CONFIG_CONSOLE_LINE_STAGING
+
 /* Amount of time to keep the console in use flag */
 #define CONFIG_CONSOLE_IN_USE_ON_BOOT_TIME (15 * SECOND)
 
 /* Enable verbose output to UART console and extra timestamp print precision. */
 #define CONFIG_CONSOLE_VERBOSE
 
+/*
+ * Tokenize cprints() format strings at build time. Messages are written to
+ * the console as a base64-encoded token and binary arguments, and are
+ * detokenized on the host with a database built from the ELF files (see
+ * util/merge_token_db.sh). Zephyr builds use CONFIG_PIGWEED_LOG_TOKENIZED_LIB
+ * instead. Formats must be string literals; those with %p suffixes or longer
+ * than 128 characters are printed untokenized.
+ */
+#undef CONFIG_CONSOLE_TOKENIZED
+
 /* Enable the console print command. This allows the host to print messages
  * directly in the EC console.
  */
@@ -2181,6 +2217,13 @@
 #undef CONFIG_FLASH_ERASE_SIZE
 /* Allow deferred (async) flash erase */
 #undef CONFIG_FLASH_DEFERRED_ERASE
+/*
+ * Support EC_CMD_FLASH_WRITE_STREAM: the host fills one RAM buffer while the
+ * EC programs the other from a deferred call. The two buffers are taken from
+ * shared memory for the duration of the stream.
+ */
+#undef CONFIG_FLASH_WRITE_STREAM
+#define CONFIG_FLASH_WRITE_STREAM_BUF_SIZE 1024
 /* Flash must be selected for write/erase operations to succeed. */
 #undef CONFIG_FLASH_SELECT_REQUIRED
 
@@ -2588,6 +2631,15 @@
  */
 #undef CONFIG_HOSTCMD_SECTION_SORTED
 
+/*
+ * Look up host commands below CONFIG_HOSTCMD_INDEX_SIZE through a direct index
+ * instead of searching the host command table. The index takes one byte of
+ * RAM per command number, and is only used while the table has at most 255
+ * commands.
+ */
+#undef CONFIG_HOSTCMD_INDEX
+#define CONFIG_HOSTCMD_INDEX_SIZE 0x0200
+
 /*
  * Host command parameters and response are 32-bit aligned.  This generates
  * much more efficient code on ARM.
@@ -3558,6 +3610,14 @@
  */
 #undef CONFIG_ONLINE_CALIB_SPOOF_MODE
 
+/*
+ * Number of samples, from all sensors, that online calibration queues before
+ * running them through the calibration algorithms. The queue is normally
+ * processed once per motion sense loop, when the FIFO is committed. Defaults
+ * to 16 if not set.
+ */
+#undef CONFIG_ONLINE_CALIB_BATCH_SIZE
+
 /*
  * Duration after which an entry in the temperature cache is considered stale.
  * Defaults to 5 minutes if not set.
@@ -3967,6 +4027,19 @@
 #undef CONFIG_RGBKBD_DEMO_FLOW
 #undef CONFIG_RGBKBD_DEMO_DOT
 
+/*
+ * Maximum number of frames per second the RGB keyboard pushes to its LED
+ * drivers. Changes made in between are coalesced into the next frame.
+ */
+#define CONFIG_RGBKBD_MAX_FPS 60
+
+/*
+ * Keep a back buffer the AP can upload whole frames into with
+ * EC_CMD_RGBKBD_FRAME, swapped in on a frame tick. Costs 3 bytes of RAM per
+ * LED of the largest matrix (768 bytes).
+ */
+#undef CONFIG_RGBKBD_BACK_BUFFER
+
 #ifndef CONFIG_ZEPHYR
 /* Support Real-Time Clock (RTC) */
 #undef CONFIG_RTC
@@ -4200,7 +4273,8 @@
  * two. */
 #undef CONFIG_SPI_NOR_MAX_WRITE_SIZE
 
-/* If defined will enable block (64KiB) erase operations. */
+/* If defined will enable block (64KiB) erase operations, and SFDP erase types
+ * larger than 4KiB even when the part doesn't report their erase time. */
 #undef CONFIG_SPI_NOR_BLOCK_ERASE
 
 /* If defined will read the sector/block to be erased first and only initiate
@@ -7199,12 +7273,21 @@
 #define CONFIG_CRC8
 #endif
 
+/* The flash write stream checks a CRC-32 of the data it received. */
+#if defined(CONFIG_FLASH_WRITE_STREAM) && !defined(CONFIG_ZEPHYR)
+#define CONFIG_SW_CRC
+#endif
+
 #if defined(CONFIG_ONLINE_CALIB) && !defined(CONFIG_FPU)
 #error "Online calibration requires CONFIG_FPU"
 #endif
 
 /* Set default values for accelerometer calibration if not defined. */
 #ifdef CONFIG_ONLINE_CALIB
+#ifndef CONFIG_ONLINE_CALIB_BATCH_SIZE
+#define CONFIG_ONLINE_CALIB_BATCH_SIZE 16
+#endif
+
 #ifndef CONFIG_ACCEL_CAL_MIN_TEMP
 #define CONFIG_ACCEL_CAL_MIN_TEMP 0.0f
 #endif
@@ -155,6 +155,16 @@ static inline bool console_channel_is_disabled(enum console_channel channel)
 }
 #endif
 
+/**
+ * Get the number of console writes on a channel that lost output because the
+ * output buffers were full.
+ *
+ * @param channel	Output channel
+ *
+ * @return number of writes that were dropped or truncated.
+ */
+uint32_t console_channel_drops(enum console_channel channel);
+
 #ifdef CONFIG_PIGWEED_LOG_TOKENIZED_LIB
 const char *get_timestamp_now(void);
 
@@ -234,6 +244,57 @@ __attribute__((__format__(__printf__, 2, 0))) int
 cvprints(enum console_channel channel, const char *format, va_list args);
 #endif /* CONFIG_PIGWEED_LOG_TOKENIZED_LIB */
 
+#if defined(CONFIG_CONSOLE_TOKENIZED) && !defined(__cplusplus)
+#include "tokenizer.h"
+
+/**
+ * Print a tokenized message with timestamp.
+ *
+ * The message is encoded as its token followed by the timestamp and the
+ * arguments, and written to the console as "$<base64>~". Use cprints(),
+ * which tokenizes the format string at build time, instead of calling this
+ * directly.
+ *
+ * @param channel	Output channel
+ * @param token		Token of the timestamped format string
+ * @param types		Argument type descriptor; see TOKENIZER_ARG_TYPES()
+ *
+ * @return non-zero if output was truncated.
+ */
+int cprints_tokenized(enum console_channel channel, uint32_t token,
+		      uint32_t types, ...);
+
+__attribute__((__format__(__printf__, 1, 2))) static inline void
+cprints_check_format(const char *format, ...)
+{
+}
+
+#define CPRINTS_TOKENIZED_FORMAT(format) "[%u.%06u " format "]\n"
+
+/*
+ * Arguments are encoded by their C type, so formats that print the object
+ * behind a pointer (%pH, ...) can't be tokenized; see TOKENIZER_UNSUPPORTED().
+ * Those are printed untokenized instead.
+ *
+ * The format must be a string literal, and the arguments must be integers,
+ * floating point values, pointers or strings. Call (cprints)() to print a
+ * format built at run time.
+ */
+#define cprints(channel, format, ...)                                         \
+	({                                                                    \
+		if (0)                                                        \
+			cprints_check_format(format, ##__VA_ARGS__);          \
+		TOKENIZER_UNSUPPORTED(format) ?                               \
+			(cprints)(channel, format, ##__VA_ARGS__) :           \
+			cprints_tokenized(                                    \
+				channel,                                      \
+				TOKENIZE_STRING(                              \
+					CPRINTS_TOKENIZED_FORMAT(format)),    \
+				TOKENIZER_ARG_TYPES(__VA_ARGS__),             \
+				##__VA_ARGS__);                               \
+	})
+#endif /* CONFIG_CONSOLE_TOKENIZED && !__cplusplus */
+
 /**
  * Flush the console output for all channels.
  */
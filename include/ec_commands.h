@@ -8148,6 +8148,117 @@ struct pdc_trace_msg_entry {
 	uint8_t pdc_data[0];
 } __ec_align1;
 
+/*
+ * Streaming flash write.
+ *
+ * The host opens a stream with FLASH_WRITE_STREAM_START, then pushes the
+ * data in order with FLASH_WRITE_STREAM_DATA. The EC copies each packet into
+ * one of two RAM buffers and programs a full buffer from a deferred call
+ * while the host keeps filling the other one.
+ *
+ * DATA returns EC_RES_BUSY without consuming the packet when both buffers
+ * are in use; the host should resend the same packet. FLASH_WRITE_STREAM_DONE
+ * flushes the last partial buffer and checks the CRC-32 of the whole
+ * stream. It returns EC_RES_BUSY until every buffer is programmed, so the
+ * host polls it like FLASH_ERASE_GET_RESULT. FLASH_WRITE_STREAM_ABORT drops
+ * the stream (EC_RES_BUSY while a buffer is still being programmed).
+ *
+ * Every subcommand returns struct ec_response_flash_write_stream.
+ */
+#define EC_CMD_FLASH_WRITE_STREAM 0x0145
+
+enum ec_flash_write_stream_cmd {
+	FLASH_WRITE_STREAM_START = 0,
+	FLASH_WRITE_STREAM_DATA = 1,
+	FLASH_WRITE_STREAM_DONE = 2,
+	FLASH_WRITE_STREAM_ABORT = 3,
+};
+
+/**
+ * struct ec_params_flash_write_stream - Streaming flash write parameters.
+ * @cmd: One of enum ec_flash_write_stream_cmd.
+ * @reserved: Set to 0.
+ * @offset: START: byte offset in flash. DATA: position of this packet in
+ *          the stream, which must match the number of bytes already sent.
+ * @size: START: total stream length. DATA: number of data bytes following.
+ * @crc32: DONE: CRC-32 (IEEE 802.3) of the whole stream.
+ * @data: DATA: data to write.
+ */
+struct ec_params_flash_write_stream {
+	uint8_t cmd;
+	uint8_t reserved[3];
+	uint32_t offset;
+	uint32_t size;
+	uint32_t crc32;
+	uint8_t data[FLEXIBLE_ARRAY_MEMBER_SIZE];
+} __ec_align4;
+
+/**
+ * struct ec_response_flash_write_stream - Streaming flash write state.
+ * @received: Bytes of the stream accepted by the EC.
+ * @written: Bytes of the stream programmed to flash.
+ * @buf_size: Size of each EC buffer; the maximum DATA packet size.
+ * @buf_free: Number of EC buffers ready to take data.
+ * @reserved: Always 0.
+ */
+struct ec_response_flash_write_stream {
+	uint32_t received;
+	uint32_t written;
+	uint16_t buf_size;
+	uint8_t buf_free;
+	uint8_t reserved;
+} __ec_align4;
+
+/*
+ * Write a run of LEDs into the RGB keyboard framebuffer.
+ *
+ * LEDs are addressed by matrix position, counted as x * vsize + y, so a whole
+ * frame is written with start = 0 and hsize * vsize colors, split across as
+ * many commands as needed, and a delta with only the run that changed. The EC
+ * sends only the changed LEDs to the LED drivers, at most
+ * CONFIG_RGBKBD_MAX_FPS times per second.
+ *
+ * With EC_RGBKBD_FRAME_BACK, colors go to a back buffer instead, which isn't
+ * shown until a command with EC_RGBKBD_FRAME_SWAP. The back buffer is then
+ * copied to the display on the next frame tick, so a frame is never shown
+ * half written. Until that tick, EC_RGBKBD_FRAME_BACK writes return
+ * EC_RES_BUSY and should be retried. The back buffer keeps the last frame
+ * swapped in, so the next frame can be sent as a delta. EC_RGBKBD_FRAME_SWAP
+ * returns EC_RES_INVALID_PARAM if the back buffer wasn't written since the
+ * last swap, or since it was cleared by a console color command. Requires
+ * CONFIG_RGBKBD_BACK_BUFFER; EC_RES_UNAVAILABLE otherwise.
+ */
+#define EC_CMD_RGBKBD_FRAME 0x0146
+
+/* Write to the back buffer instead of the displayed frame. */
+#define EC_RGBKBD_FRAME_BACK BIT(0)
+/* Show the back buffer on the next frame tick, after writing the colors. */
+#define EC_RGBKBD_FRAME_SWAP BIT(1)
+
+/**
+ * struct ec_params_rgbkbd_frame - RGB keyboard framebuffer update.
+ * @start: Matrix position of color[0].
+ * @length: Number of elements in @color.
+ * @flags: EC_RGBKBD_FRAME_* flags.
+ * @color: Colors of LEDs start through start + length - 1.
+ */
+struct ec_params_rgbkbd_frame {
+	uint16_t start;
+	uint8_t length;
+	uint8_t flags;
+	struct rgb_s color[FLEXIBLE_ARRAY_MEMBER_SIZE];
+} __ec_align1;
+
+/**
+ * struct ec_response_rgbkbd_frame - RGB keyboard matrix geometry.
+ * @hsize: Number of LED columns.
+ * @vsize: Number of LED rows.
+ */
+struct ec_response_rgbkbd_frame {
+	uint8_t hsize;
+	uint8_t vsize;
+} __ec_align1;
+
 /*****************************************************************************/
 /* The command range 0x200-0x2FF is reserved for Rotor. */
 
@@ -8757,6 +8868,56 @@ struct ec_response_get_boot_time {
 	uint16_t cnt;
 } __ec_align4;
 
+/*
+ * Get the AP power sequence timing profile of one power state or one power
+ * signal, or clear the profile. The profile accumulates over EC resets.
+ */
+#define EC_CMD_AP_PWRSEQ_PROFILE 0x0605
+
+/*
+ * Duration histogram buckets. Bucket 0 counts durations under 1 ms, bucket n
+ * counts durations from 2^(n-1) to 2^n - 1 ms and the last bucket counts
+ * everything longer.
+ */
+#define EC_AP_PWRSEQ_PROFILE_BUCKETS 12
+
+enum ec_ap_pwrseq_profile_cmd {
+	EC_AP_PWRSEQ_PROFILE_GET_STATE = 0,
+	EC_AP_PWRSEQ_PROFILE_GET_SIGNAL = 1,
+	EC_AP_PWRSEQ_PROFILE_CLEAR = 2,
+};
+
+struct ec_params_ap_pwrseq_profile {
+	uint8_t cmd; /* enum ec_ap_pwrseq_profile_cmd */
+	uint8_t index; /* State or signal number */
+} __ec_align1;
+
+struct ec_response_ap_pwrseq_profile {
+	/* EC boots the profile has been accumulated over */
+	uint32_t boots;
+	/* Number of states and signals that can be queried */
+	uint8_t num_states;
+	uint8_t num_signals;
+	/* State only: signal with the longest single wait in this state */
+	uint8_t slowest_signal;
+	uint8_t reserved;
+	/*
+	 * States count the time spent in the state, signals count the time
+	 * spent waiting for the signal to change.
+	 */
+	uint32_t count;
+	uint32_t total_ms;
+	uint32_t max_ms;
+	uint32_t last_ms;
+	/* State only: uptime at the last entry into this state */
+	uint32_t last_entry_ms;
+	/* State only: time spent waiting on power signals in this state */
+	uint32_t wait_ms;
+	/* State only: longest single signal wait in this state */
+	uint32_t slowest_wait_ms;
+	uint16_t histogram[EC_AP_PWRSEQ_PROFILE_BUCKETS];
+} __ec_align4;
+
 /*****************************************************************************/
 /*
  * Reserve a range of host commands for board-specific, experimental, or
@@ -293,6 +293,18 @@ __error("This function should only be called from Zephyr OS code")
 #endif
 	struct host_command *zephyr_find_host_command(int command);
 
+/**
+ * Get an entry of the host command table in Zephyr OS.
+ *
+ * @i			Position in the table
+ *
+ * Return: the command, or NULL if @i is past the end of the table.
+ */
+#ifndef CONFIG_ZEPHYR
+__error("This function should only be called from Zephyr OS code")
+#endif
+	struct host_command *zephyr_get_host_command(int i);
+
 #if defined(CONFIG_ZEPHYR)
 #include "zephyr_host_command.h"
 #elif defined(HAS_TASK_HOSTCMD)
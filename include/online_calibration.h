@@ -19,7 +19,8 @@ extern "C" {
 void online_calibration_init(void);
 
 /**
- * Process a new data measurement from a given sensor.
+ * Process a new data measurement from a given sensor, after any measurements
+ * already queued.
  *
  * @param data Pointer to the data that should be processed.
  * @param sensor Pointer to the sensor that generated the data.
@@ -30,6 +31,25 @@ int online_calibration_process_data(struct ec_response_motion_sensor_data *data,
 				    struct motion_sensor_t *sensor,
 				    uint32_t timestamp);
 
+/**
+ * Queue a new data measurement from a given sensor. Queued samples from all
+ * sensors are run through the calibration algorithms in the order they were
+ * queued, by online_calibration_commit(), or earlier if the queue fills up.
+ *
+ * @param data Pointer to the data that should be queued.
+ * @param sensor Pointer to the sensor that generated the data.
+ * @param timestamp The time associated with the sample
+ */
+void online_calibration_stage_data(struct ec_response_motion_sensor_data *data,
+				   struct motion_sensor_t *sensor,
+				   uint32_t timestamp);
+
+/**
+ * Process all the queued measurements, one pass per run of consecutive
+ * samples from the same sensor.
+ */
+void online_calibration_commit(void);
+
 /**
  * Check if new calibration values are available since the last read.
  *
@@ -81,6 +81,35 @@ extern "C" {
 __stdlib_compat int vfnprintf(int (*addchar)(void *context, int c),
 			      void *context, const char *format, va_list args);
 
+/* Output callbacks for vfnprintf_sink() */
+struct printf_sink {
+	/* Add one character; see vfnprintf(). */
+	int (*addchar)(void *context, int c);
+	/*
+	 * Add <len> characters at once. Should return 0 if all characters
+	 * were accepted or non-zero if any was dropped due to overflow, in
+	 * which case the characters that fit should still be added. If NULL,
+	 * addchar() is called for each character instead.
+	 */
+	int (*addspan)(void *context, const char *s, int len);
+};
+
+/**
+ * Print formatted output to a sink, like vfnprintf()
+ *
+ * Runs of literal characters in @format and each formatted string are passed
+ * to @sink->addspan() in one call, so sinks can copy them in bulk.
+ *
+ * @param sink		Output callbacks
+ * @param context	Context pointer to pass to the callbacks
+ * @param format	Format string (see above for acceptable formats)
+ * @param args		Parameters
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the output was truncated.
+ */
+__stdlib_compat int vfnprintf_sink(const struct printf_sink *sink,
+				   void *context, const char *format,
+				   va_list args);
+
 #ifdef TEST_BUILD
 /**
  * Converts @val to a string written in @buf. The value is converted from
@@ -62,6 +62,9 @@ struct rgbkbd {
 	enum rgbkbd_state state;
 	/* Buffer containing color info for each dot. */
 	struct rgb_s *buf;
+	/* LEDs [dirty_lo, dirty_hi) changed since the last flush. */
+	uint8_t dirty_lo;
+	uint8_t dirty_hi;
 };
 
 struct rgbkbd_drv {
@@ -119,6 +122,12 @@ union rgbkbd_coord_u8 {
 };
 
 #define RGBKBD_COORD(x, y) ((x) << 3 | (y))
+/*
+ * Largest matrix addressable by struct rgbkbd_coord (x: 5 bits, y: 3 bits).
+ * Boards check rgbkbd_hsize * rgbkbd_vsize against it, since the back buffer
+ * is sized by it.
+ */
+#define RGBKBD_MATRIX_MAX_SIZE (32 * 8)
 /* Delimiter for rgbkbd_map data */
 #define RGBKBD_DELM 0xff
 /* Non-existent entry indicator for rgbkbd_table */
@@ -8,6 +8,9 @@
 #ifndef __CROS_EC_SFDP_H
 #define __CROS_EC_SFDP_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 /**
  * Helper macros to declare and access SFDP defined bitfields at a JEDEC SFDP
  * defined double word (32b) granularity.
@@ -29,6 +29,13 @@ extern "C" {
  * Page Size     | N/A              | 1B or 64B | Uses instantiated default
  * ----------------------------------------------------------------------------
  * Erase Opcodes | 4KiB Erase with an opcode of 0x20 is always required.
+ *               --------------------------------------------------------------
+ *               | SFDP erase types larger than 4KiB are used when SFDP v1.5+
+ *               | reports their erase time, or with CONFIG_SPI_NOR_BLOCK_ERASE
+ *               | which also enables 64KiB Erase (0xD8) for all others.
+ *               | Chip Erase (0xC7) requires the SFDP v1.5+ chip erase time.
+ * ----------------------------------------------------------------------------
+ * Read Opcode   | Fast Read (0x0B) | 0x0B      | Read (0x03)
  * ----------------------------------------------------------------------------
  * 4B Addressing | 4B addressing mode must be supported if the part is larger
  *               | than 16MiB. 4B mode entry will be attempted through opcode
@@ -41,6 +48,30 @@ extern "C" {
  * spi_device_t's in the board.h file. */
 enum spi_device;
 
+/* Number of erase types reported by the SFDP Basic Flash Parameter Table. */
+#define SPI_NOR_ERASE_TYPES 4
+
+/* Largest SFDP erase type accepted, 16MiB, larger sizes are bogus. */
+#define SPI_NOR_MAX_ERASE_SIZE_EXP 24
+
+struct spi_nor_erase_type {
+	/* Erase opcode. */
+	uint8_t opcode;
+
+	/* Erase size as a power of two, 0 if the erase type is unused. */
+	uint8_t size_exp;
+
+	/* Maximum erase time in microseconds, 0 if not reported. */
+	uint32_t timeout_usec;
+};
+
+/* Multi-I/O fast read modes reported through SFDP, for information only as
+ * the SPI controller API only transfers on a single data line. */
+#define SPI_NOR_READ_MODE_1_1_2 BIT(0)
+#define SPI_NOR_READ_MODE_1_2_2 BIT(1)
+#define SPI_NOR_READ_MODE_1_1_4 BIT(2)
+#define SPI_NOR_READ_MODE_1_4_4 BIT(3)
+
 struct spi_nor_device_t {
 	/* Name of the Serial NOR Flash device. */
 	const char *name;
@@ -60,6 +91,22 @@ struct spi_nor_device_t {
 	uint32_t capacity;
 	size_t page_size;
 	int in_4b_addressing_mode;
+
+	/* The following fields are filled in by SFDP discovery and should be
+	 * left zero when instantiating the device. */
+
+	/* Use Fast Read (0x0B) instead of Read (0x03). */
+	int fast_read;
+
+	/* Bitmap of SPI_NOR_READ_MODE_* supported by the part. */
+	uint8_t read_modes;
+
+	/* Erase types sorted from the largest, unused entries last. */
+	struct spi_nor_erase_type erase_types[SPI_NOR_ERASE_TYPES];
+
+	/* Maximum chip erase time in microseconds, 0 if chip erase should not
+	 * be used. */
+	uint32_t chip_erase_timeout_usec;
 };
 
 extern struct spi_nor_device_t spi_nor_devices[];
@@ -84,8 +131,7 @@ extern const unsigned int spi_nor_devices_used;
 #define SPI_NOR_STATUS_REGISTER_WIP BIT(0) /* Write in progres */
 #define SPI_NOR_STATUS_REGISTER_WEL BIT(1) /* Write enabled latch */
 
-/* If needed in the future this driver can be extended to discover SFDP
- * advertised erase sizes and opcodes for SFDP v1.0+. */
+/* Erase opcodes used when the part has no SFDP advertised erase types. */
 #define SPI_NOR_DRIVER_SPECIFIED_OPCODE_4KIB_ERASE 0x20
 #define SPI_NOR_DRIVER_SPECIFIED_OPCODE_64KIB_ERASE 0xd8
 
@@ -152,7 +198,9 @@ int spi_nor_read(const struct spi_nor_device_t *spi_nor_device, uint32_t offset,
 		 size_t size, uint8_t *data);
 
 /**
- * Erase flash on the Serial Flash Device.
+ * Erase flash on the Serial Flash Device. Each step uses the largest erase
+ * type which is aligned and fits in the remaining range, or a chip erase if
+ * the whole part is erased.
  *
  * @param spi_nor_device The Serial NOR Flash device to use.
  * @param offset Flash offset to erase, must be aligned to the minimum physical
@@ -49,6 +49,11 @@ struct temp_sensor_t {
 #endif
 	/* Index among the same kind of sensors. */
 	int idx;
+	/*
+	 * How often thermal control reads the sensor, in seconds. 0 or 1 reads
+	 * it every second; slow sensors can be read less often.
+	 */
+	uint8_t poll_period_s;
 };
 
 #ifdef CONFIG_TEMP_SENSOR
@@ -0,0 +1,307 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * Build-time string tokenizer for the console.
+ *
+ * Format strings are replaced by a 32-bit token derived from the string with
+ * pw_tokenizer's 65599 hash, and the strings themselves are recorded in the
+ * .pw_tokenizer.entries ELF section, which the linker scripts keep out of the
+ * image. Token databases are generated from the ELF files with pw_tokenizer's
+ * database.py; see util/merge_token_db.sh.
+ */
+
+#ifndef __CROS_EC_TOKENIZER_H
+#define __CROS_EC_TOKENIZER_H
+
+#include "common.h"
+
+#include <stdint.h>
+
+/* Magic number at the start of every entry in .pw_tokenizer.entries */
+#define TOKENIZER_ENTRY_MAGIC 0xBAA98DEE
+
+/* Entry header, as read by pw_tokenizer's database tooling */
+struct tokenizer_entry_header {
+	uint32_t magic;
+	uint32_t token;
+	/* Lengths include the terminating null */
+	uint32_t domain_length;
+	uint32_t string_length;
+} __packed;
+
+/* Number of characters of a string that contribute to its token */
+#define TOKENIZER_HASH_LENGTH 128
+
+#define _TOKENIZER_CHAR(str, i) \
+	((uint32_t)(uint8_t)((i) < sizeof(str) ? (str)[i] : 0))
+
+/**
+ * Compute the token of a string literal.
+ *
+ * This is pw_tokenizer's 65599 hash over the first TOKENIZER_HASH_LENGTH
+ * characters, unrolled so that the compiler folds it to a constant.
+ */
+#define TOKENIZER_HASH(str) \
+	((uint32_t)(sizeof(str "") - 1) + \
+	 0x0001003fu * _TOKENIZER_CHAR(str, 0u) + \
+	 0x007e0f81u * _TOKENIZER_CHAR(str, 1u) + \
+	 0x2e86d0bfu * _TOKENIZER_CHAR(str, 2u) + \
+	 0x43ec5f01u * _TOKENIZER_CHAR(str, 3u) + \
+	 0x162c613fu * _TOKENIZER_CHAR(str, 4u) + \
+	 0xd62aee81u * _TOKENIZER_CHAR(str, 5u) + \
+	 0xa311b1bfu * _TOKENIZER_CHAR(str, 6u) + \
+	 0xd319be01u * _TOKENIZER_CHAR(str, 7u) + \
+	 0xb156c23fu * _TOKENIZER_CHAR(str, 8u) + \
+	 0x6698cd81u * _TOKENIZER_CHAR(str, 9u) + \
+	 0x0d1b92bfu * _TOKENIZER_CHAR(str, 10u) + \
+	 0xcc881d01u * _TOKENIZER_CHAR(str, 11u) + \
+	 0x7280233fu * _TOKENIZER_CHAR(str, 12u) + \
+	 0x50c7ac81u * _TOKENIZER_CHAR(str, 13u) + \
+	 0x8da473bfu * _TOKENIZER_CHAR(str, 14u) + \
+	 0x4f377c01u * _TOKENIZER_CHAR(str, 15u) + \
+	 0xfaa8843fu * _TOKENIZER_CHAR(str, 16u) + \
+	 0x33b78b81u * _TOKENIZER_CHAR(str, 17u) + \
+	 0x45ac54bfu * _TOKENIZER_CHAR(str, 18u) + \
+	 0x7a27db01u * _TOKENIZER_CHAR(str, 19u) + \
+	 0xeacfe53fu * _TOKENIZER_CHAR(str, 20u) + \
+	 0xae686a81u * _TOKENIZER_CHAR(str, 21u) + \
+	 0x563335bfu * _TOKENIZER_CHAR(str, 22u) + \
+	 0x6c593a01u * _TOKENIZER_CHAR(str, 23u) + \
+	 0xe3f6463fu * _TOKENIZER_CHAR(str, 24u) + \
+	 0x5fda4981u * _TOKENIZER_CHAR(str, 25u) + \
+	 0xe03916bfu * _TOKENIZER_CHAR(str, 26u) + \
+	 0x44cb9901u * _TOKENIZER_CHAR(str, 27u) + \
+	 0x871ba73fu * _TOKENIZER_CHAR(str, 28u) + \
+	 0xe70d2881u * _TOKENIZER_CHAR(str, 29u) + \
+	 0x04bdf7bfu * _TOKENIZER_CHAR(str, 30u) + \
+	 0x227ef801u * _TOKENIZER_CHAR(str, 31u) + \
+	 0x7540083fu * _TOKENIZER_CHAR(str, 32u) + \
+	 0xe3010781u * _TOKENIZER_CHAR(str, 33u) + \
+	 0xe4c1d8bfu * _TOKENIZER_CHAR(str, 34u) + \
+	 0x24735701u * _TOKENIZER_CHAR(str, 35u) + \
+	 0x4f63693fu * _TOKENIZER_CHAR(str, 36u) + \
+	 0xf2b5e681u * _TOKENIZER_CHAR(str, 37u) + \
+	 0xa144b9bfu * _TOKENIZER_CHAR(str, 38u) + \
+	 0x69a8b601u * _TOKENIZER_CHAR(str, 39u) + \
+	 0xb685ca3fu * _TOKENIZER_CHAR(str, 40u) + \
+	 0xb52bc581u * _TOKENIZER_CHAR(str, 41u) + \
+	 0x5b469abfu * _TOKENIZER_CHAR(str, 42u) + \
+	 0x111f1501u * _TOKENIZER_CHAR(str, 43u) + \
+	 0x4ba72b3fu * _TOKENIZER_CHAR(str, 44u) + \
+	 0xc962a481u * _TOKENIZER_CHAR(str, 45u) + \
+	 0x33c77bbfu * _TOKENIZER_CHAR(str, 46u) + \
+	 0x39d67401u * _TOKENIZER_CHAR(str, 47u) + \
+	 0xafc78c3fu * _TOKENIZER_CHAR(str, 48u) + \
+	 0xce5a8381u * _TOKENIZER_CHAR(str, 49u) + \
+	 0x4bc75cbfu * _TOKENIZER_CHAR(str, 50u) + \
+	 0x02ced301u * _TOKENIZER_CHAR(str, 51u) + \
+	 0x83e6ed3fu * _TOKENIZER_CHAR(str, 52u) + \
+	 0x63136281u * _TOKENIZER_CHAR(str, 53u) + \
+	 0xc4463dbfu * _TOKENIZER_CHAR(str, 54u) + \
+	 0x8b083201u * _TOKENIZER_CHAR(str, 55u) + \
+	 0x69054e3fu * _TOKENIZER_CHAR(str, 56u) + \
+	 0x268d4181u * _TOKENIZER_CHAR(str, 57u) + \
+	 0xbe441ebfu * _TOKENIZER_CHAR(str, 58u) + \
+	 0xf1829101u * _TOKENIZER_CHAR(str, 59u) + \
+	 0x0022af3fu * _TOKENIZER_CHAR(str, 60u) + \
+	 0xb7c82081u * _TOKENIZER_CHAR(str, 61u) + \
+	 0x5ac0ffbfu * _TOKENIZER_CHAR(str, 62u) + \
+	 0x553df001u * _TOKENIZER_CHAR(str, 63u) + \
+	 0xea3f103fu * _TOKENIZER_CHAR(str, 64u) + \
+	 0xb5c3ff81u * _TOKENIZER_CHAR(str, 65u) + \
+	 0xbabce0bfu * _TOKENIZER_CHAR(str, 66u) + \
+	 0xd53a4f01u * _TOKENIZER_CHAR(str, 67u) + \
+	 0xc85a713fu * _TOKENIZER_CHAR(str, 68u) + \
+	 0xbf80de81u * _TOKENIZER_CHAR(str, 69u) + \
+	 0xff37c1bfu * _TOKENIZER_CHAR(str, 70u) + \
+	 0x9077ae01u * _TOKENIZER_CHAR(str, 71u) + \
+	 0x3b74d23fu * _TOKENIZER_CHAR(str, 72u) + \
+	 0x73febd81u * _TOKENIZER_CHAR(str, 73u) + \
+	 0x4931a2bfu * _TOKENIZER_CHAR(str, 74u) + \
+	 0xa5f60d01u * _TOKENIZER_CHAR(str, 75u) + \
+	 0xe48e333fu * _TOKENIZER_CHAR(str, 76u) + \
+	 0x723d9c81u * _TOKENIZER_CHAR(str, 77u) + \
+	 0xb9aa83bfu * _TOKENIZER_CHAR(str, 78u) + \
+	 0x34b56c01u * _TOKENIZER_CHAR(str, 79u) + \
+	 0x64a6943fu * _TOKENIZER_CHAR(str, 80u) + \
+	 0x593d7b81u * _TOKENIZER_CHAR(str, 81u) + \
+	 0x71a264bfu * _TOKENIZER_CHAR(str, 82u) + \
+	 0x5bb5cb01u * _TOKENIZER_CHAR(str, 83u) + \
+	 0x5cbdf53fu * _TOKENIZER_CHAR(str, 84u) + \
+	 0xc7fe5a81u * _TOKENIZER_CHAR(str, 85u) + \
+	 0x921945bfu * _TOKENIZER_CHAR(str, 86u) + \
+	 0x39f72a01u * _TOKENIZER_CHAR(str, 87u) + \
+	 0x6dd4563fu * _TOKENIZER_CHAR(str, 88u) + \
+	 0x5d803981u * _TOKENIZER_CHAR(str, 89u) + \
+	 0x3c0f26bfu * _TOKENIZER_CHAR(str, 90u) + \
+	 0xee798901u * _TOKENIZER_CHAR(str, 91u) + \
+	 0x38e9b73fu * _TOKENIZER_CHAR(str, 92u) + \
+	 0xb8c31881u * _TOKENIZER_CHAR(str, 93u) + \
+	 0x908407bfu * _TOKENIZER_CHAR(str, 94u) + \
+	 0x983ce801u * _TOKENIZER_CHAR(str, 95u) + \
+	 0x5efe183fu * _TOKENIZER_CHAR(str, 96u) + \
+	 0x78c6f781u * _TOKENIZER_CHAR(str, 97u) + \
+	 0xb077e8bfu * _TOKENIZER_CHAR(str, 98u) + \
+	 0x56414701u * _TOKENIZER_CHAR(str, 99u) + \
+	 0x8111793fu * _TOKENIZER_CHAR(str, 100u) + \
+	 0x3c8bd681u * _TOKENIZER_CHAR(str, 101u) + \
+	 0xbceac9bfu * _TOKENIZER_CHAR(str, 102u) + \
+	 0x4786a601u * _TOKENIZER_CHAR(str, 103u) + \
+	 0x4023da3fu * _TOKENIZER_CHAR(str, 104u) + \
+	 0xa311b581u * _TOKENIZER_CHAR(str, 105u) + \
+	 0xd6dcaabfu * _TOKENIZER_CHAR(str, 106u) + \
+	 0x8b0d0501u * _TOKENIZER_CHAR(str, 107u) + \
+	 0x3d353b3fu * _TOKENIZER_CHAR(str, 108u) + \
+	 0x4b589481u * _TOKENIZER_CHAR(str, 109u) + \
+	 0x1f4d8bbfu * _TOKENIZER_CHAR(str, 110u) + \
+	 0x3fd46401u * _TOKENIZER_CHAR(str, 111u) + \
+	 0x19459c3fu * _TOKENIZER_CHAR(str, 112u) + \
+	 0xd4607381u * _TOKENIZER_CHAR(str, 113u) + \
+	 0xb73d6cbfu * _TOKENIZER_CHAR(str, 114u) + \
+	 0x84dcc301u * _TOKENIZER_CHAR(str, 115u) + \
+	 0x7554fd3fu * _TOKENIZER_CHAR(str, 116u) + \
+	 0xdd295281u * _TOKENIZER_CHAR(str, 117u) + \
+	 0xbfac4dbfu * _TOKENIZER_CHAR(str, 118u) + \
+	 0x79262201u * _TOKENIZER_CHAR(str, 119u) + \
+	 0xf2635e3fu * _TOKENIZER_CHAR(str, 120u) + \
+	 0x04b33181u * _TOKENIZER_CHAR(str, 121u) + \
+	 0x599a2ebfu * _TOKENIZER_CHAR(str, 122u) + \
+	 0x3bb08101u * _TOKENIZER_CHAR(str, 123u) + \
+	 0x3170bf3fu * _TOKENIZER_CHAR(str, 124u) + \
+	 0xe9fe1081u * _TOKENIZER_CHAR(str, 125u) + \
+	 0xa6070fbfu * _TOKENIZER_CHAR(str, 126u) + \
+	 0xeb7be001u * _TOKENIZER_CHAR(str, 127u))
+
+/**
+ * Record a string literal in the token database and evaluate to its token.
+ *
+ * The string does not end up in the image.
+ */
+#define TOKENIZE_STRING(str)                                              \
+	({                                                                \
+		static const struct {                                     \
+			struct tokenizer_entry_header header;             \
+			char domain[1];                                   \
+			char string[sizeof(str)];                         \
+		} __packed _tokenizer_entry __attribute__((               \
+			used, aligned(1),                                 \
+			section(".pw_tokenizer.entries." STRINGIFY(       \
+				__LINE__)))) = {                          \
+			{ TOKENIZER_ENTRY_MAGIC, TOKENIZER_HASH(str), 1,  \
+			  sizeof(str) },                                  \
+			"",                                               \
+			str,                                              \
+		};                                                        \
+		(void)_tokenizer_entry;                                   \
+		TOKENIZER_HASH(str);                                      \
+	})
+
+/* Whether str[i] starts a pointer format with a suffix, like "%pH" */
+#define _TOKENIZER_PTR_EXT_AT(str, i)                                   \
+	((i) + 2 < sizeof(str) && (str)[i] == '%' && (str)[(i) + 1] == 'p' && \
+	 (str)[(i) + 2] >= 'A' && (str)[(i) + 2] <= 'Z')
+
+#define _TOKENIZER_SCAN_4(str, i)                                       \
+	(_TOKENIZER_PTR_EXT_AT(str, i) || _TOKENIZER_PTR_EXT_AT(str, i + 1) || \
+	 _TOKENIZER_PTR_EXT_AT(str, i + 2) || _TOKENIZER_PTR_EXT_AT(str, i + 3))
+#define _TOKENIZER_SCAN_16(str, i)                              \
+	(_TOKENIZER_SCAN_4(str, i) || _TOKENIZER_SCAN_4(str, i + 4) || \
+	 _TOKENIZER_SCAN_4(str, i + 8) || _TOKENIZER_SCAN_4(str, i + 12))
+#define _TOKENIZER_SCAN_64(str, i)                                 \
+	(_TOKENIZER_SCAN_16(str, i) || _TOKENIZER_SCAN_16(str, i + 16) || \
+	 _TOKENIZER_SCAN_16(str, i + 32) || _TOKENIZER_SCAN_16(str, i + 48))
+
+/* Number of characters of a format string that TOKENIZER_UNSUPPORTED checks */
+#define TOKENIZER_SCAN_LENGTH 128
+
+/**
+ * Whether a format string literal can't be tokenized.
+ *
+ * Pointer formats with a suffix print the object behind the pointer, which
+ * the host can't do from the encoded pointer value. Formats too long to be
+ * checked are treated the same way. The compiler folds this to a constant.
+ */
+#define TOKENIZER_UNSUPPORTED(str)                      \
+	(sizeof(str) > TOKENIZER_SCAN_LENGTH ||         \
+	 _TOKENIZER_SCAN_64(str, 0) || _TOKENIZER_SCAN_64(str, 64))
+
+/* Types of tokenized arguments, as they are encoded in the message */
+enum tokenizer_arg_type {
+	/* Anything up to 32 bits, including pointers on 32-bit targets */
+	TOKENIZER_ARG_INT = 0,
+	TOKENIZER_ARG_INT64 = 1,
+	/* float or double, encoded as a 32-bit float */
+	TOKENIZER_ARG_DOUBLE = 2,
+	TOKENIZER_ARG_STRING = 3,
+};
+
+/*
+ * A type descriptor holds the argument count in its low 4 bits and the type
+ * of each argument in the following 2-bit fields.
+ */
+#define TOKENIZER_MAX_ARGS 14
+#define TOKENIZER_TYPE_COUNT(types) ((types)&0xf)
+#define TOKENIZER_TYPE(types, i) \
+	((enum tokenizer_arg_type)(((types) >> (4 + 2 * (i))) & 0x3))
+
+#define TOKENIZER_ARG_TYPE(arg)                                     \
+	_Generic((arg),                                             \
+		char *: TOKENIZER_ARG_STRING,                       \
+		const char *: TOKENIZER_ARG_STRING,                 \
+		float: TOKENIZER_ARG_DOUBLE,                        \
+		double: TOKENIZER_ARG_DOUBLE,                       \
+		default: (sizeof((arg) + 0) > sizeof(uint32_t) ?    \
+				  TOKENIZER_ARG_INT64 :             \
+				  TOKENIZER_ARG_INT))
+
+#define _TOKENIZER_NUM_ARGS(...)                                            \
+	_TOKENIZER_NUM_ARGS_N(_, ##__VA_ARGS__, 14, 13, 12, 11, 10, 9, 8, 7, \
+			      6, 5, 4, 3, 2, 1, 0)
+#define _TOKENIZER_NUM_ARGS_N(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, \
+			      _11, _12, _13, _14, N, ...)                  \
+	N
+
+#define _TOKENIZER_TYPES_0() 0
+#define _TOKENIZER_TYPES_1(a) ((uint32_t)TOKENIZER_ARG_TYPE(a))
+#define _TOKENIZER_TYPES_2(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_1(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_3(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_2(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_4(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_3(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_5(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_4(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_6(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_5(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_7(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_6(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_8(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_7(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_9(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_8(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_10(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_9(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_11(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_10(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_12(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_11(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_13(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_12(__VA_ARGS__) << 2)
+#define _TOKENIZER_TYPES_14(a, ...) \
+	(_TOKENIZER_TYPES_1(a) | _TOKENIZER_TYPES_13(__VA_ARGS__) << 2)
+
+/**
+ * Build the type descriptor for a list of arguments.
+ *
+ * The arguments are not evaluated.
+ */
+#define TOKENIZER_ARG_TYPES(...)                                      \
+	((uint32_t)_TOKENIZER_NUM_ARGS(__VA_ARGS__) |                 \
+	 (uint32_t)CONCAT2(_TOKENIZER_TYPES_,                         \
+			   _TOKENIZER_NUM_ARGS(__VA_ARGS__))(__VA_ARGS__) \
+		 << 4)
+
+#endif /* __CROS_EC_TOKENIZER_H */
@@ -105,6 +105,69 @@ int uart_vprintf(const char *format, va_list args);
  */
 int uart_tx_char_raw(void *context, int c);
 
+/**
+ * Put a run of characters into the transmit buffer.
+ *
+ * Like uart_tx_char_raw(), but copies as many characters as fit at once.
+ *
+ * @param context	Context; ignored.
+ * @param s		Characters to write.
+ * @param len		Number of characters to write.
+ * @return number of characters transmitted; the rest were dropped.
+ */
+int uart_tx_span_raw(void *context, const char *s, int len);
+
+/* A reserved run of characters in the transmit buffer */
+struct uart_tx_reservation {
+	int start;
+	int len;
+	uint32_t sum;
+};
+
+/**
+ * Reserve space for a run of characters in the transmit buffer.
+ *
+ * The reserved space must be filled completely with uart_tx_fill() and then
+ * handed to uart_tx_commit(). Other contexts may reserve and commit in the
+ * meantime; output becomes visible to the UART once every reservation made
+ * before it has been committed, so reserved runs never interleave.
+ *
+ * @param res		Reservation to set up.
+ * @param len		Number of characters to reserve.
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the buffer does not have room.
+ */
+int uart_tx_reserve(struct uart_tx_reservation *res, int len);
+
+/**
+ * Copy characters into part of a reservation.
+ *
+ * @param res		Reservation from uart_tx_reserve().
+ * @param offset	Offset of the characters in the reservation.
+ * @param s		Characters to copy.
+ * @param len		Number of characters to copy.
+ */
+void uart_tx_fill(struct uart_tx_reservation *res, int offset, const char *s,
+		  int len);
+
+/**
+ * Commit a filled reservation.
+ *
+ * @param res		Reservation from uart_tx_reserve().
+ */
+void uart_tx_commit(struct uart_tx_reservation *res);
+
+/**
+ * Put a line to the UART in one piece, translating '\n' to '\r\n'.
+ *
+ * Unlike uart_put(), the line is either written whole, without output from
+ * other contexts in the middle of it, or dropped.
+ *
+ * @param s		Characters to write.
+ * @param len		Number of characters to write.
+ * @return EC_SUCCESS, or EC_ERROR_OVERFLOW if the line was dropped.
+ */
+int uart_put_line(const char *s, int len);
+
 /**
  * Flush output.  Blocks until UART has transmitted all output.
  */
@@ -35,6 +35,18 @@ extern "C" {
  *
  * The connection establishment response is described by the
  * first_response_pdu structure below.
+ *
+ * The EC processes the USB chunks of a PDU in the order they arrive and
+ * queues the confirmation once the block is programmed, so a host may keep
+ * several PDUs in flight and collect the confirmations afterwards, as long as
+ * it does not have more than 64 of them outstanding (the size of the response
+ * queue).
+ *
+ * A host may also skip blocks which already hold the right contents: it
+ * requests sparse mode with UPDATE_EXTRA_CMD_SPARSE_UPDATE before establishing
+ * the connection, compares the hash of each flash erase bank
+ * (UPDATE_EXTRA_CMD_GET_FLASH_HASH) with its image and only sends the banks
+ * which differ. Every bank it does send must then be sent in full.
  */
 
 #define UPDATE_PROTOCOL_VERSION 6
@@ -174,8 +186,35 @@ enum update_extra_command {
 	UPDATE_EXTRA_CMD_CONSOLE_READ_INIT = 9,
 	UPDATE_EXTRA_CMD_CONSOLE_READ_NEXT = 10,
 	UPDATE_EXTRA_CMD_GET_VERSION_STRING = 11,
+	UPDATE_EXTRA_CMD_GET_FLASH_HASH = 12,
+	UPDATE_EXTRA_CMD_SPARSE_UPDATE = 13,
 };
 
+/*
+ * UPDATE_EXTRA_CMD_GET_FLASH_HASH parameters (big endian): the flash range
+ * to hash, using the same offsets as update_command.block_base. Only whole
+ * erase banks of the image that is not running can be hashed. The response
+ * is a status byte followed by the SHA256 digest of the range.
+ */
+struct update_flash_hash_request {
+	uint32_t offset;
+	uint32_t size;
+} __packed;
+
+/* Largest range UPDATE_EXTRA_CMD_GET_FLASH_HASH will hash in one go. */
+#define UPDATE_FLASH_HASH_MAX_SIZE 0x10000
+
+/*
+ * UPDATE_EXTRA_CMD_SPARSE_UPDATE response. Only accepted while no update is in
+ * progress, and applies to the next update session: the update section is
+ * then erased one bank at a time, right before the first block destined to
+ * that bank is written, so banks the host skips are preserved.
+ */
+struct update_sparse_response {
+	uint8_t status; /* = EC_RES_SUCCESS */
+	uint32_t erase_size; /* Erase bank size in bytes, big endian. */
+} __packed;
+
 /*
  * Pair challenge (from host), note that the packet, with header, must fit
  * in a single USB packet (64 bytes), so its maximum length is 50 bytes.
@@ -249,6 +288,33 @@ void fw_update_complete(void);
 /* Verify integrity of the PDU received. */
 int update_pdu_valid(struct update_command *cmd_body, size_t cmd_size);
 
+/**
+ * Compute the SHA256 digest of a range of flash.
+ *
+ * Only whole erase banks of the image that is not running can be hashed.
+ *
+ * @param offset	Flash offset of the range, erase bank aligned.
+ * @param size		Size of the range, a multiple of the erase bank size up
+ *			to UPDATE_FLASH_HASH_MAX_SIZE.
+ * @param digest	Filled with the SHA256_DIGEST_SIZE byte digest.
+ *
+ * @return EC_RES_SUCCESS, or UPDATE_GEN_ERROR if the range is not allowed,
+ *	   EC_RES_UNAVAILABLE if there is no SHA256 support or the flash
+ *	   banks are not uniform.
+ */
+int fw_update_flash_hash(uint32_t offset, uint32_t size, uint8_t *digest);
+
+/**
+ * Request sparse mode for the next update session, where the update section
+ * is erased lazily one bank at a time instead of all at once.
+ *
+ * @param erase_size	Filled with the erase bank size.
+ *
+ * @return EC_RES_SUCCESS, or EC_RES_UNAVAILABLE if the flash does not have
+ *	   uniform erase banks.
+ */
+int fw_update_request_sparse(uint32_t *erase_size);
+
 /* Various update command return values. */
 enum {
 	UPDATE_SUCCESS = 0,
@@ -94,12 +94,56 @@ extern "C" {
  *         0x0004: Read count invalid (e.g. larger than available buffer)
  *         0x0005: The port specified is invalid.
  *         0x0006: The I2C interface is disabled.
+ *         0x0007: No handler registered for USB_I2C_CMD_ADDR_FLAGS.
+ *         0x0008: Unsupported command.
+ *         0x0009: Malformed batch (see below).
  *         0x8000: Unknown error mask
  *             The bottom 15 bits will contain the bottom 15 bits from the EC
  *             error code.
  *
  *     read payload: Depends on the buffer size and implementation. Length will
  *             match requested read count
+ *
+ * Batched transactions:
+ *
+ *   Sending the header with addr = USB_I2C_MULTI_ADDR_FLAGS packs several I2C
+ *   transactions into one request. wc is the length of the whole op list and
+ *   rc the sum of all op read counts; the header port is ignored. Each op is:
+ *
+ *   +------+------+----+----+---------------+
+ *   | port | addr | wc | rc | write payload |
+ *   +------+------+----+----+---------------+
+ *   |  1B  |  1B  | 1B | 1B |  wc bytes     |
+ *   +------+------+----+----+---------------+
+ *
+ *   - port: i2c interface index, the top 4 bits are reserved and must be 0.
+ *   - addr, wc, rc: as for a single transaction, limited to 255 bytes each.
+ *     An op with wc = rc = 0 is skipped.
+ *
+ *   Ops run in order and stop at the first failure. The ops and their read
+ *   results must fit in the bridge buffer together, i.e. wc + rc of the
+ *   request may not exceed USB_I2C_BUFFER_SIZE - 4.
+ *
+ *   Response:
+ *     +-------------+------+---+--------------+
+ *     | status : 2B | done | 0 | read payload |
+ *     +-------------+------+---+--------------+
+ *
+ *     status: status of the first failed op, or 0x0000 if all succeeded.
+ *     done: number of ops that completed.
+ *     read payload: read data of the completed ops, concatenated and padded
+ *             to the requested rc.
+ *
+ *   Firmware without batch support handles the request as a transfer to the
+ *   reserved I2C address 0x79 and returns an error status, so hosts can probe
+ *   for support with a batch holding a single empty op.
+ *
+ * Pipelining:
+ *
+ *   The host may send the next request before it has collected the previous
+ *   response, as long as it fits in the bridge's receive queue. Requests are
+ *   executed in order, each one once its response fits in the transmit
+ *   queue.
  */
 
 enum usb_i2c_error {
@@ -112,6 +156,7 @@ enum usb_i2c_error {
 	USB_I2C_DISABLED = 0x0006,
 	USB_I2C_MISSING_HANDLER = 0x0007,
 	USB_I2C_UNSUPPORTED_COMMAND = 0x0008,
+	USB_I2C_BATCH_INVALID = 0x0009,
 	USB_I2C_UNKNOWN_ERROR = 0x8000,
 };
 
@@ -142,9 +187,13 @@ struct usb_i2c_config {
 
 	struct consumer const consumer;
 	struct queue const *tx_queue;
+
+	/* Producer of tx_queue, told when the host collects a response. */
+	struct producer const producer;
 };
 
 extern struct consumer_ops const usb_i2c_consumer_ops;
+extern struct producer_ops const usb_i2c_producer_ops;
 
 #ifdef CONFIG_ZEPHYR
 #define DECLARE_I2C_DEFERRED(NAME)          \
@@ -189,9 +238,13 @@ extern struct consumer_ops const usb_i2c_consumer_ops;
 			.ops   = &usb_i2c_consumer_ops,			\
 		},							\
 		.tx_queue = &CONCAT2(NAME, _to_usb_),			\
+		.producer  = {						\
+			.queue = &CONCAT2(NAME, _to_usb_),		\
+			.ops   = &usb_i2c_producer_ops,			\
+		},							\
 	};                              \
 	static struct queue const CONCAT2(NAME, _to_usb_) =                    \
-		QUEUE_DIRECT(USB_I2C_READ_BUFFER, uint8_t, null_producer,      \
+		QUEUE_DIRECT(USB_I2C_READ_BUFFER, uint8_t, NAME.producer,      \
 			     CONCAT2(NAME, _usb_).consumer);                   \
 	static struct queue const CONCAT3(usb_to_, NAME, _) =                  \
 		QUEUE_DIRECT(USB_I2C_WRITE_BUFFER, uint8_t,                    \
@@ -225,6 +278,12 @@ int usb_i2c_board_is_enabled(void);
  */
 #define USB_I2C_CMD_ADDR_FLAGS 0x78
 
+/*
+ * Special i2c address used to send a batch of transactions in one request,
+ * see "Batched transactions" above.
+ */
+#define USB_I2C_MULTI_ADDR_FLAGS 0x79
+
 /*
  * Function to call to register a handler for commands sent to the special i2c
  * address above.
@@ -39,6 +39,7 @@ static void reset_and_fail_on(int first, int last, int cmd)
 {
 	/* We're not initializing the fake battery, so everything reads zero */
 	memset(&batt, 0, sizeof(typeof(batt)));
+	sb_flush_params_cache();
 	cmd_to_fail = cmd;
 	reset_counters(first, last);
 }
@@ -241,6 +242,46 @@ static int test_current(void)
 	return EC_SUCCESS;
 }
 
+static int test_slow_params(void)
+{
+	int all_reads;
+
+	sb_write(SB_FULL_CHARGE_CAPACITY, 5000);
+	sb_write(SB_BATTERY_STATUS, 0);
+	reset_and_fail_on(0, 0, -1);
+	battery_get_params(&batt);
+	TEST_ASSERT(batt.full_capacity == 5000);
+	all_reads = read_count;
+
+	/* Full charge capacity comes from the cache on the next pass. */
+	sb_write(SB_FULL_CHARGE_CAPACITY, 4900);
+	reset_counters(0, 0);
+	battery_get_params(&batt);
+	TEST_ASSERT(read_count == all_reads - 1);
+	TEST_ASSERT(batt.full_capacity == 5000);
+	TEST_ASSERT(!(batt.flags & BATT_FLAG_BAD_FULL_CAPACITY));
+
+	/* A capacity event in the status forces a refresh. */
+	sb_write(SB_BATTERY_STATUS, STATUS_FULLY_CHARGED);
+	reset_counters(0, 0);
+	battery_get_params(&batt);
+	TEST_ASSERT(read_count == all_reads);
+	TEST_ASSERT(batt.full_capacity == 4900);
+
+	/* A failed read is retried on the next pass. */
+	cmd_to_fail = SB_FULL_CHARGE_CAPACITY;
+	sb_flush_params_cache();
+	battery_get_params(&batt);
+	TEST_ASSERT(batt.flags & BATT_FLAG_BAD_FULL_CAPACITY);
+	cmd_to_fail = -1;
+	battery_get_params(&batt);
+	TEST_ASSERT(!(batt.flags & BATT_FLAG_BAD_FULL_CAPACITY));
+
+	sb_write(SB_BATTERY_STATUS, 0);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	RUN_TEST(test_param_failures);
@@ -248,6 +289,7 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_full_state_of_charge);
 	RUN_TEST(test_voltage);
 	RUN_TEST(test_current);
+	RUN_TEST(test_slow_params);
 
 	test_print_result();
 }
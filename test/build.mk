@@ -36,6 +36,7 @@ test-list-host += charge_ramp
 test-list-host += chipset
 test-list-host += compile_time_macros
 test-list-host += console_edit
+test-list-host += console_tokenized
 test-list-host += crc
 test-list-host += debug_unimplemented
 test-list-host += entropy
@@ -107,6 +108,7 @@ test-list-host += scoped_fast_cpu
 test-list-host += sha256
 test-list-host += sha256_unrolled
 test-list-host += shmalloc
+test-list-host += spi_nor
 test-list-host += static_if
 test-list-host += static_if_error
 # TODO(b/237823627): When building for the host, we're linking against the
@@ -123,6 +125,7 @@ test-list-host += timer_dos
 test-list-host += uart
 test-list-host += uptime
 test-list-host += usb_common
+test-list-host += usb_i2c
 test-list-host += usb_pd_int
 test-list-host += usb_pd
 test-list-host += usb_pd_console
@@ -208,6 +211,7 @@ charge_ramp-y+=charge_ramp.o
 chipset-y+=chipset.o
 compile_time_macros-y=compile_time_macros.o
 console_edit-y=console_edit.o
+console_tokenized-y=console_tokenized.o
 cortexm_fpu-y=cortexm_fpu.o
 crc-y=crc.o
 debug-y=debug.o
@@ -298,6 +302,7 @@ scoped_fast_cpu-y=scoped_fast_cpu.o
 sha256-y=sha256.o
 sha256_unrolled-y=sha256.o
 shmalloc-y=shmalloc.o
+spi_nor-y=spi_nor.o
 static_if-y=static_if.o
 stdlib-y=stdlib.o
 std_vector-y=std_vector.o
@@ -316,6 +321,7 @@ unaligned_access-y=unaligned_access.o
 unaligned_access_benchmark-y=unaligned_access_benchmark.o
 uptime-y=uptime.o
 usb_common-y=usb_common_test.o fake_battery.o
+usb_i2c-y=usb_i2c.o
 usb_pd_int-y=usb_pd_int.o
 usb_pd-y=usb_pd.o
 usb_pd_console-y=usb_pd_console.o
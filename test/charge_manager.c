@@ -37,6 +37,8 @@ const int supplier_priority[] = {
 BUILD_ASSERT((int)CHARGE_SUPPLIER_COUNT == (int)CHARGE_SUPPLIER_TEST_COUNT);
 BUILD_ASSERT(ARRAY_SIZE(supplier_priority) == CHARGE_SUPPLIER_COUNT);
 
+extern int charge_manager_refresh_count;
+
 static unsigned int active_charge_limit = CHARGE_SUPPLIER_NONE;
 static unsigned int active_charge_port = CHARGE_PORT_NONE;
 static unsigned int charge_port_to_reject = CHARGE_PORT_NONE;
@@ -792,6 +794,101 @@ static int test_unknown_dualrole_capability(void)
 	return EC_SUCCESS;
 }
 
+/*
+ * Reference port selection: full supplier-major scan of the charge table, as
+ * charge_manager_get_best_port() did before keeping a per-port best supplier.
+ * Only dedicated ports without override are considered.
+ */
+static void
+reference_best_port(struct charge_port_info table[][CHARGE_PORT_COUNT],
+		    int active, int *best_port, int *best_supplier)
+{
+	int supplier = CHARGE_SUPPLIER_NONE;
+	int port = CHARGE_PORT_NONE;
+	int best_power = -1, power;
+	int i, j;
+
+	for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
+		for (j = 0; j < board_get_usb_pd_port_count(); ++j) {
+			if (table[i][j].current == 0 ||
+			    table[i][j].voltage == 0)
+				continue;
+			power = table[i][j].current * table[i][j].voltage;
+			if (supplier == CHARGE_SUPPLIER_NONE ||
+			    supplier_priority[i] <
+				    supplier_priority[supplier] ||
+			    (supplier_priority[i] ==
+				     supplier_priority[supplier] &&
+			     (power > best_power ||
+			      (power == best_power && active == j)))) {
+				supplier = i;
+				port = j;
+				best_power = power;
+			}
+		}
+	}
+
+	*best_port = port;
+	*best_supplier = supplier;
+}
+
+#define UPDATE_BURSTS 200
+
+static int test_update_burst(void)
+{
+	static const int currents[] = { 0, 500, 1500, 3000 };
+	static const int voltages[] = { 5000, 9000, 15000 };
+	struct charge_port_info table[CHARGE_SUPPLIER_COUNT][CHARGE_PORT_COUNT];
+	int expected_port, expected_supplier;
+	int refreshes, updates = 0;
+	timestamp_t start;
+	uint32_t elapsed = 0;
+	uint32_t r = 0;
+	int iter, i, j;
+
+	initialize_charge_table(0, 5000, CHARGE_CEIL_NONE);
+	memset(table, 0, sizeof(table));
+	refreshes = charge_manager_refresh_count;
+
+	for (iter = 0; iter < UPDATE_BURSTS; ++iter) {
+		int active = active_charge_port;
+
+		/* Report every supplier on every port in one burst. */
+		start = get_time();
+		for (i = 0; i < CHARGE_SUPPLIER_COUNT; ++i) {
+			for (j = 0; j < board_get_usb_pd_port_count(); ++j) {
+				r = prng(r);
+				table[i][j].current =
+					currents[r % ARRAY_SIZE(currents)];
+				r = prng(r);
+				table[i][j].voltage =
+					voltages[r % ARRAY_SIZE(voltages)];
+				charge_manager_update_charge(i, j,
+							     &table[i][j]);
+				updates++;
+			}
+		}
+		elapsed += time_since32(start);
+		crec_msleep(1);
+
+		reference_best_port(table, active, &expected_port,
+				    &expected_supplier);
+		TEST_EQ(active_charge_port, (unsigned int)expected_port, "%d");
+		if (expected_supplier != CHARGE_SUPPLIER_NONE) {
+			i = table[expected_supplier][expected_port].current;
+			TEST_EQ(active_charge_limit, (unsigned int)i, "%d");
+		}
+	}
+
+	/* Each burst must have been folded into a single refresh. */
+	refreshes = charge_manager_refresh_count - refreshes;
+	TEST_EQ(refreshes, UPDATE_BURSTS, "%d");
+	ccprintf("%d updates, %d refreshes, %d us/update\n", updates,
+		 refreshes, elapsed / updates);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
@@ -805,6 +902,7 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_dual_role);
 	RUN_TEST(test_rejected_port);
 	RUN_TEST(test_unknown_dualrole_capability);
+	RUN_TEST(test_update_burst);
 
 	/* Some handlers are still running after the test ends. */
 	crec_sleep(2);
@@ -0,0 +1,213 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test tokenized console output.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "test_util.h"
+#include "tokenizer.h"
+#include "util.h"
+
+static const char base64_chars[] =
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/* Decode base64 text up to the first '=' or '~'. Returns the byte count. */
+static int base64_decode(const char *in, uint8_t *out, int size)
+{
+	uint32_t v = 0;
+	int bits = 0;
+	int n = 0;
+	const char *c;
+
+	for (; *in && *in != '=' && *in != '~'; in++) {
+		c = strchr(base64_chars, *in);
+		if (!c)
+			return -1;
+		v = (v << 6) | (c - base64_chars);
+		bits += 6;
+		if (bits >= 8) {
+			bits -= 8;
+			if (n == size)
+				return -1;
+			out[n++] = v >> bits;
+		}
+	}
+
+	return n;
+}
+
+/* Decode the single message in the captured console output. */
+static int decode_captured(uint8_t *msg, int size)
+{
+	const char *out = test_get_captured_console();
+	int len = strlen(out);
+
+	if (len < 2 || out[0] != '$' || out[len - 1] != '~')
+		return -1;
+
+	return base64_decode(out + 1, msg, size);
+}
+
+/* Skip a varint, returning the index of the byte after it. */
+static int skip_varint(const uint8_t *msg, int pos)
+{
+	while (msg[pos] & 0x80)
+		pos++;
+	return pos + 1;
+}
+
+test_static int test_tokenizer_hash(void)
+{
+	/* Values from pw_tokenizer.tokens.pw_tokenizer_65599_hash() */
+	TEST_EQ(TOKENIZER_HASH(""), 0, "0x%08x");
+	TEST_EQ(TOKENIZER_HASH("hello"), 0x17fa86d3, "0x%08x");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_tokenizer_arg_types(void)
+{
+	const char *s = "s";
+	char arr[4];
+	int64_t i64 = 0;
+	uint8_t u8 = 0;
+	float f = 0;
+	uint32_t types;
+
+	TEST_EQ(TOKENIZER_ARG_TYPES(), 0, "0x%x");
+
+	types = TOKENIZER_ARG_TYPES(u8, s, f, i64, arr, 1.0);
+	TEST_EQ(TOKENIZER_TYPE_COUNT(types), 6, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 0), TOKENIZER_ARG_INT, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 1), TOKENIZER_ARG_STRING, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 2), TOKENIZER_ARG_DOUBLE, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 3), TOKENIZER_ARG_INT64, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 4), TOKENIZER_ARG_STRING, "%d");
+	TEST_EQ(TOKENIZER_TYPE(types, 5), TOKENIZER_ARG_DOUBLE, "%d");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_cprints_tokenized(void)
+{
+	const uint32_t token = TOKENIZER_HASH("[%u.%06u x=%d s=%s]\n");
+	uint8_t msg[64];
+	uint32_t t;
+	int len;
+	int pos;
+
+	test_capture_console(1);
+	cprints(CC_SYSTEM, "x=%d s=%s", -2, "hi");
+	cflush();
+	test_capture_console(0);
+
+	len = decode_captured(msg, sizeof(msg));
+	TEST_ASSERT(len > 0);
+
+	memcpy(&t, msg, sizeof(t));
+	TEST_EQ(t, token, "0x%08x");
+
+	/* Timestamp seconds and microseconds */
+	pos = skip_varint(msg, sizeof(t));
+	pos = skip_varint(msg, pos);
+
+	TEST_EQ(len - pos, 4, "%d");
+	/* Zigzag encoding of -2 */
+	TEST_EQ(msg[pos], 3, "%d");
+	TEST_EQ(msg[pos + 1], 2, "%d");
+	TEST_ASSERT(!memcmp(&msg[pos + 2], "hi", 2));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_cprints_tokenized_truncate(void)
+{
+	static const char long_str[] =
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123456789";
+	uint8_t msg[64];
+	int len;
+	int pos;
+
+	test_capture_console(1);
+	cprints(CC_SYSTEM, "%s %d", long_str, 1);
+	cflush();
+	test_capture_console(0);
+
+	len = decode_captured(msg, sizeof(msg));
+	pos = skip_varint(msg, 4);
+	pos = skip_varint(msg, pos);
+
+	/* The string fills the message, is flagged and drops the int. */
+	TEST_EQ(len, 52, "%d");
+	TEST_EQ(msg[pos], 0x80 | (len - pos - 1), "0x%02x");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_tokenizer_unsupported(void)
+{
+	TEST_ASSERT(!TOKENIZER_UNSUPPORTED("x=%d p=%p"));
+	TEST_ASSERT(!TOKENIZER_UNSUPPORTED("%p"));
+	TEST_ASSERT(TOKENIZER_UNSUPPORTED("buf=%pH"));
+	TEST_ASSERT(TOKENIZER_UNSUPPORTED("%pT"));
+	TEST_ASSERT(TOKENIZER_UNSUPPORTED(
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123 %pP"));
+	TEST_ASSERT(TOKENIZER_UNSUPPORTED(
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123456789"
+		"0123456789012345678901234567890123456789 %d"));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_cprints_untokenized(void)
+{
+	int x = 0;
+
+	test_capture_console(1);
+	cprints(CC_SYSTEM, "p=%pH", &x);
+	cflush();
+	test_capture_console(0);
+
+	/* Printed as text, not as a "$<base64>~" message */
+	TEST_ASSERT(test_get_captured_console()[0] == '[');
+	TEST_ASSERT(strstr(test_get_captured_console(), " p=") != NULL);
+
+	return EC_SUCCESS;
+}
+
+test_static int test_cprints_tokenized_channel(void)
+{
+	console_channel_disable("system");
+	test_capture_console(1);
+	cprints(CC_SYSTEM, "shouldn't see this");
+	cflush();
+	test_capture_console(0);
+	console_channel_enable("system");
+
+	TEST_ASSERT(test_get_captured_console()[0] == '\0');
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_tokenizer_hash);
+	RUN_TEST(test_tokenizer_arg_types);
+	RUN_TEST(test_cprints_tokenized);
+	RUN_TEST(test_cprints_tokenized_truncate);
+	RUN_TEST(test_tokenizer_unsupported);
+	RUN_TEST(test_cprints_untokenized);
+	RUN_TEST(test_cprints_tokenized_channel);
+
+	test_print_result();
+}
@@ -6,6 +6,7 @@
 /* Console commands to trigger flash host commands */
 
 #include "console.h"
+#include "crc.h"
 #include "ec_commands.h"
 #include "flash.h"
 #include "gpio.h"
@@ -183,6 +184,61 @@ int host_command_write(int offset, int size, const char *data)
 				      buf, size + sizeof(*params), NULL, 0);
 }
 
+/*
+ * Send one streaming write subcommand, retrying while the EC is still
+ * programming its buffers.
+ */
+static int host_command_write_stream_cmd(struct ec_params_flash_write_stream *p,
+					 int size)
+{
+	struct ec_response_flash_write_stream resp;
+	int res;
+	int retries = 100;
+
+	do {
+		res = test_send_host_command(EC_CMD_FLASH_WRITE_STREAM, 0, p,
+					     size, &resp, sizeof(resp));
+		if (res != EC_RES_BUSY)
+			return res;
+		crec_msleep(1);
+	} while (--retries);
+
+	return res;
+}
+
+int host_command_write_stream(int offset, int size, const char *data,
+			      int chunk, uint32_t crc)
+{
+	uint8_t buf[256];
+	struct ec_params_flash_write_stream *params =
+		(struct ec_params_flash_write_stream *)buf;
+	int res;
+	int i;
+
+	memset(params, 0, sizeof(*params));
+	params->cmd = FLASH_WRITE_STREAM_START;
+	params->offset = offset;
+	params->size = size;
+	res = host_command_write_stream_cmd(params, sizeof(*params));
+	if (res != EC_RES_SUCCESS)
+		return res;
+
+	params->cmd = FLASH_WRITE_STREAM_DATA;
+	for (i = 0; i < size; i += chunk) {
+		params->offset = i;
+		params->size = MIN(size - i, chunk);
+		memcpy(params->data, data + i, params->size);
+		res = host_command_write_stream_cmd(
+			params, sizeof(*params) + params->size);
+		if (res != EC_RES_SUCCESS)
+			return res;
+	}
+
+	params->cmd = FLASH_WRITE_STREAM_DONE;
+	params->crc32 = crc;
+	return host_command_write_stream_cmd(params, sizeof(*params));
+}
+
 int host_command_erase(int offset, int size)
 {
 	struct ec_params_flash_write params;
@@ -332,6 +388,55 @@ static int test_overwrite_other(void)
 	return EC_SUCCESS;
 }
 
+static int test_write_stream(void)
+{
+	static char data[3000];
+	struct ec_params_flash_write_stream params = { 0 };
+	uint32_t offset, crc;
+	int i;
+
+	/* Stream into the other image, across several buffer switches */
+	if (system_is_in_rw())
+		offset = CONFIG_RO_STORAGE_OFF;
+	else
+		offset = CONFIG_RW_STORAGE_OFF;
+
+#ifdef EMU_BUILD
+	mock_is_running_img = 0;
+#endif
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 7 + 3;
+	crc32_ctx_init(&crc);
+	crc32_ctx_hash(&crc, data, sizeof(data));
+	crc = crc32_ctx_result(&crc);
+
+	TEST_ASSERT(host_command_write_stream(offset, sizeof(data), data, 200,
+					      crc) == EC_RES_SUCCESS);
+	TEST_ASSERT(verify_write(offset, sizeof(data), data) == EC_SUCCESS);
+
+	/* A bad CRC fails the stream once it is complete */
+	TEST_ASSERT(host_command_write_stream(offset, sizeof(data), data, 200,
+					      crc ^ 1) == EC_RES_ERROR);
+
+	/* Packets must arrive in order */
+	params.cmd = FLASH_WRITE_STREAM_START;
+	params.offset = offset;
+	params.size = sizeof(data);
+	TEST_ASSERT(host_command_write_stream_cmd(&params, sizeof(params)) ==
+		    EC_RES_SUCCESS);
+	params.cmd = FLASH_WRITE_STREAM_DATA;
+	params.offset = 4;
+	params.size = 0;
+	TEST_ASSERT(host_command_write_stream_cmd(&params, sizeof(params)) ==
+		    EC_RES_INVALID_PARAM);
+	params.cmd = FLASH_WRITE_STREAM_ABORT;
+	TEST_ASSERT(host_command_write_stream_cmd(&params, sizeof(params)) ==
+		    EC_RES_SUCCESS);
+
+	return EC_SUCCESS;
+}
+
 static int test_op_failure(void)
 {
 	mock_flash_op_fail = EC_ERROR_UNKNOWN;
@@ -456,6 +561,7 @@ static void run_test_step1(void)
 	RUN_TEST(test_is_erased);
 	RUN_TEST(test_overwrite_current);
 	RUN_TEST(test_overwrite_other);
+	RUN_TEST(test_write_stream);
 	RUN_TEST(test_op_failure);
 	RUN_TEST(test_flash_info);
 	RUN_TEST(test_region_info);
@@ -8,6 +8,7 @@
 #include "common.h"
 #include "console.h"
 #include "host_command.h"
+#include "link_defs.h"
 #include "printf.h"
 #include "task.h"
 #include "test_util.h"
@@ -306,6 +307,36 @@ static int test_hostcmd_clears_unused_data(void)
 	return EC_SUCCESS;
 }
 
+enum hcmd_index_state {
+	HCMD_INDEX_EMPTY,
+	HCMD_INDEX_READY,
+	HCMD_INDEX_UNUSABLE,
+};
+extern enum hcmd_index_state hcmd_index_state;
+
+static int test_hostcmd_index(void)
+{
+	const struct host_command *cmd, *first;
+
+	/* The table fits in the index, so lookups don't fall back. */
+	find_host_command(EC_CMD_HELLO);
+	TEST_EQ(hcmd_index_state, HCMD_INDEX_READY, "%d");
+
+	/* Every command resolves to its first entry in the table. */
+	for (cmd = __hcmds; cmd < __hcmds_end; cmd++) {
+		for (first = __hcmds; first->command != cmd->command; first++)
+			;
+		TEST_ASSERT(find_host_command(cmd->command) == first);
+	}
+
+	/* Unknown commands inside and outside the index. */
+	TEST_ASSERT(find_host_command(CONFIG_HOSTCMD_INDEX_SIZE - 1) == NULL);
+	TEST_ASSERT(find_host_command(CONFIG_HOSTCMD_INDEX_SIZE) == NULL);
+	TEST_ASSERT(find_host_command(-1) == NULL);
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	wait_for_task_started();
@@ -321,6 +352,7 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_hostcmd_invalid_checksum);
 	RUN_TEST(test_hostcmd_reuse_response_buffer);
 	RUN_TEST(test_hostcmd_clears_unused_data);
+	RUN_TEST(test_hostcmd_index);
 
 	test_print_result();
 }
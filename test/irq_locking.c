@@ -21,14 +21,22 @@ void interrupt_enable(void)
 	++interrupt_enable_count;
 }
 
+/*
+ * Console output goes through interrupt_disable() / interrupt_enable() too, so
+ * the counts are all read before the checks print anything.
+ */
+
 static int test_simple_lock_unlock(void)
 {
 	uint32_t key = irq_lock();
+	uint32_t disable_count, enable_count;
 
 	irq_unlock(key);
+	disable_count = interrupt_disable_count;
+	enable_count = interrupt_enable_count;
 
-	TEST_EQ(interrupt_disable_count, 1, "%u");
-	TEST_EQ(interrupt_enable_count, 1, "%u");
+	TEST_EQ(disable_count, 1, "%u");
+	TEST_EQ(enable_count, 1, "%u");
 
 	return EC_SUCCESS;
 }
@@ -37,16 +45,19 @@ static int test_unlock_when_all_keys_removed(void)
 {
 	uint32_t key0 = irq_lock();
 	uint32_t key1 = irq_lock();
+	uint32_t disable_count, enable_count[2];
 
-	TEST_EQ(interrupt_disable_count, 2, "%u");
+	disable_count = interrupt_disable_count;
 
 	irq_unlock(key1);
-
-	TEST_EQ(interrupt_enable_count, 0, "%u");
+	enable_count[0] = interrupt_enable_count;
 
 	irq_unlock(key0);
+	enable_count[1] = interrupt_enable_count;
 
-	TEST_EQ(interrupt_enable_count, 1, "%u");
+	TEST_EQ(disable_count, 2, "%u");
+	TEST_EQ(enable_count[0], 0, "%u");
+	TEST_EQ(enable_count[1], 1, "%u");
 
 	return EC_SUCCESS;
 }
@@ -55,12 +66,16 @@ static int test_unlock_from_root_key(void)
 {
 	uint32_t key0 = irq_lock();
 	uint32_t key1 = irq_lock();
+	uint32_t disable_count, enable_count;
 
-	TEST_NE(key0, key1, "%u");
-	TEST_EQ(interrupt_disable_count, 2, "%u");
+	disable_count = interrupt_disable_count;
 
 	irq_unlock(key0);
-	TEST_EQ(interrupt_enable_count, 1, "%u");
+	enable_count = interrupt_enable_count;
+
+	TEST_NE(key0, key1, "%u");
+	TEST_EQ(disable_count, 2, "%u");
+	TEST_EQ(enable_count, 1, "%u");
 
 	return EC_SUCCESS;
 }
@@ -23,6 +23,9 @@
 /*****************************************************************************/
 /* Test utilities */
 
+extern int lid_angle_move_threshold;
+extern unsigned int lid_angle_calc_count;
+
 /* Array units is in m/s^2 - old matrix format. */
 int filler(const struct motion_sensor_t *s, const float v)
 {
@@ -88,11 +91,98 @@ static int test_lid_angle_less180(void)
 	return EC_SUCCESS;
 }
 
+/* Number of samples the device is left at rest after the recording. */
+#define TEST_LID_STILL_SAMPLES 200
+
+/*
+ * Feed sample i of the benchmark: the recorded laptop mode data, followed by
+ * the last recorded sample held with +/-0.01 g of noise, as if the device
+ * was put down.
+ */
+static void feed_benchmark_sample(int i, int *index)
+{
+	const int recorded = kAccelerometerLaptopModeTestDataLength /
+			     TEST_LID_SAMPLE_SIZE;
+	const float *last = &kAccelerometerLaptopModeTestData
+		[(recorded - 1) * TEST_LID_SAMPLE_SIZE];
+	float still[TEST_LID_SAMPLE_SIZE];
+	int still_index = 0;
+	int j;
+
+	if (i < recorded) {
+		feed_accel_data(kAccelerometerLaptopModeTestData, index,
+				filler);
+		return;
+	}
+
+	for (j = 0; j < TEST_LID_SAMPLE_SIZE; j++)
+		still[j] = last[j] + ((i + j) & 1 ? 0.01f : -0.01f);
+	feed_accel_data(still, &still_index, filler);
+}
+
+/*
+ * Run the benchmark data through the lid angle calculation, once with every
+ * sample calculated and once with the default decimation.
+ */
+static int test_lid_angle_decimation_benchmark(void)
+{
+	static int angles[1024];
+	const int default_threshold = lid_angle_move_threshold;
+	const int recorded = kAccelerometerLaptopModeTestDataLength /
+			     TEST_LID_SAMPLE_SIZE;
+	const int samples = recorded + TEST_LID_STILL_SAMPLES;
+	unsigned int full_calcs, calcs, moving_calcs;
+	int index, i, lid_angle, max_error = 0;
+
+	TEST_ASSERT(samples <= ARRAY_SIZE(angles));
+
+	/* Every sample moves beyond a negative threshold. */
+	lid_angle_move_threshold = -1;
+	lid_angle_calc_count = 0;
+	for (index = 0, i = 0; i < samples; i++) {
+		feed_benchmark_sample(i, &index);
+		motion_lid_calc();
+		angles[i] = motion_lid_get_angle();
+	}
+	full_calcs = lid_angle_calc_count;
+
+	lid_angle_move_threshold = default_threshold;
+	lid_angle_calc_count = 0;
+	moving_calcs = 0;
+	for (index = 0, i = 0; i < samples; i++) {
+		if (i == recorded)
+			moving_calcs = lid_angle_calc_count;
+		feed_benchmark_sample(i, &index);
+		motion_lid_calc();
+		lid_angle = motion_lid_get_angle();
+		if (lid_angle != LID_ANGLE_UNRELIABLE &&
+		    angles[i] != LID_ANGLE_UNRELIABLE)
+			max_error = MAX(max_error, ABS(lid_angle - angles[i]));
+	}
+	calcs = lid_angle_calc_count;
+
+	ccprintf("%d samples: %u calculations, %u with decimation "
+		 "(%u of %d while moving, %u of %d at rest), "
+		 "max error %d degrees\n",
+		 samples, full_calcs, calcs, moving_calcs, recorded,
+		 calcs - moving_calcs, TEST_LID_STILL_SAMPLES, max_error);
+	TEST_EQ(full_calcs, samples, "%u");
+	/* Decimation must not move the angle by more than 2 degrees. */
+	TEST_LE(max_error, 2, "%d");
+	TEST_LE(moving_calcs, recorded, "%u");
+	/* At rest, the angle is not recalculated at all. */
+	TEST_EQ(calcs - moving_calcs, 0, "%u");
+	TEST_ASSERT(!tablet_get_mode());
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_lid_angle_less180);
+	RUN_TEST(test_lid_angle_decimation_benchmark);
 
 	test_print_result();
 }
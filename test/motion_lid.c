@@ -38,6 +38,11 @@ extern int wait_us;
 
 /*****************************************************************************/
 /* Mock functions */
+
+/* Number of reads and interrupts handled, per sensor. */
+static int read_count[SENSOR_COUNT];
+static int irq_count[SENSOR_COUNT];
+
 static int accel_init(struct motion_sensor_t *s)
 {
 	return EC_SUCCESS;
@@ -45,6 +50,7 @@ static int accel_init(struct motion_sensor_t *s)
 
 static int accel_read(const struct motion_sensor_t *s, intv3_t v)
 {
+	read_count[s - motion_sensors]++;
 	rotate(s->xyz, *s->rot_standard_ref, v);
 	return EC_SUCCESS;
 }
@@ -75,9 +81,16 @@ static int accel_get_data_rate(const struct motion_sensor_t *s)
 	return test_data_rate[s - motion_sensors];
 }
 
+static int accel_irq_handler(struct motion_sensor_t *s, uint32_t *event)
+{
+	irq_count[s - motion_sensors]++;
+	return EC_ERROR_NOT_HANDLED;
+}
+
 const struct accelgyro_drv test_motion_sense = {
 	.init = accel_init,
 	.read = accel_read,
+	.irq_handler = accel_irq_handler,
 	.set_range = accel_set_range,
 	.get_resolution = accel_get_resolution,
 	.set_data_rate = accel_set_data_rate,
@@ -102,7 +115,7 @@ struct motion_sensor_t motion_sensors[] = {
 			},
 			/* Used for double tap */
 			[SENSOR_CONFIG_EC_S3] = {
-				.odr = 119000 | ROUND_UP_FLAG,
+				.odr = 5000 | ROUND_UP_FLAG,
 				.ec_rate = TEST_LID_EC_RATE * 100,
 			},
 		},
@@ -124,7 +137,7 @@ struct motion_sensor_t motion_sensors[] = {
 			},
 			/* Used for double tap */
 			[SENSOR_CONFIG_EC_S3] = {
-				.odr = 200000 | ROUND_UP_FLAG,
+				.odr = 5000 | ROUND_UP_FLAG,
 				.ec_rate = TEST_LID_EC_RATE * 100,
 			},
 		},
@@ -396,11 +409,86 @@ static int test_lid_angle(void)
 	return EC_SUCCESS;
 }
 
+static void clear_counts(void)
+{
+	memset(read_count, 0, sizeof(read_count));
+	memset(irq_count, 0, sizeof(irq_count));
+}
+
+/*
+ * Interrupts from one sensor must not make the task read the other sensor
+ * before it is due.
+ */
+static int test_due_sensors_only(void)
+{
+	struct motion_sensor_t *lid =
+		&motion_sensors[CONFIG_LID_ANGLE_SENSOR_LID];
+	int i;
+
+	hook_notify(HOOK_CHIPSET_SUSPEND);
+	hook_notify(HOOK_CHIPSET_RESUME);
+	crec_msleep(50);
+	TEST_ASSERT(sensor_active == SENSOR_ACTIVE_S0);
+
+	/* Interrupt from the base every ms, for 10 lid collection periods. */
+	clear_counts();
+	for (i = 0; i < 10 * lid->collection_rate / MSEC; i++) {
+		task_set_event(TASK_ID_MOTIONSENSE,
+			       TASK_EVENT_MOTION_SENSOR_INTERRUPT(BASE));
+		crec_usleep(MSEC);
+	}
+
+	TEST_GT(irq_count[BASE], 10, "%d");
+	/* The lid was only processed when it had to be read. */
+	TEST_LE(read_count[LID], 11, "%d");
+	TEST_GE(read_count[LID], 9, "%d");
+	TEST_LE(irq_count[LID], read_count[LID], "%d");
+
+	hook_notify(HOOK_CHIPSET_SHUTDOWN);
+	crec_msleep(50);
+	return EC_SUCCESS;
+}
+
+/* Only the sensor whose interrupt fired gets its interrupt handled. */
+static int test_irq_dispatch(void)
+{
+	/* Sensors only go to S3 from S0. */
+	hook_notify(HOOK_CHIPSET_SUSPEND);
+	hook_notify(HOOK_CHIPSET_RESUME);
+	crec_msleep(50);
+	hook_notify(HOOK_CHIPSET_SUSPEND);
+	crec_msleep(50);
+	TEST_ASSERT(sensor_active == SENSOR_ACTIVE_S3);
+
+	/* No read is due in the first 200 ms at the S3 ODR. */
+	clear_counts();
+	task_set_event(TASK_ID_MOTIONSENSE,
+		       TASK_EVENT_MOTION_SENSOR_INTERRUPT(LID));
+	crec_msleep(10);
+	TEST_EQ(irq_count[LID], 1, "%d");
+	TEST_EQ(irq_count[BASE], 0, "%d");
+
+	task_set_event(TASK_ID_MOTIONSENSE,
+		       TASK_EVENT_MOTION_SENSOR_INTERRUPT(BASE));
+	crec_msleep(10);
+	TEST_EQ(irq_count[LID], 1, "%d");
+	TEST_EQ(irq_count[BASE], 1, "%d");
+
+	TEST_EQ(read_count[BASE], 0, "%d");
+	TEST_EQ(read_count[LID], 0, "%d");
+
+	hook_notify(HOOK_CHIPSET_SHUTDOWN);
+	crec_msleep(50);
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_lid_angle);
+	RUN_TEST(test_due_sensors_only);
+	RUN_TEST(test_irq_dispatch);
 
 	test_print_result();
 }
@@ -66,9 +66,16 @@ static struct mag_cal_t lid_mag_cal_data;
 static bool next_accel_cal_accumulate_result;
 static fpv3_t next_accel_cal_bias;
 
+/* Number of lid samples calibrated when each base sample was calibrated. */
+static int lid_samples_at_accel[CONFIG_ONLINE_CALIB_BATCH_SIZE];
+static int accel_samples;
+
 bool accel_cal_accumulate(struct accel_cal *cal, uint32_t sample_time, fp_t x,
 			  fp_t y, fp_t z, fp_t temp)
 {
+	if (accel_samples < ARRAY_SIZE(lid_samples_at_accel))
+		lid_samples_at_accel[accel_samples++] =
+			lid_mag_cal_data.kasa_fit.nsamples;
 	if (next_accel_cal_accumulate_result) {
 		cal->bias[X] = next_accel_cal_bias[X];
 		cal->bias[Y] = next_accel_cal_bias[Y];
@@ -222,9 +229,109 @@ int test_mag_reading_updated_cal(void)
 	return EC_SUCCESS;
 }
 
+static int test_batch_processed_on_commit(void)
+{
+	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
+						  EC_SUCCESS, 0, NULL };
+	struct mag_cal_t expected_results;
+	struct ec_response_motion_sensor_data data;
+	int test_values[] = { 207, -17, -37 };
+	int i;
+
+	mock_read_temp_results = &expected;
+	next_accel_cal_accumulate_result = false;
+	init_mag_cal(&expected_results);
+
+	data.data[X] = test_values[X];
+	data.data[Y] = test_values[Y];
+	data.data[Z] = test_values[Z];
+	for (i = 0; i < 4; i++) {
+		data.sensor_num = BASE;
+		online_calibration_stage_data(&data, &motion_sensors[BASE],
+					      __hw_clock_source_read());
+		data.sensor_num = LID;
+		online_calibration_stage_data(&data, &motion_sensors[LID],
+					      __hw_clock_source_read());
+		mag_cal_update(&expected_results, test_values);
+	}
+
+	/* Nothing is processed until the commit. */
+	TEST_EQ(expected.used_count, 0, "%d");
+	TEST_EQ(lid_mag_cal_data.kasa_fit.nsamples, 0, "%d");
+
+	online_calibration_commit();
+
+	/* The temperature is read once, then taken from the cache. */
+	TEST_EQ(expected.used_count, 1, "%d");
+	TEST_EQ(expected_results.kasa_fit.nsamples,
+		lid_mag_cal_data.kasa_fit.nsamples, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_full_batch_processed_on_stage(void)
+{
+	struct ec_response_motion_sensor_data data;
+	int i;
+
+	data.sensor_num = LID;
+	data.data[X] = 207;
+	data.data[Y] = -17;
+	data.data[Z] = -37;
+	for (i = 0; i <= CONFIG_ONLINE_CALIB_BATCH_SIZE; i++)
+		online_calibration_stage_data(&data, &motion_sensors[LID],
+					      __hw_clock_source_read());
+
+	/* The full batch was processed to make room for the last sample. */
+	TEST_EQ(lid_mag_cal_data.kasa_fit.nsamples,
+		CONFIG_ONLINE_CALIB_BATCH_SIZE, "%d");
+
+	online_calibration_commit();
+	TEST_EQ(lid_mag_cal_data.kasa_fit.nsamples,
+		CONFIG_ONLINE_CALIB_BATCH_SIZE + 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+/* Samples from different sensors are calibrated in the order they came. */
+static int test_batch_processed_in_order(void)
+{
+	struct mock_read_temp_result expected = { &motion_sensors[BASE], 200,
+						  EC_SUCCESS, 0, NULL };
+	struct ec_response_motion_sensor_data data;
+	int i;
+
+	mock_read_temp_results = &expected;
+	next_accel_cal_accumulate_result = false;
+
+	data.data[X] = 207;
+	data.data[Y] = -17;
+	data.data[Z] = -37;
+	for (i = 0; i < 3; i++) {
+		data.sensor_num = BASE;
+		online_calibration_stage_data(&data, &motion_sensors[BASE],
+					      __hw_clock_source_read());
+		data.sensor_num = LID;
+		online_calibration_stage_data(&data, &motion_sensors[LID],
+					      __hw_clock_source_read());
+		online_calibration_stage_data(&data, &motion_sensors[LID],
+					      __hw_clock_source_read());
+	}
+	online_calibration_commit();
+
+	TEST_EQ(accel_samples, 3, "%d");
+	TEST_EQ(lid_samples_at_accel[0], 0, "%d");
+	TEST_EQ(lid_samples_at_accel[1], 2, "%d");
+	TEST_EQ(lid_samples_at_accel[2], 4, "%d");
+	TEST_EQ(lid_mag_cal_data.kasa_fit.nsamples, 6, "%d");
+
+	return EC_SUCCESS;
+}
+
 void before_test(void)
 {
 	mock_read_temp_results = NULL;
+	accel_samples = 0;
 	online_calibration_init();
 }
 
@@ -237,6 +344,9 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_read_temp_twice_after_cache_stale);
 	RUN_TEST(test_new_calibration_value);
 	RUN_TEST(test_mag_reading_updated_cal);
+	RUN_TEST(test_batch_processed_on_commit);
+	RUN_TEST(test_full_batch_processed_on_stage);
+	RUN_TEST(test_batch_processed_in_order);
 
 	test_print_result();
 }
@@ -6,6 +6,7 @@
  */
 #include "common.h"
 #include "console.h"
+#include "host_command.h"
 #include "keyboard_backlight.h"
 #include "rgb_keyboard.h"
 #include "task.h"
@@ -50,6 +51,8 @@ struct rgbkbd rgbkbds[] = {
 const uint8_t rgbkbd_count = ARRAY_SIZE(rgbkbds);
 const uint8_t rgbkbd_hsize = RGB_GRID0_COL + RGB_GRID1_COL;
 const uint8_t rgbkbd_vsize = RGB_GRID0_ROW;
+BUILD_ASSERT((RGB_GRID0_COL + RGB_GRID1_COL) * RGB_GRID0_ROW <=
+	     RGBKBD_MATRIX_MAX_SIZE);
 
 enum ec_rgbkbd_type rgbkbd_type = EC_RGBKBD_TYPE_UNKNOWN;
 
@@ -69,6 +72,9 @@ static struct rgbkbd_mock {
 	uint32_t count_drv_set_scale;
 	uint32_t count_drv_set_gcc;
 	uint32_t gcc_level;
+	uint8_t color_offset[ARRAY_SIZE(rgbkbds)];
+	uint8_t color_len[ARRAY_SIZE(rgbkbds)];
+	int set_color_rv;
 } mock_state;
 
 __override void board_kblight_init(void)
@@ -106,7 +112,9 @@ static int test_drv_set_color(struct rgbkbd *ctx, uint8_t offset,
 			      struct rgb_s *color, uint8_t len)
 {
 	mock_state.count_drv_set_color++;
-	return EC_SUCCESS;
+	mock_state.color_offset[RGBKBD_CTX_TO_GRID(ctx)] = offset;
+	mock_state.color_len[RGBKBD_CTX_TO_GRID(ctx)] = len;
+	return mock_state.set_color_rv;
 }
 
 static int test_drv_set_scale(struct rgbkbd *ctx, uint8_t offset,
@@ -387,6 +395,177 @@ static int test_rgbkbd_demo_flow(void)
 	return EC_SUCCESS;
 }
 
+static int send_frame_flags(uint16_t start, uint8_t length, struct rgb_s color,
+			    uint8_t flags)
+{
+	uint8_t buf[sizeof(struct ec_params_rgbkbd_frame) +
+		    EC_RGBKBD_MAX_KEY_COUNT * SIZE_OF_RGB];
+	struct ec_params_rgbkbd_frame *p = (void *)buf;
+	struct ec_response_rgbkbd_frame r;
+	int i, rv;
+
+	p->start = start;
+	p->length = length;
+	p->flags = flags;
+	for (i = 0; i < length; i++)
+		p->color[i] = color;
+
+	rv = test_send_host_command(EC_CMD_RGBKBD_FRAME, 0, p,
+				    sizeof(*p) + length * SIZE_OF_RGB, &r,
+				    sizeof(r));
+	if (rv == EC_RES_SUCCESS) {
+		zassert_equal(r.hsize, rgbkbd_hsize, "hsize");
+		zassert_equal(r.vsize, rgbkbd_vsize, "vsize");
+	}
+
+	return rv;
+}
+
+static int send_frame(uint16_t start, uint8_t length, struct rgb_s color)
+{
+	return send_frame_flags(start, length, color, 0);
+}
+
+static int send_set_color(uint8_t key, struct rgb_s color)
+{
+	uint8_t buf[sizeof(struct ec_params_rgbkbd_set_color) + SIZE_OF_RGB];
+	struct ec_params_rgbkbd_set_color *p = (void *)buf;
+
+	p->start_key = key;
+	p->length = 1;
+	p->color[0] = color;
+
+	return test_send_host_command(EC_CMD_RGBKBD_SET_COLOR, 0, p,
+				      sizeof(buf), NULL, 0);
+}
+
+static int test_rgbkbd_frame(void)
+{
+	const char *argv_demo[] = { "rgbk", "demo", "0" };
+	const struct rgb_s color = { 1, 2, 3 };
+	const uint8_t grid0_len = RGB_GRID0_COL * RGB_GRID0_ROW;
+	struct ec_params_rgbkbd_frame short_p = { 0 };
+	struct ec_response_rgbkbd_frame r;
+	int frame_ms = 1000 / CONFIG_RGBKBD_MAX_FPS + 1;
+	int i;
+
+	zassert_equal(cc_rgb(ARRAY_SIZE(argv_demo), argv_demo), EC_SUCCESS,
+		      "rgbk demo 0");
+	crec_msleep(frame_ms);
+
+	/* A run crossing the grid boundary is one burst per grid. */
+	before_test();
+	zassert_equal(send_frame(grid0_len - 2, 4, color), EC_RES_SUCCESS,
+		      "frame");
+	for (i = 0; i < 2; i++) {
+		zassert_equal(grid0[grid0_len - 2 + i].b, 3, "grid0 updated");
+		zassert_equal(grid1[i].b, 3, "grid1 updated");
+	}
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 2, "one burst per grid");
+	zassert_equal(mock_state.color_offset[0], grid0_len - 2, "offset");
+	zassert_equal(mock_state.color_len[0], 2, "len");
+	zassert_equal(mock_state.color_offset[1], 0, "offset");
+	zassert_equal(mock_state.color_len[1], 2, "len");
+
+	/* Deltas made before the next frame are coalesced. */
+	before_test();
+	zassert_equal(send_frame(3, 1, color), EC_RES_SUCCESS, "delta");
+	zassert_equal(send_frame(10, 2, color), EC_RES_SUCCESS, "delta");
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 1, "one burst");
+	zassert_equal(mock_state.color_offset[0], 3, "offset");
+	zassert_equal(mock_state.color_len[0], 9, "len");
+
+	/* Nothing changed, nothing sent. */
+	before_test();
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 0, "no flush");
+
+	/* A failed LED write is reported once its frame is flushed. */
+	mock_state.set_color_rv = EC_ERROR_UNKNOWN;
+	zassert_equal(send_set_color(1, color), EC_RES_SUCCESS, "queued");
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 1, "flushed");
+	mock_state.set_color_rv = EC_SUCCESS;
+	zassert_equal(send_set_color(1, color), EC_RES_ERROR, "reported");
+	crec_msleep(frame_ms);
+	zassert_equal(send_set_color(1, color), EC_RES_SUCCESS, "recovered");
+	crec_msleep(frame_ms);
+
+	/* Out of range runs are rejected. */
+	zassert_equal(send_frame(rgbkbd_hsize * rgbkbd_vsize - 1, 2, color),
+		      EC_RES_INVALID_PARAM, "overflow");
+
+	/* So are params too short to hold the header. */
+	zassert_equal(test_send_host_command(EC_CMD_RGBKBD_FRAME, 0, &short_p, 2,
+					     &r, sizeof(r)),
+		      EC_RES_INVALID_PARAM, "short params");
+
+	return EC_SUCCESS;
+}
+
+static int test_rgbkbd_frame_back_buffer(void)
+{
+	const struct rgb_s color = { 4, 5, 6 };
+	const uint8_t grid0_len = RGB_GRID0_COL * RGB_GRID0_ROW;
+	const char *argv_all[] = { "rgbk", "all", "0" };
+	int frame_ms = 1000 / CONFIG_RGBKBD_MAX_FPS + 1;
+
+	/* Clearing resets both buffers. */
+	zassert_equal(cc_rgb(ARRAY_SIZE(argv_all), argv_all), EC_SUCCESS,
+		      "rgbk all 0");
+	crec_msleep(frame_ms);
+
+	/* Writes to the back buffer aren't shown until swapped in. */
+	before_test();
+	zassert_equal(send_frame_flags(grid0_len - 1, 2, color,
+				       EC_RGBKBD_FRAME_BACK),
+		      EC_RES_SUCCESS, "back");
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 0, "not shown");
+	zassert_not_equal(grid0[grid0_len - 1].b, 6, "front untouched");
+
+	/* The last part of the frame requests the swap. */
+	zassert_equal(send_frame_flags(5, 1, color,
+				       EC_RGBKBD_FRAME_BACK |
+					       EC_RGBKBD_FRAME_SWAP),
+		      EC_RES_SUCCESS, "back + swap");
+
+	/* The next frame can't be written until the swap is done. */
+	zassert_equal(send_frame_flags(0, 1, color, EC_RGBKBD_FRAME_BACK),
+		      EC_RES_BUSY, "busy");
+
+	/* Only LEDs that differ from the displayed frame are sent. */
+	crec_msleep(frame_ms);
+	zassert_equal(grid0[5].b, 6, "swapped");
+	zassert_equal(grid0[grid0_len - 1].b, 6, "swapped");
+	zassert_equal(grid1[0].b, 6, "swapped");
+	zassert_equal(mock_state.count_drv_set_color, 2, "one burst per grid");
+	zassert_equal(mock_state.color_offset[0], 5, "offset");
+	zassert_equal(mock_state.color_len[0], grid0_len - 5, "len");
+	zassert_equal(mock_state.color_offset[1], 0, "offset");
+	zassert_equal(mock_state.color_len[1], 1, "len");
+
+	/* A swap without a new back buffer write would show a stale frame. */
+	zassert_equal(send_frame_flags(0, 0, color, EC_RGBKBD_FRAME_SWAP),
+		      EC_RES_INVALID_PARAM, "stale swap");
+
+	/* Swapping in an unchanged frame sends nothing. */
+	before_test();
+	zassert_equal(send_frame_flags(5, 1, color, EC_RGBKBD_FRAME_BACK),
+		      EC_RES_SUCCESS, "back");
+	zassert_equal(send_frame_flags(0, 0, color, EC_RGBKBD_FRAME_SWAP),
+		      EC_RES_SUCCESS, "swap");
+	crec_msleep(frame_ms);
+	zassert_equal(mock_state.count_drv_set_color, 0, "no change");
+
+	zassert_equal(send_frame_flags(0, 0, color, BIT(7)),
+		      EC_RES_INVALID_PARAM, "bad flags");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	RUN_TEST(test_rgbkbd_startup);
@@ -394,5 +573,7 @@ void run_test(int argc, const char **argv)
 	RUN_TEST(test_rgbkbd_rotate_color);
 	RUN_TEST(test_rgbkbd_demo_flow);
 	RUN_TEST(test_rgbkbd_map);
+	RUN_TEST(test_rgbkbd_frame);
+	RUN_TEST(test_rgbkbd_frame_back_buffer);
 	test_print_result();
 }
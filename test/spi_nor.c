@@ -0,0 +1,482 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Tests the SFDP-based Serial NOR Flash driver against an emulated part.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "sfdp.h"
+#include "spi.h"
+#include "spi_nor.h"
+#include "test_util.h"
+#include "timer.h"
+#include "util.h"
+
+#define EMU_CAPACITY (1024 * 1024)
+#define EMU_PAGE_SIZE 256
+
+/* Basic Flash Parameter Table location in the SFDP space. */
+#define EMU_BFPT_OFFSET 0x10
+#define EMU_BFPT_DWORDS 16
+
+/*
+ * The controller clocks every opcode at its source clock divided by the
+ * device's divider, so Read (0x03) and Fast Read (0x0B) cost the same per
+ * byte. Each transaction also costs the controller setup time.
+ */
+#define EMU_CONTROLLER_SCLK_KHZ 104000
+#define EMU_TRANSACTION_NS 2000
+
+/* Typical erase times of the emulated part. */
+#define EMU_4KIB_ERASE_MS 45
+#define EMU_32KIB_ERASE_MS 120
+#define EMU_64KIB_ERASE_MS 150
+#define EMU_CHIP_ERASE_MS 2000
+
+static struct {
+	uint8_t mem[EMU_CAPACITY];
+	uint32_t sfdp[EMU_BFPT_OFFSET / 4 + EMU_BFPT_DWORDS];
+	int wel;
+	int in_4b;
+	/* Bus time, the driver's status polling is folded into it. */
+	uint64_t now_ns;
+	uint64_t busy_until_ns;
+	unsigned int opcodes[256];
+	unsigned int errors;
+} emu;
+
+struct spi_nor_device_t spi_nor_devices[] = {
+	{
+		.name = "emu",
+		.spi_controller = SPI_NOR_FLASH_DEVICE,
+		.timeout_usec = 100 * MSEC,
+		.capacity = EMU_CAPACITY,
+		.page_size = EMU_PAGE_SIZE,
+	},
+};
+const unsigned int spi_nor_devices_used = ARRAY_SIZE(spi_nor_devices);
+
+/* Fill the SFDP space, a minor_rev of 0 or 5 selects the BFPT version. */
+static void emu_set_sfdp(int enabled, int minor_rev)
+{
+	uint32_t *sfdp = emu.sfdp;
+	uint32_t *bfpt = &emu.sfdp[EMU_BFPT_OFFSET / 4];
+
+	memset(emu.sfdp, 0, sizeof(emu.sfdp));
+	if (!enabled)
+		return;
+
+	sfdp[0] = SFDP_HEADER_DWORD_1('S', 'F', 'D', 'P');
+	sfdp[1] = SFDP_HEADER_DWORD_2(0, 1, minor_rev);
+	if (minor_rev >= 5) {
+		sfdp[2] = SFDP_1_5_PARAMETER_HEADER_DWORD_1(
+			EMU_BFPT_DWORDS, 1, minor_rev,
+			BASIC_FLASH_PARAMETER_TABLE_1_5_ID_LSB);
+		sfdp[3] = SFDP_1_5_PARAMETER_HEADER_DWORD_2(
+			BASIC_FLASH_PARAMETER_TABLE_1_5_ID_MSB,
+			EMU_BFPT_OFFSET);
+	} else {
+		sfdp[2] = SFDP_1_0_PARAMETER_HEADER_DWORD_1(
+			9, 1, minor_rev, BASIC_FLASH_PARAMETER_TABLE_1_0_ID);
+		sfdp[3] = SFDP_1_0_PARAMETER_HEADER_DWORD_2(EMU_BFPT_OFFSET);
+	}
+
+	bfpt[0] = BFPT_1_0_DWORD_1(1, 1, 1, 0, 0, 1, 0x20, 1, 0, 1, 1);
+	bfpt[1] = BFPT_1_0_DWORD_2(0, EMU_CAPACITY * 8 - 1);
+	bfpt[7] = BFPT_1_0_DWORD_8(0x52, 15, 0x20, 12);
+	bfpt[8] = BFPT_1_0_DWORD_9(0, 0, 0xd8, 16);
+	if (minor_rev >= 5) {
+		/* 48ms, 128ms and 160ms typical, 6x for the maximum. */
+		bfpt[9] = BFPT_1_5_DWORD_10(0, 0, 1, 9, 1, 7, 1, 2, 2);
+		/* 2048ms typical chip erase and 256B pages. */
+		bfpt[10] = BFPT_1_5_DWORD_11(1, 7, 0, 0, 0, 0, 0, 0, 8, 0);
+	}
+}
+
+static void emu_reset(int sfdp_enabled, int sfdp_minor_rev)
+{
+	struct spi_nor_device_t *dev = &spi_nor_devices[0];
+
+	memset(emu.mem, 0xff, sizeof(emu.mem));
+	emu_set_sfdp(sfdp_enabled, sfdp_minor_rev);
+	emu.wel = 0;
+	emu.in_4b = 0;
+	emu.now_ns = 0;
+	emu.busy_until_ns = 0;
+	memset(emu.opcodes, 0, sizeof(emu.opcodes));
+	emu.errors = 0;
+
+	/* Return the device to its instantiated defaults. */
+	dev->capacity = EMU_CAPACITY;
+	dev->page_size = EMU_PAGE_SIZE;
+	dev->in_4b_addressing_mode = 0;
+	dev->fast_read = 0;
+	dev->read_modes = 0;
+	memset(dev->erase_types, 0, sizeof(dev->erase_types));
+	dev->chip_erase_timeout_usec = 0;
+}
+
+static uint32_t emu_addr(const uint8_t *txdata, int txlen, int *addr_len)
+{
+	*addr_len = emu.in_4b ? 4 : 3;
+	if (txlen < 1 + *addr_len) {
+		emu.errors++;
+		return 0;
+	}
+	if (emu.in_4b)
+		return txdata[1] << 24 | txdata[2] << 16 | txdata[3] << 8 |
+		       txdata[4];
+	return txdata[1] << 16 | txdata[2] << 8 | txdata[3];
+}
+
+static void emu_erase(const uint8_t *txdata, int txlen, uint32_t size,
+		      int erase_ms)
+{
+	int addr_len;
+	uint32_t offset = 0;
+
+	if (size != EMU_CAPACITY)
+		offset = emu_addr(txdata, txlen, &addr_len);
+	if (!emu.wel || offset & (size - 1) || offset + size > EMU_CAPACITY) {
+		emu.errors++;
+		return;
+	}
+	memset(&emu.mem[offset], 0xff, size);
+	emu.wel = 0;
+	emu.busy_until_ns = emu.now_ns + erase_ms * 1000000ULL;
+}
+
+int spi_transaction(const struct spi_device_t *spi_device,
+		    const uint8_t *txdata, int txlen, uint8_t *rxdata,
+		    int rxlen)
+{
+	uint8_t opcode = txdata[0];
+	uint32_t byte_ns =
+		8 * 1000000 / (EMU_CONTROLLER_SCLK_KHZ >> spi_device->div);
+	uint32_t offset;
+	int addr_len, i;
+
+	TEST_ASSERT(spi_device == &spi_devices[SPI_NOR_FLASH_DEVICE]);
+
+	emu.opcodes[opcode]++;
+	if (emu.now_ns < emu.busy_until_ns) {
+		/* Only the status register may be polled while busy. */
+		if (opcode != SPI_NOR_OPCODE_READ_STATUS)
+			emu.errors++;
+		emu.now_ns = emu.busy_until_ns;
+	}
+
+	switch (opcode) {
+	case SPI_NOR_OPCODE_READ_STATUS:
+		rxdata[0] = emu.wel ? SPI_NOR_STATUS_REGISTER_WEL : 0;
+		break;
+	case SPI_NOR_OPCODE_WRITE_ENABLE:
+		emu.wel = 1;
+		break;
+	case SPI_NOR_OPCODE_JEDEC_ID:
+		memset(rxdata, 0, rxlen);
+		rxdata[0] = 0xef;
+		break;
+	case SPI_NOR_OPCODE_SFDP:
+		offset = txdata[1] << 16 | txdata[2] << 8 | txdata[3];
+		for (i = 0; i < rxlen; i++)
+			rxdata[i] = offset + i < sizeof(emu.sfdp) ?
+					    ((uint8_t *)emu.sfdp)[offset + i] :
+					    0xff;
+		break;
+	case SPI_NOR_DRIVER_SPECIFIED_OPCODE_ENTER_4B:
+	case SPI_NOR_DRIVER_SPECIFIED_OPCODE_EXIT_4B:
+		emu.in_4b = opcode == SPI_NOR_DRIVER_SPECIFIED_OPCODE_ENTER_4B;
+		emu.wel = 0;
+		break;
+	case SPI_NOR_OPCODE_SLOW_READ:
+	case SPI_NOR_OPCODE_FAST_READ:
+		offset = emu_addr(txdata, txlen, &addr_len);
+		if (opcode == SPI_NOR_OPCODE_FAST_READ &&
+		    txlen != 1 + addr_len + 1)
+			emu.errors++;
+		for (i = 0; i < rxlen; i++)
+			rxdata[i] = emu.mem[(offset + i) % EMU_CAPACITY];
+		break;
+	case SPI_NOR_OPCODE_PAGE_PROGRAM:
+		offset = emu_addr(txdata, txlen, &addr_len);
+		if (!emu.wel) {
+			emu.errors++;
+			break;
+		}
+		/* Programming wraps around within the page and only clears
+		 * bits. */
+		for (i = 1 + addr_len; i < txlen; i++) {
+			emu.mem[offset] &= txdata[i];
+			offset = (offset & ~(EMU_PAGE_SIZE - 1)) |
+				 ((offset + 1) & (EMU_PAGE_SIZE - 1));
+		}
+		emu.wel = 0;
+		break;
+	case 0x20:
+		emu_erase(txdata, txlen, 4 * 1024, EMU_4KIB_ERASE_MS);
+		break;
+	case 0x52:
+		emu_erase(txdata, txlen, 32 * 1024, EMU_32KIB_ERASE_MS);
+		break;
+	case 0xd8:
+		emu_erase(txdata, txlen, 64 * 1024, EMU_64KIB_ERASE_MS);
+		break;
+	case SPI_NOR_OPCODE_CHIP_ERASE:
+		emu_erase(txdata, txlen, EMU_CAPACITY, EMU_CHIP_ERASE_MS);
+		break;
+	default:
+		emu.errors++;
+		break;
+	}
+
+	emu.now_ns += EMU_TRANSACTION_NS + (txlen + rxlen) * byte_ns;
+
+	return EC_SUCCESS;
+}
+
+/* Finish the last command and return the bus time so far. */
+static uint32_t emu_elapsed_us(void)
+{
+	return MAX(emu.now_ns, emu.busy_until_ns) / 1000;
+}
+
+static void emu_fill(uint32_t offset, size_t size)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		emu.mem[offset + i] = (offset + i) * 7 + 1;
+}
+
+static int check_erased(uint32_t start, uint32_t end)
+{
+	uint32_t i, mismatches = 0;
+
+	for (i = 0; i < EMU_CAPACITY; i++) {
+		uint8_t expected = 0xff;
+
+		if (i < start || i >= end)
+			expected = i * 7 + 1;
+		if (emu.mem[i] != expected)
+			mismatches++;
+	}
+	TEST_EQ(mismatches, 0, "%u");
+
+	return EC_SUCCESS;
+}
+
+/* Erase [start, end) after filling the part, returns the bus time in us. */
+static int erase_range(uint32_t start, uint32_t end, uint32_t *elapsed_us)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+
+	emu_fill(0, EMU_CAPACITY);
+	memset(emu.opcodes, 0, sizeof(emu.opcodes));
+	emu.now_ns = 0;
+	emu.busy_until_ns = 0;
+
+	TEST_EQ(spi_nor_erase(dev, start, end - start), EC_SUCCESS, "%d");
+	*elapsed_us = emu_elapsed_us();
+	TEST_EQ(emu.errors, 0, "%u");
+
+	return check_erased(start, end);
+}
+
+static int read_all(uint32_t *elapsed_us)
+{
+	static uint8_t data[EMU_CAPACITY];
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+
+	emu_fill(0, EMU_CAPACITY);
+	emu.now_ns = 0;
+	emu.busy_until_ns = 0;
+
+	TEST_EQ(spi_nor_read(dev, 0, sizeof(data), data), EC_SUCCESS, "%d");
+	*elapsed_us = emu_elapsed_us();
+	TEST_EQ(emu.errors, 0, "%u");
+	TEST_ASSERT_ARRAY_EQ(data, emu.mem, sizeof(data));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_no_sfdp_defaults(void)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+	uint32_t us;
+
+	emu_reset(0, 0);
+	spi_nor_init();
+	TEST_EQ(dev->fast_read, 0, "%d");
+	TEST_EQ(dev->erase_types[0].size_exp, 0, "%d");
+	TEST_EQ(dev->chip_erase_timeout_usec, 0, "%u");
+
+	TEST_EQ(read_all(&us), EC_SUCCESS, "%d");
+	TEST_EQ(emu.opcodes[SPI_NOR_OPCODE_SLOW_READ],
+		EMU_CAPACITY / CONFIG_SPI_NOR_MAX_READ_SIZE, "%u");
+
+	TEST_EQ(erase_range(0, EMU_CAPACITY, &us), EC_SUCCESS, "%d");
+	TEST_EQ(emu.opcodes[0x20], EMU_CAPACITY / 4096, "%u");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_sfdp_discovery(void)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+
+	emu_reset(1, 5);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+	TEST_EQ(dev->fast_read, 1, "%d");
+	TEST_EQ(dev->read_modes,
+		SPI_NOR_READ_MODE_1_1_2 | SPI_NOR_READ_MODE_1_2_2 |
+			SPI_NOR_READ_MODE_1_1_4 | SPI_NOR_READ_MODE_1_4_4,
+		"0x%x");
+
+	/* Sorted from the largest, with 6x the typical erase times. */
+	TEST_EQ(dev->erase_types[0].opcode, 0xd8, "0x%x");
+	TEST_EQ(dev->erase_types[0].size_exp, 16, "%d");
+	TEST_EQ(dev->erase_types[0].timeout_usec, 6 * 160 * MSEC, "%u");
+	TEST_EQ(dev->erase_types[1].opcode, 0x52, "0x%x");
+	TEST_EQ(dev->erase_types[1].size_exp, 15, "%d");
+	TEST_EQ(dev->erase_types[1].timeout_usec, 6 * 128 * MSEC, "%u");
+	TEST_EQ(dev->erase_types[2].opcode, 0x20, "0x%x");
+	TEST_EQ(dev->erase_types[2].size_exp, 12, "%d");
+	TEST_EQ(dev->erase_types[2].timeout_usec, 6 * 48 * MSEC, "%u");
+	TEST_EQ(dev->erase_types[3].size_exp, 0, "%d");
+	TEST_EQ(dev->chip_erase_timeout_usec, 6 * 2048 * MSEC, "%u");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_sfdp_1_0_keeps_4kib_erase(void)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+	uint32_t us;
+
+	/* Without erase times the larger types aren't safe to use. */
+	emu_reset(1, 0);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+	TEST_EQ(dev->fast_read, 1, "%d");
+	TEST_EQ(dev->erase_types[0].size_exp, 12, "%d");
+	TEST_EQ(dev->erase_types[1].size_exp, 0, "%d");
+	TEST_EQ(dev->chip_erase_timeout_usec, 0, "%u");
+
+	TEST_EQ(erase_range(0x10000, 0x30000, &us), EC_SUCCESS, "%d");
+	TEST_EQ(emu.opcodes[0x20], 0x20000 / 4096, "%u");
+	TEST_EQ(emu.opcodes[0xd8], 0, "%u");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_sfdp_rejects_oversized_erase(void)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+	uint32_t *bfpt = &emu.sfdp[EMU_BFPT_OFFSET / 4];
+
+	/* Erase type 4 claims 4GiB, which doesn't fit in BIT(size_exp). */
+	emu_reset(1, 5);
+	bfpt[8] = BFPT_1_0_DWORD_9(0xdc, 32, 0xd8, 16);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+	TEST_EQ(dev->erase_types[0].size_exp, 16, "%d");
+	TEST_EQ(dev->erase_types[1].size_exp, 15, "%d");
+	TEST_EQ(dev->erase_types[2].size_exp, 12, "%d");
+	TEST_EQ(dev->erase_types[3].size_exp, 0, "%d");
+
+	/* One past the limit is rejected too. */
+	emu_reset(1, 5);
+	bfpt[8] = BFPT_1_0_DWORD_9(0xdc, SPI_NOR_MAX_ERASE_SIZE_EXP + 1, 0xd8,
+				   16);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+	TEST_EQ(dev->erase_types[3].size_exp, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_erase_type_selection(void)
+{
+	uint32_t us;
+
+	emu_reset(1, 5);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+
+	/* 4KiB up to the 32KiB boundary, 32KiB up to the 64KiB one, 64KiB
+	 * through the middle and 4KiB for the tail. */
+	TEST_EQ(erase_range(0x3000, 0xf5000, &us), EC_SUCCESS, "%d");
+	TEST_EQ(emu.opcodes[0x20], 10, "%u");
+	TEST_EQ(emu.opcodes[0x52], 1, "%u");
+	TEST_EQ(emu.opcodes[0xd8], 14, "%u");
+	TEST_EQ(emu.opcodes[SPI_NOR_OPCODE_CHIP_ERASE], 0, "%u");
+
+	/* The whole part is a single chip erase. */
+	TEST_EQ(erase_range(0, EMU_CAPACITY, &us), EC_SUCCESS, "%d");
+	TEST_EQ(emu.opcodes[SPI_NOR_OPCODE_CHIP_ERASE], 1, "%u");
+	TEST_EQ(emu.opcodes[0x20] + emu.opcodes[0x52] + emu.opcodes[0xd8], 0,
+		"%u");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_write_read_back(void)
+{
+	const struct spi_nor_device_t *dev = &spi_nor_devices[0];
+	uint8_t data[1000], out[1000];
+	size_t i;
+
+	emu_reset(1, 5);
+	TEST_EQ(spi_nor_init(), EC_SUCCESS, "%d");
+
+	for (i = 0; i < sizeof(data); i++)
+		data[i] = i * 13;
+	TEST_EQ(spi_nor_write(dev, 0x1f0, sizeof(data), data), EC_SUCCESS,
+		"%d");
+	TEST_EQ(spi_nor_read(dev, 0x1f0, sizeof(out), out), EC_SUCCESS, "%d");
+	TEST_ASSERT_ARRAY_EQ(out, data, sizeof(data));
+	TEST_EQ(emu.opcodes[SPI_NOR_OPCODE_SLOW_READ], 0, "%u");
+	TEST_EQ(emu.errors, 0, "%u");
+
+	return EC_SUCCESS;
+}
+
+test_static int test_throughput_benchmark(void)
+{
+	uint32_t read_us[2], erase_us[2], chip_us[2];
+	int sfdp;
+
+	for (sfdp = 0; sfdp < 2; sfdp++) {
+		emu_reset(sfdp, 5);
+		spi_nor_init();
+		TEST_EQ(read_all(&read_us[sfdp]), EC_SUCCESS, "%d");
+		TEST_EQ(erase_range(0x3000, 0xf5000, &erase_us[sfdp]),
+			EC_SUCCESS, "%d");
+		TEST_EQ(erase_range(0, EMU_CAPACITY, &chip_us[sfdp]),
+			EC_SUCCESS, "%d");
+	}
+
+	ccprintf("1MiB read: %u us -> %u us\n", read_us[0], read_us[1]);
+	ccprintf("968KiB erase: %u us -> %u us\n", erase_us[0],
+		 erase_us[1]);
+	ccprintf("1MiB erase: %u us -> %u us\n", chip_us[0], chip_us[1]);
+
+	TEST_GE(erase_us[0], erase_us[1] * 3, "%u");
+	TEST_GE(chip_us[0], chip_us[1] * 3, "%u");
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_no_sfdp_defaults);
+	RUN_TEST(test_sfdp_discovery);
+	RUN_TEST(test_sfdp_1_0_keeps_4kib_erase);
+	RUN_TEST(test_sfdp_rejects_oversized_erase);
+	RUN_TEST(test_erase_type_selection);
+	RUN_TEST(test_write_read_back);
+	RUN_TEST(test_throughput_benchmark);
+
+	test_print_result();
+}
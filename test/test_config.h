@@ -182,9 +182,15 @@ enum battery_type {
 #define CONFIG_MKBP_USE_GPIO
 #endif
 
+#ifdef TEST_HOST_COMMAND
+#define CONFIG_HOSTCMD_INDEX
+#define CONFIG_CMD_HCSTATS
+#endif
+
 #ifdef TEST_RGB_KEYBOARD
 #define CONFIG_RGB_KEYBOARD
 #define CONFIG_RGBKBD_DEMO_DOT
+#define CONFIG_RGBKBD_BACK_BUFFER
 #endif
 
 #ifdef TEST_NVIDIA_GPU
@@ -273,11 +279,19 @@ enum sensor_id {
 #define CONFIG_BODY_DETECTION_SENSOR BASE
 #endif
 
+#ifdef TEST_CONSOLE_TOKENIZED
+#define CONFIG_CONSOLE_TOKENIZED
+#endif
+
 #ifdef TEST_CRC
 #define CONFIG_CRC8
 #define CONFIG_SW_CRC
 #endif
 
+#ifdef TEST_FLASH
+#define CONFIG_FLASH_WRITE_STREAM
+#endif
+
 #ifdef TEST_RSA
 #define CONFIG_RSA
 #ifdef CONFIG_RSA_EXPONENT_3
@@ -306,6 +320,16 @@ enum sensor_id {
 #define CONFIG_SHARED_MALLOC
 #endif
 
+#ifdef TEST_SPI_NOR
+#define CONFIG_CMD_SPI_NOR
+#define CONFIG_SPI_NOR
+#define CONFIG_SPI_NOR_MAX_MESSAGE_SIZE 264
+#define CONFIG_SPI_NOR_MAX_READ_SIZE 256
+#define CONFIG_SPI_NOR_MAX_WRITE_SIZE 256
+#define SPI_NOR_DEVICE_COUNT 1
+enum spi_device { SPI_FP_DEVICE, SPI_NOR_FLASH_DEVICE };
+#endif
+
 #ifdef TEST_SBS_CHARGING
 #define CONFIG_BATTERY
 #define CONFIG_BATTERY_V2
@@ -330,6 +354,7 @@ int board_discharge_on_ac(int enabled);
 
 #ifdef TEST_THERMAL
 #define CONFIG_CHIPSET_CAN_THROTTLE
+#define CONFIG_CMD_THERMALSTATS
 #define CONFIG_FANS 1
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
@@ -355,6 +380,7 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #ifdef TEST_BATTERY_GET_PARAMS_SMART
 #define CONFIG_BATTERY_MOCK
 #define CONFIG_BATTERY_SMART
+#define CONFIG_CMD_BATT_PARAMS_STATS
 #define CONFIG_CHARGER_DEFAULT_CURRENT_LIMIT 4032
 #define CONFIG_I2C
 #define CONFIG_I2C_CONTROLLER
@@ -370,6 +396,21 @@ int ncp15wb_calculate_temp(uint16_t adc);
 #define CONFIG_ALS_LIGHTBAR_DIMMING 0
 #endif
 
+#ifdef TEST_UART
+#define CONFIG_CONSOLE_LINE_STAGING 128
+#endif
+
+#ifdef TEST_USB_I2C
+#define CONFIG_USB_I2C
+#define USB_IFACE_I2C 0
+#define USB_EP_I2C 1
+#define USB_STR_I2C_NAME 0
+#undef CONFIG_USB_I2C_MAX_WRITE_COUNT
+#define CONFIG_USB_I2C_MAX_WRITE_COUNT ((1 << 8) - 4)
+#undef CONFIG_USB_I2C_MAX_READ_COUNT
+#define CONFIG_USB_I2C_MAX_READ_COUNT ((1 << 8) - 6)
+#endif
+
 #ifdef TEST_USB_COMMON
 #define CONFIG_USB_POWER_DELIVERY
 #define CONFIG_USB_PD_TCPMV1
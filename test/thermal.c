@@ -32,6 +32,7 @@ BUILD_ASSERT(EC_TEMP_THRESH_COUNT == 3);
 /* Mock functions */
 
 static int mock_temp[TEMP_SENSOR_COUNT];
+static int mock_period[TEMP_SENSOR_COUNT];
 static int host_throttled;
 static int cpu_throttled;
 static int cpu_shutdown;
@@ -73,6 +74,11 @@ void smi_sensor_failure_warning(void)
 	no_temps_read = 1;
 }
 
+int thermal_sensor_poll_period(int i)
+{
+	return mock_period[i];
+}
+
 /*****************************************************************************/
 /* Test utilities */
 
@@ -97,6 +103,9 @@ static void reset_mocks(void)
 	/* All sensors report error anyway */
 	set_temps(-1, -1, -1, -1);
 
+	/* Read every sensor on every pass */
+	memset(mock_period, 0, sizeof(mock_period));
+
 	/* Reset expectations */
 	host_throttled = 0;
 	cpu_throttled = 0;
@@ -482,6 +491,148 @@ static int test_several_limits(void)
 #define LOW_ADC_TEST_VALUE 887 /* 0 C */
 #define HIGH_ADC_TEST_VALUE 100 /* > 100C */
 
+static int test_params_change_without_temp_change(void)
+{
+	reset_mocks();
+
+	all_temps(150);
+	crec_sleep(2);
+	TEST_ASSERT(fan_pct == 0);
+
+	/* Unchanged readings must still pick up new thresholds. */
+	thermal_params[2].temp_fan_off = 100;
+	thermal_params[2].temp_fan_max = 200;
+	crec_sleep(2);
+	TEST_ASSERT(fan_pct == 50);
+
+	thermal_params[2].temp_host[EC_TEMP_THRESH_WARN] = 140;
+	crec_sleep(2);
+	TEST_ASSERT(host_throttled == 1);
+
+	thermal_params[2].temp_host[EC_TEMP_THRESH_WARN] = 0;
+	crec_sleep(2);
+	TEST_ASSERT(host_throttled == 0);
+
+	return EC_SUCCESS;
+}
+
+/* Get a value from captured thermalstats output, or -1 if it's missing. */
+static int get_thermalstat(const char *name)
+{
+	const char *line = strstr(test_get_captured_console(), name);
+
+	if (!line)
+		return -1;
+
+	return strtoi(line + strlen(name), NULL, 10);
+}
+
+static int test_thermalstats(void)
+{
+	char show[] = "thermalstats";
+	char clear[] = "thermalstats clear";
+	char bad[] = "thermalstats foo";
+	int runs, i;
+
+	reset_mocks();
+	all_temps(150);
+	crec_sleep(2);
+
+	thermal_params[1].temp_host[EC_TEMP_THRESH_WARN] = 155;
+	thermal_params[1].temp_host_release[EC_TEMP_THRESH_WARN] = 145;
+	crec_sleep(2);
+
+	/* Steady readings are read on every pass but not re-evaluated. */
+	TEST_EQ(test_send_console_command(clear), EC_SUCCESS, "%d");
+	crec_sleep(3);
+	test_capture_console(1);
+	TEST_EQ(test_send_console_command(show), EC_SUCCESS, "%d");
+	test_capture_console(0);
+	runs = get_thermalstat("runs:");
+	TEST_ASSERT(runs >= 2);
+	TEST_EQ(get_thermalstat("reads:"), runs * TEMP_SENSOR_COUNT, "%d");
+	TEST_EQ(get_thermalstat("evaluations:"), 0, "%d");
+	TEST_ASSERT(get_thermalstat("max us:") >=
+		    get_thermalstat("last us:"));
+
+	/* Noise between the limit and its release isn't re-evaluated. */
+	TEST_EQ(test_send_console_command(clear), EC_SUCCESS, "%d");
+	for (i = 0; i < 4; i++) {
+		mock_temp[1] = i & 1 ? 146 : 154;
+		crec_sleep(1);
+	}
+	test_capture_console(1);
+	TEST_EQ(test_send_console_command(show), EC_SUCCESS, "%d");
+	test_capture_console(0);
+	TEST_EQ(get_thermalstat("evaluations:"), 0, "%d");
+	TEST_ASSERT(host_throttled == 0);
+
+	/* Only the sensor whose reading crossed a limit is re-evaluated. */
+	TEST_EQ(test_send_console_command(clear), EC_SUCCESS, "%d");
+	mock_temp[1] = 160;
+	crec_sleep(3);
+	test_capture_console(1);
+	TEST_EQ(test_send_console_command(show), EC_SUCCESS, "%d");
+	test_capture_console(0);
+	runs = get_thermalstat("runs:");
+	TEST_ASSERT(runs >= 2);
+	TEST_EQ(get_thermalstat("reads:"), runs * TEMP_SENSOR_COUNT, "%d");
+	TEST_EQ(get_thermalstat("evaluations:"), 1, "%d");
+	TEST_ASSERT(host_throttled == 1);
+
+	TEST_EQ(test_send_console_command(bad), EC_ERROR_PARAM1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_poll_period(void)
+{
+	char show[] = "thermalstats";
+	char clear[] = "thermalstats clear";
+	int last_run = -1;
+	int slow_reads = 0;
+	int last_pct, runs, i;
+
+	reset_mocks();
+	all_temps(150);
+	crec_sleep(2);
+
+	/*
+	 * Sensor 1 is read every third second, the others every second. Only
+	 * sensor 1 drives the fan, and its reading changes every second, so
+	 * the fan follows it only when thermal control reads it.
+	 */
+	mock_period[1] = 3;
+	thermal_params[1].temp_fan_off = 100;
+	thermal_params[1].temp_fan_max = 200;
+	TEST_EQ(test_send_console_command(clear), EC_SUCCESS, "%d");
+	for (i = 0; i < 12; i++) {
+		mock_temp[1] = 110 + 5 * i;
+		last_pct = fan_pct;
+		crec_sleep(1);
+
+		/* New thresholds wait for the sensor's next read. */
+		if (fan_pct == last_pct)
+			continue;
+
+		TEST_EQ(fan_pct, 10 + 5 * i, "%d");
+		if (last_run >= 0)
+			TEST_EQ(i - last_run, 3, "%d");
+		last_run = i;
+		slow_reads++;
+	}
+	TEST_EQ(slow_reads, 4, "%d");
+
+	test_capture_console(1);
+	TEST_EQ(test_send_console_command(show), EC_SUCCESS, "%d");
+	test_capture_console(0);
+	runs = get_thermalstat("runs:");
+	TEST_EQ(get_thermalstat("reads:"),
+		runs * (TEMP_SENSOR_COUNT - 1) + slow_reads, "%d");
+
+	return EC_SUCCESS;
+}
+
 static int test_ncp15wb_adc_to_temp(void)
 {
 	int i;
@@ -635,6 +786,9 @@ void run_test(int argc, const char **argv)
 
 	RUN_TEST(test_one_limit);
 	RUN_TEST(test_several_limits);
+	RUN_TEST(test_params_change_without_temp_change);
+	RUN_TEST(test_thermalstats);
+	RUN_TEST(test_poll_period);
 
 	RUN_TEST(test_ncp15wb_adc_to_temp);
 	RUN_TEST(test_thermistor_linear_interpolate);
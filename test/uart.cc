@@ -8,10 +8,13 @@
  */
 
 #include "common.h"
+#include "console.h"
+#include "ec_commands.h"
 #include "test_util.h"
 #include "uart.h"
 
 #include <stddef.h>
+#include <string.h>
 
 test_static int test_uart_buffer_used(void)
 {
@@ -45,12 +48,123 @@ test_static int test_uart_buffer_empty(void)
 	return EC_SUCCESS;
 }
 
+test_static int test_uart_tx_span_raw(void)
+{
+	static char buf[CONFIG_UART_TX_BUF_SIZE + 16];
+	int written;
+	int used;
+	int i;
+
+	/*
+	 * Test output lands in the same buffer, so sample the counters before
+	 * checking them.
+	 */
+	memset(buf, 'b', sizeof(buf));
+	uart_flush_output();
+	written = uart_tx_span_raw(NULL, buf, 10);
+	used = uart_buffer_used();
+	TEST_EQ(written, 10, "%d");
+	TEST_EQ(used, 10, "%d");
+
+	/* Only what fits is taken, wrapping around the end of the buffer. */
+	for (i = 0; i < 2; i++) {
+		uart_flush_output();
+		written = uart_tx_span_raw(NULL, buf, sizeof(buf));
+		used = uart_buffer_used();
+		TEST_EQ(uart_tx_span_raw(NULL, buf, 1), 0, "%d");
+		uart_flush_output();
+		TEST_EQ(written, CONFIG_UART_TX_BUF_SIZE - 1, "%d");
+		TEST_EQ(used, CONFIG_UART_TX_BUF_SIZE - 1, "%d");
+	}
+
+	return EC_SUCCESS;
+}
+
+/* Read what was written since the previous call. */
+static void read_new_output(char *out, uint16_t size)
+{
+	uint16_t count = 0;
+
+	uart_console_read_buffer_init();
+	uart_console_read_buffer(CONSOLE_READ_RECENT, out, size, &count);
+}
+
+test_static int test_uart_tx_reserve(void)
+{
+	struct uart_tx_reservation a, b, big;
+	int rv_a, rv_b, rv_big;
+	int used_b, used_ab;
+	char out[32];
+
+	uart_flush_output();
+	read_new_output(out, sizeof(out));
+
+	rv_a = uart_tx_reserve(&a, 4);
+	rv_b = uart_tx_reserve(&b, 4);
+	rv_big = uart_tx_reserve(&big, CONFIG_UART_TX_BUF_SIZE);
+
+	/* b is committed first, but waits for a to become visible. */
+	uart_tx_fill(&b, 0, "bbbb", 4);
+	uart_tx_commit(&b);
+	used_b = uart_buffer_used();
+	uart_tx_fill(&a, 0, "aa", 2);
+	uart_tx_fill(&a, 2, "aa", 2);
+	uart_tx_commit(&a);
+	used_ab = uart_buffer_used();
+
+	read_new_output(out, sizeof(out));
+	uart_flush_output();
+
+	TEST_EQ(rv_a, EC_SUCCESS, "%d");
+	TEST_EQ(rv_b, EC_SUCCESS, "%d");
+	TEST_EQ(rv_big, EC_ERROR_OVERFLOW, "%d");
+	TEST_EQ(used_b, 0, "%d");
+	TEST_EQ(used_ab, 8, "%d");
+	TEST_ASSERT(!strcmp(out, "aaaabbbb"));
+
+	return EC_SUCCESS;
+}
+
+test_static int test_uart_put_line(void)
+{
+	static char buf[CONFIG_UART_TX_BUF_SIZE];
+	uint32_t drops;
+	int rv, rv_full;
+	char out[32];
+
+	memset(buf, 'b', sizeof(buf));
+	uart_flush_output();
+	read_new_output(out, sizeof(out));
+
+	rv = uart_put_line("x\ny\n", 4);
+	read_new_output(out, sizeof(out));
+	uart_flush_output();
+
+	TEST_EQ(rv, EC_SUCCESS, "%d");
+	TEST_ASSERT(!strcmp(out, "x\r\ny\r\n"));
+
+	/* A line that does not fit is dropped whole and counted. */
+	drops = console_channel_drops(CC_SYSTEM);
+	uart_tx_span_raw(NULL, buf, sizeof(buf) - 4);
+	rv_full = uart_put_line("x\ny\n", 4);
+	cprints(CC_SYSTEM, "dropped");
+	uart_flush_output();
+
+	TEST_EQ(rv_full, EC_ERROR_OVERFLOW, "%d");
+	TEST_EQ(console_channel_drops(CC_SYSTEM), drops + 1, "%u");
+
+	return EC_SUCCESS;
+}
+
 void run_test(int argc, const char **argv)
 {
 	test_reset();
 
 	RUN_TEST(test_uart_buffer_used);
 	RUN_TEST(test_uart_buffer_empty);
+	RUN_TEST(test_uart_tx_span_raw);
+	RUN_TEST(test_uart_tx_reserve);
+	RUN_TEST(test_uart_put_line);
 
 	test_print_result();
 }
@@ -0,0 +1,45 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef __CROS_EC_TEST_USB_STREAM_H
+#define __CROS_EC_TEST_USB_STREAM_H
+
+/* test/ is on the include path of every build; only tests may get this. */
+#ifndef TEST_BUILD
+#error "Fake USB stream is for host tests only"
+#endif
+
+#include "consumer.h"
+#include "producer.h"
+
+/* Fake USB stream for testing; tests access its queues directly. */
+
+struct usb_stream_config {
+	struct consumer consumer;
+	struct producer producer;
+};
+
+#define USB_STREAM_CONFIG_FULL(NAME, INTERFACE, INTERFACE_CLASS,           \
+			       INTERFACE_SUBCLASS, INTERFACE_PROTOCOL,     \
+			       INTERFACE_NAME, ENDPOINT, RX_SIZE, TX_SIZE, \
+			       RX_QUEUE, TX_QUEUE, RX_IDX, TX_IDX)         \
+	static const struct consumer_ops CONCAT2(NAME, _consumer_ops) = {  \
+		.written = NULL,                                           \
+	};                                                                 \
+	static const struct producer_ops CONCAT2(NAME, _producer_ops) = {  \
+		.read = NULL,                                              \
+	};                                                                 \
+	struct usb_stream_config const NAME = {                            \
+		.consumer = {                                              \
+			.queue = &TX_QUEUE,                                \
+			.ops = &CONCAT2(NAME, _consumer_ops),              \
+		},                                                         \
+		.producer = {                                              \
+			.queue = &RX_QUEUE,                                \
+			.ops = &CONCAT2(NAME, _producer_ops),              \
+		},                                                         \
+	};
+
+#endif /* __CROS_EC_TEST_USB_STREAM_H */
@@ -0,0 +1,478 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ *
+ * Test the USB to I2C bridge protocol against a mock I2C device.
+ */
+
+#include "common.h"
+#include "console.h"
+#include "hooks.h"
+#include "i2c.h"
+#include "queue.h"
+#include "queue_policies.h"
+#include "test_util.h"
+#include "timer.h"
+#include "usb_i2c.h"
+#include "util.h"
+
+#define DEV_ADDR_FLAGS 0x2a
+#define MISSING_ADDR_FLAGS 0x2b
+
+/* Time to wait for the bridge to respond before giving up. */
+#define RESPONSE_TIMEOUT_US (100 * MSEC)
+
+/*****************************************************************************/
+/* Mock I2C device: 256 byte register file with an auto-incremented pointer. */
+
+static uint8_t dev_regs[256];
+static uint8_t dev_ptr;
+static int dev_xfers;
+
+static int dev_xfer(const int port, const uint16_t addr_flags,
+		    const uint8_t *out, int out_size, uint8_t *in, int in_size,
+		    int flags)
+{
+	int i;
+
+	if (port != I2C_PORT_EEPROM || addr_flags != DEV_ADDR_FLAGS)
+		return EC_ERROR_INVAL;
+
+	dev_xfers++;
+	if (out_size) {
+		dev_ptr = out[0];
+		for (i = 1; i < out_size; i++)
+			dev_regs[dev_ptr++] = out[i];
+	}
+	for (i = 0; i < in_size; i++)
+		in[i] = dev_regs[dev_ptr++];
+
+	return EC_SUCCESS;
+}
+DECLARE_TEST_I2C_XFER(dev_xfer);
+
+/*****************************************************************************/
+/*
+ * The bridge in common/usb_i2c.c. test/usb-stream.h stands in for the USB
+ * endpoint, so the test reads and writes the bridge queues directly.
+ */
+extern struct usb_i2c_config const i2c;
+#define usb_to_bridge (*i2c.consumer.queue)
+#define bridge_to_usb (*i2c.tx_queue)
+
+static int bridge_enabled = 1;
+
+int usb_i2c_board_is_enabled(void)
+{
+	return bridge_enabled;
+}
+
+/* Number of requests sent and responses collected, i.e. USB transfers. */
+static int usb_packets;
+
+/*****************************************************************************/
+/* Host side helpers */
+
+static int build_header(uint8_t *pkt, int port, int addr, int wc, int rc)
+{
+	pkt[0] = ((wc >> 4) & 0xf0) | port;
+	pkt[1] = addr;
+	pkt[2] = wc & 0xff;
+	if (rc < 0x80) {
+		pkt[3] = rc;
+		return 4;
+	}
+	pkt[3] = 0x80 | (rc & 0x7f);
+	pkt[4] = rc >> 7;
+	pkt[5] = 0;
+	return 6;
+}
+
+/* A request that doesn't fit is dropped and its response times out. */
+static void send_request(const uint8_t *pkt, int len)
+{
+	queue_add_units(&usb_to_bridge, pkt, len);
+	usb_packets++;
+}
+
+static int get_response(uint8_t *resp, int len)
+{
+	timestamp_t deadline;
+
+	deadline.val = get_time().val + RESPONSE_TIMEOUT_US;
+	while (queue_count(&bridge_to_usb) < len) {
+		if (timestamp_expired(deadline, NULL))
+			return EC_ERROR_TIMEOUT;
+		crec_usleep(100);
+	}
+	queue_remove_units(&bridge_to_usb, resp, len);
+	usb_packets++;
+
+	return EC_SUCCESS;
+}
+
+static int status_of(const uint8_t *resp)
+{
+	return resp[0] | (resp[1] << 8);
+}
+
+/* Queue a single register read request. */
+static void send_read(uint8_t reg, int count)
+{
+	uint8_t pkt[8];
+	int len;
+
+	len = build_header(pkt, 0, DEV_ADDR_FLAGS, 1, count);
+	pkt[len++] = reg;
+	send_request(pkt, len);
+}
+
+/* Append a register read op to a batch. */
+static int add_read_op(uint8_t *op, uint8_t reg, int count)
+{
+	op[0] = 0;
+	op[1] = DEV_ADDR_FLAGS;
+	op[2] = 1;
+	op[3] = count;
+	op[4] = reg;
+	return 5;
+}
+
+static void reset_dev(void)
+{
+	int i;
+
+	for (i = 0; i < sizeof(dev_regs); i++)
+		dev_regs[i] = i ^ 0xa5;
+	dev_ptr = 0;
+	dev_xfers = 0;
+	bridge_enabled = 1;
+	usb_packets = 0;
+}
+
+/*****************************************************************************/
+/* Tests */
+
+static int test_single_transaction(void)
+{
+	uint8_t pkt[16];
+	uint8_t resp[8];
+	int len;
+
+	reset_dev();
+
+	/* Write two registers. */
+	len = build_header(pkt, 0, DEV_ADDR_FLAGS, 3, 0);
+	pkt[len++] = 0x20;
+	pkt[len++] = 0x11;
+	pkt[len++] = 0x22;
+	send_request(pkt, len);
+	TEST_EQ(get_response(resp, 4), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_SUCCESS, "%d");
+
+	/* And read them back. */
+	send_read(0x20, 2);
+	TEST_EQ(get_response(resp, 6), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_SUCCESS, "%d");
+	TEST_EQ(resp[4], 0x11, "0x%x");
+	TEST_EQ(resp[5], 0x22, "0x%x");
+
+	/* Transfers to an absent device report an error. */
+	len = build_header(pkt, 0, MISSING_ADDR_FLAGS, 0, 1);
+	send_request(pkt, len);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_NE(status_of(resp), USB_I2C_SUCCESS, "%d");
+
+	/* Bad ports are rejected. */
+	len = build_header(pkt, 0xf, DEV_ADDR_FLAGS, 1, 1);
+	pkt[len++] = 0;
+	send_request(pkt, len);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_PORT_INVALID, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch(void)
+{
+	uint8_t pkt[64];
+	uint8_t resp[16];
+	uint8_t *op;
+	int len;
+
+	reset_dev();
+
+	op = pkt + 4;
+	/* Write 0x30..0x31 */
+	op[0] = 0;
+	op[1] = DEV_ADDR_FLAGS;
+	op[2] = 3;
+	op[3] = 0;
+	op[4] = 0x30;
+	op[5] = 0xde;
+	op[6] = 0xad;
+	op += 7;
+	/* Empty op, skipped. */
+	memset(op, 0, 4);
+	op += 4;
+	/* Read 0x30..0x31 and 0x00 */
+	op += add_read_op(op, 0x30, 2);
+	op += add_read_op(op, 0x00, 1);
+
+	len = op - pkt - 4;
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, len, 3);
+	send_request(pkt, len + 4);
+
+	TEST_EQ(get_response(resp, 7), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_SUCCESS, "%d");
+	TEST_EQ(resp[2], 4, "%d");
+	TEST_EQ(resp[4], 0xde, "0x%x");
+	TEST_EQ(resp[5], 0xad, "0x%x");
+	TEST_EQ(resp[6], 0xa5, "0x%x");
+	TEST_EQ(dev_xfers, 3, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_extended_read(void)
+{
+	uint8_t pkt[32];
+	uint8_t resp[4 + 200];
+	uint8_t *op;
+	int hdr, len, i;
+
+	reset_dev();
+
+	/* Four 50 byte reads need the extended read count header. */
+	hdr = build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, 20, 200);
+	op = pkt + hdr;
+	for (i = 0; i < 4; i++)
+		op += add_read_op(op, i * 50, 50);
+	len = op - pkt;
+	TEST_EQ(len - hdr, 20, "%d");
+	send_request(pkt, len);
+
+	TEST_EQ(get_response(resp, sizeof(resp)), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_SUCCESS, "%d");
+	TEST_EQ(resp[2], 4, "%d");
+	for (i = 0; i < 200; i++)
+		TEST_EQ(resp[4 + i], i ^ 0xa5, "0x%x");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_stops_on_error(void)
+{
+	uint8_t pkt[32];
+	uint8_t resp[8];
+	uint8_t *op;
+	int len;
+
+	reset_dev();
+
+	op = pkt + 4;
+	op += add_read_op(op, 0x01, 1);
+	op += add_read_op(op, 0x02, 1);
+	op[-4] = MISSING_ADDR_FLAGS;
+	op += add_read_op(op, 0x03, 1);
+	len = op - pkt - 4;
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, len, 3);
+	send_request(pkt, len + 4);
+
+	TEST_EQ(get_response(resp, 7), EC_SUCCESS, "%d");
+	TEST_NE(status_of(resp), USB_I2C_SUCCESS, "%d");
+	/* Only the first op ran; the third one never reached the bus. */
+	TEST_EQ(resp[2], 1, "%d");
+	TEST_EQ(resp[4], 0x01 ^ 0xa5, "0x%x");
+	TEST_EQ(resp[5], 0, "%d");
+	TEST_EQ(dev_xfers, 1, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_batch_invalid(void)
+{
+	uint8_t pkt[32];
+	uint8_t resp[8];
+	uint8_t *op;
+	int len;
+
+	reset_dev();
+
+	/* Op read counts exceed the request read count. */
+	op = pkt + 4;
+	op += add_read_op(op, 0x01, 2);
+	len = op - pkt - 4;
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, len, 1);
+	send_request(pkt, len + 4);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_BATCH_INVALID, "%d");
+
+	/* Op write payload runs past the end of the request. */
+	op = pkt + 4;
+	op += add_read_op(op, 0x01, 1);
+	op[-3] = 4;
+	len = op - pkt - 4;
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, len, 1);
+	send_request(pkt, len + 4);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_BATCH_INVALID, "%d");
+
+	/* Truncated op header. */
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, 2, 0);
+	pkt[4] = 0;
+	pkt[5] = DEV_ADDR_FLAGS;
+	send_request(pkt, 6);
+	TEST_EQ(get_response(resp, 4), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_BATCH_INVALID, "%d");
+
+	/* Reserved port bits. */
+	op = pkt + 4;
+	op += add_read_op(op, 0x01, 1);
+	pkt[4] = 0x10;
+	build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, 5, 1);
+	send_request(pkt, 9);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_PORT_INVALID, "%d");
+
+	TEST_EQ(dev_xfers, 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_pipelined_requests(void)
+{
+	uint8_t resp[8];
+	int i;
+
+	reset_dev();
+
+	/* Queue several requests before collecting any response. */
+	for (i = 0; i < 4; i++)
+		send_read(0x40 + i, 1);
+
+	for (i = 0; i < 4; i++) {
+		TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+		TEST_EQ(status_of(resp), USB_I2C_SUCCESS, "%d");
+		TEST_EQ(resp[4], (0x40 + i) ^ 0xa5, "0x%x");
+	}
+	TEST_EQ((int)queue_count(&bridge_to_usb), 0, "%d");
+
+	return EC_SUCCESS;
+}
+
+static int test_pipelined_waits_for_tx_space(void)
+{
+	uint8_t resp[4 + 200];
+	uint8_t pkt[8];
+	int len;
+
+	reset_dev();
+
+	/* Two responses that don't fit in the transmit queue together. */
+	send_read(0x00, 200);
+	send_read(0x10, 200);
+
+	crec_msleep(5);
+	TEST_EQ(dev_xfers, 1, "%d");
+
+	TEST_EQ(get_response(resp, sizeof(resp)), EC_SUCCESS, "%d");
+	TEST_EQ(resp[4], 0x00 ^ 0xa5, "0x%x");
+	TEST_EQ(get_response(resp, sizeof(resp)), EC_SUCCESS, "%d");
+	TEST_EQ(resp[4], 0x10 ^ 0xa5, "0x%x");
+	TEST_EQ(dev_xfers, 2, "%d");
+
+	/* Disabled bridge still answers every request. */
+	bridge_enabled = 0;
+	len = build_header(pkt, 0, DEV_ADDR_FLAGS, 1, 1);
+	pkt[len++] = 0;
+	send_request(pkt, len);
+	TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+	TEST_EQ(status_of(resp), USB_I2C_DISABLED, "%d");
+
+	return EC_SUCCESS;
+}
+
+/*
+ * Read NUM_REGS registers one at a time with a round trip per read, with
+ * pipelined single requests, and with batches of BATCH_OPS reads.
+ */
+#define NUM_REGS 192
+#define BATCH_OPS 32
+
+static int test_benchmark(void)
+{
+	uint8_t pkt[4 + BATCH_OPS * 5];
+	uint8_t resp[4 + BATCH_OPS];
+	uint8_t *op;
+	timestamp_t start;
+	uint32_t single_us, pipelined_us, batch_us;
+	int single_packets, pipelined_packets, batch_packets;
+	int i, j;
+
+	reset_dev();
+	start = get_time();
+	for (i = 0; i < NUM_REGS; i++) {
+		send_read(i, 1);
+		TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+		TEST_EQ(resp[4], i ^ 0xa5, "0x%x");
+	}
+	single_us = time_since32(start);
+	single_packets = usb_packets;
+
+	reset_dev();
+	start = get_time();
+	for (i = 0; i < NUM_REGS; i += 8) {
+		for (j = 0; j < 8; j++)
+			send_read(i + j, 1);
+		for (j = 0; j < 8; j++) {
+			TEST_EQ(get_response(resp, 5), EC_SUCCESS, "%d");
+			TEST_EQ(resp[4], (i + j) ^ 0xa5, "0x%x");
+		}
+	}
+	pipelined_us = time_since32(start);
+	pipelined_packets = usb_packets;
+
+	reset_dev();
+	start = get_time();
+	for (i = 0; i < NUM_REGS; i += BATCH_OPS) {
+		op = pkt + 4;
+		for (j = 0; j < BATCH_OPS; j++)
+			op += add_read_op(op, i + j, 1);
+		build_header(pkt, 0, USB_I2C_MULTI_ADDR_FLAGS, op - pkt - 4,
+			     BATCH_OPS);
+		send_request(pkt, op - pkt);
+		TEST_EQ(get_response(resp, sizeof(resp)), EC_SUCCESS, "%d");
+		TEST_EQ(resp[2], BATCH_OPS, "%d");
+		for (j = 0; j < BATCH_OPS; j++)
+			TEST_EQ(resp[4 + j], (i + j) ^ 0xa5, "0x%x");
+	}
+	batch_us = time_since32(start);
+	batch_packets = usb_packets;
+
+	TEST_EQ(dev_xfers, NUM_REGS, "%d");
+	TEST_LT(batch_packets, single_packets, "%d");
+
+	ccprintf("%d reads: single %d packets %d us, pipelined %d packets "
+		 "%d us, batched %d packets %d us\n",
+		 NUM_REGS, single_packets, single_us, pipelined_packets,
+		 pipelined_us, batch_packets, batch_us);
+
+	return EC_SUCCESS;
+}
+
+void run_test(int argc, const char **argv)
+{
+	test_reset();
+
+	RUN_TEST(test_single_transaction);
+	RUN_TEST(test_batch);
+	RUN_TEST(test_batch_extended_read);
+	RUN_TEST(test_batch_stops_on_error);
+	RUN_TEST(test_batch_invalid);
+	RUN_TEST(test_pipelined_requests);
+	RUN_TEST(test_pipelined_waits_for_tx_space);
+	RUN_TEST(test_benchmark);
+
+	test_print_result();
+}
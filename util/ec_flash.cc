@@ -4,6 +4,7 @@
  */
 
 #include "comm-host.h"
+#include "crc.h"
 #include "misc_util.h"
 #include "timer.h"
 
@@ -19,6 +20,9 @@
 static const auto ERASE_ASYNC_TIMEOUT = std::chrono::seconds(10);
 static const auto ERASE_ASYNC_WAIT_MS = std::chrono::milliseconds(500);
 static const int FLASH_ERASE_BUSY_RV = -EECRESULT - EC_RES_BUSY;
+static const auto WRITE_STREAM_TIMEOUT = std::chrono::seconds(10);
+static const auto WRITE_STREAM_WAIT_MS = std::chrono::milliseconds(1);
+static const int FLASH_WRITE_STREAM_BUSY_RV = -EECRESULT - EC_RES_BUSY;
 
 int ec_flash_read(uint8_t *buf, int offset, int size)
 {
@@ -139,6 +143,83 @@ static int get_flash_write_size(void)
 	return write_size;
 }
 
+/**
+ * Send one EC_CMD_FLASH_WRITE_STREAM subcommand, retrying while the EC
+ * reports that its buffers are still being programmed.
+ *
+ * @return Zero or positive on success, negative on failure
+ */
+static int flash_write_stream_cmd(struct ec_params_flash_write_stream *p,
+				  int size,
+				  struct ec_response_flash_write_stream *r)
+{
+	auto timeout = std::chrono::milliseconds(0);
+	int rv;
+
+	while (true) {
+		rv = ec_command(EC_CMD_FLASH_WRITE_STREAM, 0, p, size, r,
+				sizeof(*r));
+		if (rv != FLASH_WRITE_STREAM_BUSY_RV ||
+		    timeout >= WRITE_STREAM_TIMEOUT)
+			return rv;
+
+		std::this_thread::sleep_for(WRITE_STREAM_WAIT_MS);
+		timeout += WRITE_STREAM_WAIT_MS;
+	}
+}
+
+static int ec_flash_write_stream(const uint8_t *buf, int offset, int size)
+{
+	struct ec_params_flash_write_stream *p =
+		(struct ec_params_flash_write_stream *)ec_outbuf;
+	struct ec_response_flash_write_stream r;
+	uint32_t crc;
+	int step;
+	int rv;
+	int i;
+
+	memset(p, 0, sizeof(*p));
+	p->cmd = FLASH_WRITE_STREAM_START;
+	p->offset = offset;
+	p->size = size;
+	rv = flash_write_stream_cmd(p, sizeof(*p), &r);
+	if (rv < 0) {
+		fprintf(stderr, "Unable to start write stream\n");
+		return rv;
+	}
+
+	step = MIN((int)(ec_max_outsize - sizeof(*p)), r.buf_size);
+	printf("Stream write size %d...\n", step);
+
+	crc32_ctx_init(&crc);
+	p->cmd = FLASH_WRITE_STREAM_DATA;
+	for (i = 0; i < size; i += step) {
+		p->offset = i;
+		p->size = MIN(size - i, step);
+		memcpy(p->data, buf + i, p->size);
+		crc32_ctx_hash(&crc, buf + i, p->size);
+		rv = flash_write_stream_cmd(p, sizeof(*p) + p->size, &r);
+		if (rv < 0) {
+			fprintf(stderr, "Write error at offset %d\n", i);
+			goto abort;
+		}
+	}
+
+	p->cmd = FLASH_WRITE_STREAM_DONE;
+	p->offset = 0;
+	p->size = 0;
+	p->crc32 = crc32_ctx_result(&crc);
+	rv = flash_write_stream_cmd(p, sizeof(*p), &r);
+	if (rv < 0)
+		fprintf(stderr, "Write stream failed to complete\n");
+	return rv;
+
+abort:
+	p->cmd = FLASH_WRITE_STREAM_ABORT;
+	flash_write_stream_cmd(p, sizeof(*p), &r);
+	return rv;
+}
+
 int ec_flash_write(const uint8_t *buf, int offset, int size)
 {
 	struct ec_params_flash_write *p =
@@ -167,6 +248,13 @@ int ec_flash_write(const uint8_t *buf, int offset, int size)
 	if (write_size == 0)
 		return -1;
 
+	/*
+	 * Prefer the streaming protocol, which lets the EC program one buffer
+	 * while we send the next one.
+	 */
+	if (ec_cmd_version_supported(EC_CMD_FLASH_WRITE_STREAM, 0))
+		return ec_flash_write_stream(buf, offset, size);
+
 	step = (pdata_max_size / write_size) * write_size;
 
 	if (!step) {
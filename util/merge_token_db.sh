@@ -7,6 +7,9 @@ DATABASE="database.bin"
 OUTFILE="build/tokens.bin"
 PW_ROOT="../../third_party/pigweed"
 
-find build -name "${DATABASE}" -print0 | xargs -0 \
+# Zephyr builds generate ${DATABASE}; legacy builds with
+# CONFIG_CONSOLE_TOKENIZED keep the token entries in their ELF files.
+find build \( -name "${DATABASE}" -o -name "ec.RO.elf" -o -name "ec.RW.elf" \) \
+  -print0 | xargs -0 \
   "${PW_ROOT}"/pw_tokenizer/py/pw_tokenizer/database.py \
   create --type binary --force --database "${OUTFILE}"
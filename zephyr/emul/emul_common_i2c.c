@@ -9,8 +9,11 @@
 #include <zephyr/drivers/emul.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 
+#include <string.h>
+
 #define LOG_LEVEL CONFIG_I2C_LOG_LEVEL
 LOG_MODULE_REGISTER(emul_common_i2c);
 
@@ -268,6 +271,82 @@ static int i2c_common_emul_read_byte(const struct emul *target,
 	return 0;
 }
 
+#ifdef CONFIG_EMUL_COMMON_I2C_TIMING
+/** Get the speed of the bus the emulator is on, in Hz */
+static uint32_t i2c_common_emul_bus_hz(struct i2c_common_emul_data *data)
+{
+	uint32_t config;
+
+	if (data->i2c == NULL || i2c_get_config(data->i2c, &config)) {
+		return CONFIG_EMUL_COMMON_I2C_TIMING_DEFAULT_HZ;
+	}
+
+	switch (I2C_SPEED_GET(config)) {
+	case I2C_SPEED_STANDARD:
+		return I2C_BITRATE_STANDARD;
+	case I2C_SPEED_FAST:
+		return I2C_BITRATE_FAST;
+	case I2C_SPEED_FAST_PLUS:
+		return I2C_BITRATE_FAST_PLUS;
+	case I2C_SPEED_HIGH:
+		return I2C_BITRATE_HIGH;
+	case I2C_SPEED_ULTRA:
+		return I2C_BITRATE_ULTRA;
+	default:
+		return CONFIG_EMUL_COMMON_I2C_TIMING_DEFAULT_HZ;
+	}
+}
+
+/**
+ * Get the time a transfer keeps the bus busy, in ns.
+ *
+ * START, repeated START and STOP conditions take one bit time each. The
+ * address and each data byte take nine bit times, including the ACK.
+ */
+static uint64_t i2c_common_emul_bus_ns(struct i2c_common_emul_data *data,
+				       const struct i2c_msg *msgs,
+				       int num_msgs)
+{
+	uint32_t bit_ns = NSEC_PER_SEC / i2c_common_emul_bus_hz(data);
+	bool addressed = false;
+	uint64_t ns = 0;
+
+	for (int i = 0; i < num_msgs; i++) {
+		if (!addressed || (msgs[i].flags & I2C_MSG_RESTART)) {
+			ns += 10 * bit_ns;
+			if (msgs[i].flags & I2C_MSG_READ) {
+				ns += data->stretch_read_ns;
+			}
+			addressed = true;
+		}
+
+		ns += (uint64_t)msgs[i].len * (9 * bit_ns +
+					       data->stretch_byte_ns);
+
+		if (msgs[i].flags & I2C_MSG_STOP) {
+			ns += bit_ns;
+			addressed = false;
+		}
+	}
+
+	return ns;
+}
+
+/** Advance the time by the bus time of a transfer */
+static void i2c_common_emul_bus_wait(struct i2c_common_emul_data *data,
+				     const struct i2c_msg *msgs, int num_msgs)
+{
+	uint64_t ns = i2c_common_emul_bus_ns(data, msgs, num_msgs);
+
+	data->stats.bus_ns += ns;
+
+	/* Keep the part below 1 us for the next transfer */
+	ns += data->wait_rem_ns;
+	data->wait_rem_ns = ns % NSEC_PER_USEC;
+	k_busy_wait(ns / NSEC_PER_USEC);
+}
+#endif /* CONFIG_EMUL_COMMON_I2C_TIMING */
+
 /** Check description in emul_common_i2c.h */
 int i2c_common_emul_transfer_workhorse(const struct emul *target,
 				       struct i2c_common_emul_data *data,
@@ -286,6 +365,20 @@ int i2c_common_emul_transfer_workhorse(const struct emul *target,
 
 	i2c_dump_msgs(target->dev, msgs, num_msgs, addr);
 
+	data->stats.transfers++;
+	data->stats.msgs += num_msgs;
+	for (i = 0; i < num_msgs; i++) {
+		if (msgs[i].flags & I2C_MSG_READ) {
+			data->stats.bytes_read += msgs[i].len;
+		} else {
+			data->stats.bytes_written += msgs[i].len;
+		}
+	}
+
+#ifdef CONFIG_EMUL_COMMON_I2C_TIMING
+	i2c_common_emul_bus_wait(data, msgs, num_msgs);
+#endif
+
 	for (; num_msgs > 0; num_msgs--, msgs++) {
 		read = msgs->flags & I2C_MSG_READ;
 		stop = msgs->flags & I2C_MSG_STOP;
@@ -430,9 +523,35 @@ void i2c_common_emul_init(struct i2c_common_emul_data *data)
 	data->write_fail_reg = I2C_COMMON_EMUL_NO_FAIL_REG;
 	data->read_fail_reg = I2C_COMMON_EMUL_NO_FAIL_REG;
 
+	memset(&data->stats, 0, sizeof(data->stats));
+	data->stretch_byte_ns = 0;
+	data->stretch_read_ns = 0;
+	data->wait_rem_ns = 0;
+
 	k_mutex_init(&data->data_mtx);
 }
 
+/** Check description in emul_common_i2c.h */
+void i2c_common_emul_get_stats(struct i2c_common_emul_data *common_data,
+			       struct i2c_common_emul_stats *stats)
+{
+	*stats = common_data->stats;
+}
+
+/** Check description in emul_common_i2c.h */
+void i2c_common_emul_set_clock_stretch(struct i2c_common_emul_data *common_data,
+				       uint32_t byte_ns, uint32_t read_ns)
+{
+	common_data->stretch_byte_ns = byte_ns;
+	common_data->stretch_read_ns = read_ns;
+}
+
+/** Check description in emul_common_i2c.h */
+void i2c_common_emul_reset_stats(struct i2c_common_emul_data *common_data)
+{
+	memset(&common_data->stats, 0, sizeof(common_data->stats));
+}
+
 struct i2c_emul_api i2c_common_emul_api = {
 	.transfer = i2c_common_emul_transfer,
 };
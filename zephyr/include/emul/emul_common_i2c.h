@@ -222,6 +222,23 @@ struct i2c_common_emul_cfg {
 	uint16_t addr;
 };
 
+/** Transfer counters of the emulator, see @ref i2c_common_emul_get_stats */
+struct i2c_common_emul_stats {
+	/** Number of I2C transfers addressed to the emulator */
+	uint32_t transfers;
+	/** Number of I2C messages in those transfers */
+	uint32_t msgs;
+	/** Number of bytes written to the emulator */
+	uint32_t bytes_written;
+	/** Number of bytes read from the emulator */
+	uint32_t bytes_read;
+	/**
+	 * Time the transfers kept the bus busy, in ns. Only counted with
+	 * CONFIG_EMUL_COMMON_I2C_TIMING.
+	 */
+	uint64_t bus_ns;
+};
+
 /** Run-time data used by the emulator, common for all i2c emulators */
 struct i2c_common_emul_data {
 	/** I2C emulator detail */
@@ -274,6 +291,16 @@ struct i2c_common_emul_data {
 
 	/** Mutex used to control access to emulator data */
 	struct k_mutex data_mtx;
+
+	/** Transfer counters, cleared on init */
+	struct i2c_common_emul_stats stats;
+
+	/** Clock stretching after each byte, in ns */
+	uint32_t stretch_byte_ns;
+	/** Clock stretching before the first byte of a read, in ns */
+	uint32_t stretch_read_ns;
+	/** Bus time not yet waited for, below 1 us */
+	uint32_t wait_rem_ns;
 };
 
 /** A common API that simply links to the i2c_common_emul_transfer function */
@@ -343,6 +370,40 @@ void i2c_common_emul_set_read_fail_reg(struct i2c_common_emul_data *common_data,
 void i2c_common_emul_set_write_fail_reg(
 	struct i2c_common_emul_data *common_data, int reg);
 
+/**
+ * @brief Get transfer counters of emulator
+ *
+ * Every transfer addressed to the emulator is counted, including the ones
+ * which fail on a register selected by the user.
+ *
+ * @param common_data Pointer to emulator common data
+ * @param stats Pointer where counters are copied
+ */
+void i2c_common_emul_get_stats(struct i2c_common_emul_data *common_data,
+			       struct i2c_common_emul_stats *stats);
+
+/**
+ * @brief Clear transfer counters of emulator
+ *
+ * @param common_data Pointer to emulator common data
+ */
+void i2c_common_emul_reset_stats(struct i2c_common_emul_data *common_data);
+
+/**
+ * @brief Set clock stretching of emulator
+ *
+ * Only used by the bus timing model, see CONFIG_EMUL_COMMON_I2C_TIMING.
+ * Slow targets, like smart batteries, hold the clock low while they prepare
+ * data.
+ *
+ * @param common_data Pointer to emulator common data
+ * @param byte_ns Time the clock is held after each data byte, in ns
+ * @param read_ns Time the clock is held before the first byte of each read
+ *                message, in ns
+ */
+void i2c_common_emul_set_clock_stretch(struct i2c_common_emul_data *common_data,
+				       uint32_t byte_ns, uint32_t read_ns);
+
 /**
  * @biref Emulate an I2C transfer to an emulator
  *
@@ -458,6 +458,52 @@ void pdc_power_mgmt_notify_event(int port, atomic_t event_mask);
  */
 int pdc_power_mgmt_set_comms_state(bool run);
 
+/**
+ * @brief Coherent copy of a port's connection state
+ *
+ * The PDC power management thread refreshes the snapshot whenever the port's
+ * state changes, so reading it never sends a command to the PDC.
+ */
+struct pdc_port_snapshot_t {
+	/** Incremented each time the snapshot changes */
+	uint32_t generation;
+	/** A port partner is attached */
+	bool connected;
+	/** The attached port partner is PD capable */
+	bool pd_capable;
+	/** Attached as a PD sink, so src_cap_cnt and src_caps are valid */
+	bool snk_attached;
+	/** Current power role */
+	enum pd_power_role power_role;
+	/** Current data role, PD_ROLE_DISCONNECTED if not attached */
+	enum pd_data_role data_role;
+	/** CC polarity of the connection */
+	enum tcpc_cc_polarity polarity;
+	/** Last UCSI connector status read from the PDC */
+	union connector_status_t connector_status;
+	/** Last UCSI cable property read from the PDC */
+	union cable_property_t cable_prop;
+	/** Negotiated RDO once running as a PD sink, else 0 */
+	uint32_t rdo;
+	/** Number of valid entries in src_caps */
+	uint8_t src_cap_cnt;
+	/** Partner SRC CAPs while attached as a sink */
+	uint32_t src_caps[PDO_MAX_OBJECTS];
+};
+
+/**
+ * @brief Read a coherent snapshot of a port's connection state
+ *
+ * Never blocks and never sends a command to the PDC. Callers that poll can
+ * compare the generation field to detect changes.
+ *
+ * @param port USB-C port number
+ * @param snapshot Output variable to store the snapshot
+ *
+ * @retval 0 if successful or error code
+ */
+int pdc_power_mgmt_get_snapshot(int port, struct pdc_port_snapshot_t *snapshot);
+
 /**
  * @brief Return the current UCSI connector status on a port
  *
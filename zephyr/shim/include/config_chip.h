@@ -143,6 +143,14 @@ extern "C" {
 #define CONFIG_FLASH_DEFERRED_ERASE
 #endif
 
+#undef CONFIG_FLASH_WRITE_STREAM
+#undef CONFIG_FLASH_WRITE_STREAM_BUF_SIZE
+#ifdef CONFIG_PLATFORM_EC_FLASH_WRITE_STREAM
+#define CONFIG_FLASH_WRITE_STREAM
+#define CONFIG_FLASH_WRITE_STREAM_BUF_SIZE \
+	CONFIG_PLATFORM_EC_FLASH_WRITE_STREAM_BUF_SIZE
+#endif
+
 #undef CONFIG_THROTTLE_AP
 #ifdef CONFIG_PLATFORM_EC_THROTTLE_AP
 #define CONFIG_THROTTLE_AP
@@ -301,6 +309,17 @@ extern "C" {
 	CONFIG_PLATFORM_EC_CHARGER_MIN_BAT_PCT_IMBALANCED_POWER_ON
 #endif
 
+#undef CONFIG_BATTERY_SLOW_PARAMS_INTERVAL_SEC
+#ifdef CONFIG_PLATFORM_EC_BATTERY_SLOW_PARAMS_INTERVAL_SEC
+#define CONFIG_BATTERY_SLOW_PARAMS_INTERVAL_SEC \
+	CONFIG_PLATFORM_EC_BATTERY_SLOW_PARAMS_INTERVAL_SEC
+#endif
+
+#undef CONFIG_CMD_BATT_PARAMS_STATS
+#ifdef CONFIG_PLATFORM_EC_CONSOLE_CMD_BATT_PARAMS_STATS
+#define CONFIG_CMD_BATT_PARAMS_STATS
+#endif
+
 #undef CONFIG_BATTERY_STBL_STAT
 #ifdef CONFIG_PLATFORM_EC_BATTERY_STBL_STAT
 #define CONFIG_BATTERY_STBL_STAT
@@ -733,6 +752,11 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_TEMP_SENSOR
 #endif
 
+#undef CONFIG_CMD_THERMALSTATS
+#ifdef CONFIG_PLATFORM_EC_CONSOLE_CMD_THERMALSTATS
+#define CONFIG_CMD_THERMALSTATS
+#endif
+
 #undef CONFIG_TEMP_SENSOR_POWER
 #ifdef CONFIG_PLATFORM_EC_TEMP_SENSOR_POWER
 #define CONFIG_TEMP_SENSOR_POWER
@@ -877,6 +901,16 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_KEYBOARD_KEYPAD
 #endif
 
+#undef CONFIG_RGBKBD_MAX_FPS
+#ifdef CONFIG_PLATFORM_EC_RGBKBD_MAX_FPS
+#define CONFIG_RGBKBD_MAX_FPS CONFIG_PLATFORM_EC_RGBKBD_MAX_FPS
+#endif
+
+#undef CONFIG_RGBKBD_BACK_BUFFER
+#ifdef CONFIG_PLATFORM_EC_RGBKBD_BACK_BUFFER
+#define CONFIG_RGBKBD_BACK_BUFFER
+#endif
+
 #undef CONFIG_KEYBOARD_COLS
 #ifdef CONFIG_PLATFORM_EC_KEYBOARD_COLS
 #define CONFIG_KEYBOARD_COLS CONFIG_PLATFORM_EC_KEYBOARD_COLS
@@ -1261,6 +1295,12 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_CHARGER_SENSE_RESISTOR_AC 10
 #endif /* CONFIG_PLATFORM_EC_CHARGE_MANAGER */
 
+#undef CONFIG_CHARGE_MANAGER_REFRESH_DELAY_MS
+#ifdef CONFIG_PLATFORM_EC_CHARGE_MANAGER_REFRESH_DELAY_MS
+#define CONFIG_CHARGE_MANAGER_REFRESH_DELAY_MS \
+	CONFIG_PLATFORM_EC_CHARGE_MANAGER_REFRESH_DELAY_MS
+#endif
+
 #undef CONFIG_CHARGER
 #ifdef CONFIG_PLATFORM_EC_CHARGER
 #define CONFIG_CHARGER
@@ -2296,6 +2336,11 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_CMD_HCDEBUG
 #endif
 
+#undef CONFIG_CMD_HCSTATS
+#ifdef CONFIG_PLATFORM_EC_CONSOLE_CMD_HCSTATS
+#define CONFIG_CMD_HCSTATS
+#endif
+
 #undef CONFIG_CMD_POWERINDEBUG
 #ifdef CONFIG_PLATFORM_EC_CMD_POWERINDEBUG
 #define CONFIG_CMD_POWERINDEBUG
@@ -2387,6 +2432,12 @@ extern char mock_jump_data[CONFIG_PLATFORM_EC_PRESERVED_END_OF_RAM_SIZE];
 #define CONFIG_ACCEL_FIFO_THRES CONFIG_PLATFORM_EC_ACCEL_FIFO_THRES
 #endif /* CONFIG_PLATFORM_EC_ACCEL_FIFO */
 
+#undef CONFIG_ONLINE_CALIB_BATCH_SIZE
+#ifdef CONFIG_PLATFORM_EC_ONLINE_CALIB_BATCH_SIZE
+#define CONFIG_ONLINE_CALIB_BATCH_SIZE \
+	CONFIG_PLATFORM_EC_ONLINE_CALIB_BATCH_SIZE
+#endif
+
 #undef CONFIG_BODY_DETECTION
 #undef CONFIG_BODY_DETECTION_SENSOR
 #undef CONFIG_BODY_DETECTION_MAX_WINDOW_SIZE
@@ -3276,6 +3327,13 @@ BUILD_ASSERT((DT_NUM_INST_STATUS_OKAY(mps_mp2964)) == 1,
 #define CONFIG_HOSTCMD_DEBUG_MODE CONFIG_PLATFORM_EC_HOSTCMD_DEBUG_MODE
 #endif
 
+#undef CONFIG_HOSTCMD_INDEX
+#undef CONFIG_HOSTCMD_INDEX_SIZE
+#ifdef CONFIG_PLATFORM_EC_HOSTCMD_INDEX
+#define CONFIG_HOSTCMD_INDEX
+#define CONFIG_HOSTCMD_INDEX_SIZE CONFIG_PLATFORM_EC_HOSTCMD_INDEX_SIZE
+#endif
+
 #undef CONFIG_AMD_SB_RMI
 #ifdef CONFIG_PLATFORM_EC_AMD_SB_RMI
 #define CONFIG_AMD_SB_RMI
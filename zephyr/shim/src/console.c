@@ -408,6 +408,19 @@ int uart_tx_char_raw(void *context, int c)
 	return 0;
 }
 
+int uart_tx_span_raw(void *context, const char *s, int len)
+{
+	int i;
+
+	for (i = 0; i < len; i++)
+		uart_poll_out(uart_shell_dev, s[i]);
+
+	if (IS_ENABLED(CONFIG_PLATFORM_EC_HOSTCMD_CONSOLE) && !k_is_in_isr())
+		console_buf_notify_chars(s, len);
+
+	return len;
+}
+
 void uart_write_char(char c)
 {
 	uart_poll_out(uart_shell_dev, c);
@@ -25,3 +25,18 @@ uint16_t cros_crc16(const uint8_t *data, int len, uint16_t previous_crc)
 {
 	return crc16_itu_t(previous_crc, data, len);
 }
+
+void crc32_ctx_init(uint32_t *crc)
+{
+	*crc = 0;
+}
+
+void crc32_ctx_hash(uint32_t *crc, const void *buf, int size)
+{
+	*crc = crc32_ieee_update(*crc, buf, size);
+}
+
+uint32_t crc32_ctx_result(uint32_t *crc)
+{
+	return *crc;
+}
@@ -99,6 +99,20 @@ struct host_command *zephyr_find_host_command(int command)
 	return NULL;
 }
 
+struct host_command *zephyr_get_host_command(int i)
+{
+	struct host_command *cmd;
+	int count;
+
+	STRUCT_SECTION_COUNT(host_command, &count);
+	if (i < 0 || i >= count)
+		return NULL;
+
+	STRUCT_SECTION_GET(host_command, i, &cmd);
+
+	return cmd;
+}
+
 #ifdef CONFIG_EC_HOST_CMD
 static void ec_host_cmd_user_cb(const struct ec_host_cmd_rx_ctx *rx_ctx,
 				void *user_data)
@@ -60,6 +60,10 @@ static int thermistor_get_temp(const struct temp_sensor_t *sensor,
 }
 #endif
 
+/* Read period in seconds for thermal control; 0 reads every second */
+#define TEMP_SENSOR_POLL_PERIOD(named_id) \
+	DT_PROP_OR(named_id, poll_period_s, 0)
+
 #define GET_THERMISTOR_DATUM(node_sample_id)                                 \
 	[DT_PROP(node_sample_id,                                             \
 		 sample_index)] = { .mv = DT_PROP(node_sample_id, milivolt), \
@@ -91,6 +95,7 @@ static int thermistor_get_temp(const struct temp_sensor_t *sensor,
 		.name = DT_NODE_FULL_NAME(sensor_id),                        \
 		.idx = ZSHIM_ADC_ID(DT_PHANDLE(sensor_id, adc)),             \
 		.type = TEMP_SENSOR_TYPE_BOARD,                              \
+		.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),          \
 		.zephyr_info = GET_ZEPHYR_TEMP_SENSOR_THERMISTOR(named_id,   \
 								 sensor_id), \
 	}
@@ -127,6 +132,7 @@ __maybe_unused static int pct2075_get_temp(const struct temp_sensor_t *sensor,
 		.name = DT_NODE_FULL_NAME(sensor_id),                    \
 		.idx = PCT2075_SENSOR_ID(sensor_id),                     \
 		.type = TEMP_SENSOR_TYPE_BOARD,                          \
+		.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),      \
 		.zephyr_info = GET_ZEPHYR_TEMP_SENSOR_PCT2075(named_id), \
 	}
 
@@ -162,6 +168,7 @@ __maybe_unused static int sb_tsi_get_temp(const struct temp_sensor_t *sensor,
 		.name = DT_NODE_FULL_NAME(sensor_id),                   \
 		.idx = 0,                                               \
 		.type = TEMP_SENSOR_TYPE_CPU,                           \
+		.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),     \
 		.zephyr_info = GET_ZEPHYR_TEMP_SENSOR_SB_TSI(named_id), \
 	}
 
@@ -194,6 +201,7 @@ __maybe_unused static int tmp112_get_temp(const struct temp_sensor_t *sensor,
 		.name = DT_NODE_FULL_NAME(sensor_id),                   \
 		.idx = TMP112_SENSOR_ID(sensor_id),                     \
 		.type = TEMP_SENSOR_TYPE_BOARD,                         \
+		.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),     \
 		.zephyr_info = GET_ZEPHYR_TEMP_SENSOR_TMP112(named_id), \
 	}
 
@@ -230,6 +238,7 @@ __maybe_unused static int f75303_get_temp(const struct temp_sensor_t *sensor,
 		.name = DT_NODE_FULL_NAME(sensor_id),                       \
 		.idx = F75303_SENSOR_ID(sensor_id),                         \
 		.type = TEMP_SENSOR_TYPE_BOARD,                             \
+		.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),         \
 		.zephyr_info =                                              \
 			GET_ZEPHYR_TEMP_SENSOR_F75303(named_id, sensor_id), \
 	}
@@ -260,6 +269,7 @@ const struct f75303_sensor_t f75303_sensors[F75303_IDX_COUNT] = {
 			.name = DT_NODE_FULL_NAME(sensor_id),                  \
 			.idx = 0,                                              \
 			.type = TEMP_SENSOR_TYPE_BOARD,                        \
+			.poll_period_s = TEMP_SENSOR_POLL_PERIOD(named_id),    \
 			.zephyr_info = GET_ZEPHYR_TEMP_SENSOR_RT9490(named_id, \
 				       sensor_id),                             \
 		} ), ())
@@ -4,6 +4,7 @@
  */
 
 #include "ap_pwrseq_drv_sm.h"
+#include "ap_pwrseq_profile.h"
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
@@ -69,6 +70,9 @@ static const char *const ap_pwrseq_state_str[AP_POWER_STATE_COUNT] = {
 		AP_PWRSEQ_EACH_SUB_STATE_STR_DEF_NODE_CHILD_DEFINE)
 };
 BUILD_ASSERT(ARRAY_SIZE(ap_pwrseq_state_str) == AP_POWER_STATE_COUNT);
+BUILD_ASSERT(!IS_ENABLED(CONFIG_AP_PWRSEQ_PROFILE) ||
+		     AP_POWER_STATE_COUNT <= AP_PWRSEQ_PROFILE_MAX_STATES,
+	     "AP_PWRSEQ_PROFILE_MAX_STATES is too small for the power states");
 
 static struct ap_pwrseq_data ap_pwrseq_task_data;
 
@@ -191,6 +195,7 @@ static void ap_pwrseq_thread(void *arg, void *unused1, void *unused2)
 			}
 			LOG_INF("%s -> %s", ap_pwrseq_get_state_str(cur_state),
 				ap_pwrseq_get_state_str(new_state));
+			ap_pwrseq_profile_enter_state(new_state);
 
 			ap_pwrseq_send_exit_callback(dev, new_state, cur_state);
 
@@ -242,6 +247,8 @@ int ap_pwrseq_start(const struct device *dev, enum ap_pwrseq_state init_state)
 		return ret;
 	}
 
+	ap_pwrseq_profile_enter_state(init_state);
+
 	k_thread_start(ap_pwrseq_tid);
 
 	return 0;
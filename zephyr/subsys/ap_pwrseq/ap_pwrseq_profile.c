@@ -0,0 +1,221 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#include "ap_pwrseq_profile.h"
+#include "ec_commands.h"
+#include "host_command.h"
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/linker/section_tags.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+
+#include <string.h>
+
+LOG_MODULE_DECLARE(ap_pwrseq, CONFIG_AP_PWRSEQ_LOG_LEVEL);
+
+BUILD_ASSERT(POWER_SIGNAL_COUNT <= 32, "Too many power signals");
+
+/* "PSPF" */
+#define PROFILE_MAGIC 0x50535046
+
+struct profile_hist {
+	uint32_t count;
+	uint32_t total_ms;
+	uint32_t max_ms;
+	uint32_t last_ms;
+	uint16_t histogram[EC_AP_PWRSEQ_PROFILE_BUCKETS];
+};
+
+struct profile_state {
+	struct profile_hist residency;
+	uint32_t last_entry_ms;
+	uint32_t wait_ms;
+	uint32_t slowest_wait_ms;
+	uint32_t slowest_signal;
+};
+
+struct pwrseq_profile {
+	uint32_t magic;
+	uint32_t boots;
+	struct profile_state states[AP_PWRSEQ_PROFILE_MAX_STATES];
+	struct profile_hist signals[POWER_SIGNAL_COUNT];
+	/* Must be last. */
+	uint32_t checksum;
+};
+
+/*
+ * The profile lives in RAM that isn't cleared on reset so that it
+ * accumulates across EC boots. It is validated with the checksum on init.
+ */
+static struct pwrseq_profile profile __noinit;
+static K_MUTEX_DEFINE(profile_lock);
+
+/* The state being timed and when it was entered, in ms of uptime. */
+static int cur_state = -1;
+static int64_t cur_entry_ms;
+
+static uint32_t profile_checksum(void)
+{
+	const uint32_t *word = (const uint32_t *)&profile;
+	uint32_t sum = 0;
+
+	for (size_t i = 0; i < offsetof(struct pwrseq_profile, checksum) / 4;
+	     i++) {
+		sum = ((sum << 1) | (sum >> 31)) ^ word[i];
+	}
+	return sum;
+}
+
+static void profile_clear(void)
+{
+	memset(&profile, 0, sizeof(profile));
+	profile.magic = PROFILE_MAGIC;
+}
+
+static void hist_add(struct profile_hist *hist, uint32_t ms)
+{
+	int bucket = MIN(find_msb_set(ms), EC_AP_PWRSEQ_PROFILE_BUCKETS - 1);
+
+	hist->count++;
+	hist->total_ms += ms;
+	hist->max_ms = MAX(hist->max_ms, ms);
+	hist->last_ms = ms;
+	if (hist->histogram[bucket] < UINT16_MAX) {
+		hist->histogram[bucket]++;
+	}
+}
+
+static bool state_is_profiled(int state)
+{
+	return state >= 0 && state < AP_PWRSEQ_PROFILE_MAX_STATES;
+}
+
+void ap_pwrseq_profile_enter_state(int state)
+{
+	int64_t now = k_uptime_get();
+
+	k_mutex_lock(&profile_lock, K_FOREVER);
+	if (state_is_profiled(cur_state)) {
+		hist_add(&profile.states[cur_state].residency,
+			 now - cur_entry_ms);
+	}
+	if (state_is_profiled(state)) {
+		profile.states[state].last_entry_ms = now;
+	}
+	cur_state = state;
+	cur_entry_ms = now;
+	profile.checksum = profile_checksum();
+	k_mutex_unlock(&profile_lock);
+}
+
+void ap_pwrseq_profile_signal_wait(power_signal_mask_t signals,
+				   uint32_t wait_ms)
+{
+	struct profile_state *state;
+
+	if (signals == 0) {
+		return;
+	}
+
+	k_mutex_lock(&profile_lock, K_FOREVER);
+	for (int i = 0; i < POWER_SIGNAL_COUNT; i++) {
+		if (signals & POWER_SIGNAL_MASK(i)) {
+			hist_add(&profile.signals[i], wait_ms);
+		}
+	}
+	if (state_is_profiled(cur_state)) {
+		state = &profile.states[cur_state];
+		state->wait_ms += wait_ms;
+		if (wait_ms >= state->slowest_wait_ms) {
+			state->slowest_wait_ms = wait_ms;
+			state->slowest_signal = find_lsb_set(signals) - 1;
+		}
+	}
+	profile.checksum = profile_checksum();
+	k_mutex_unlock(&profile_lock);
+}
+
+static int ap_pwrseq_profile_init(void)
+{
+	if (profile.magic != PROFILE_MAGIC ||
+	    profile.checksum != profile_checksum()) {
+		profile_clear();
+	}
+	profile.boots++;
+	profile.checksum = profile_checksum();
+
+	LOG_DBG("Power sequence profile over %d boots", profile.boots);
+	return 0;
+}
+SYS_INIT(ap_pwrseq_profile_init, APPLICATION, 0);
+
+static void copy_hist(struct ec_response_ap_pwrseq_profile *r,
+		      const struct profile_hist *hist)
+{
+	r->count = hist->count;
+	r->total_ms = hist->total_ms;
+	r->max_ms = hist->max_ms;
+	r->last_ms = hist->last_ms;
+	memcpy(r->histogram, hist->histogram, sizeof(r->histogram));
+}
+
+static enum ec_status
+host_command_ap_pwrseq_profile(struct host_cmd_handler_args *args)
+{
+	const struct ec_params_ap_pwrseq_profile *p = args->params;
+	struct ec_response_ap_pwrseq_profile *r = args->response;
+	const struct profile_state *state;
+	enum ec_status ret = EC_RES_SUCCESS;
+
+	memset(r, 0, sizeof(*r));
+
+	k_mutex_lock(&profile_lock, K_FOREVER);
+	r->boots = profile.boots;
+	r->num_states = AP_PWRSEQ_PROFILE_MAX_STATES;
+	r->num_signals = POWER_SIGNAL_COUNT;
+
+	switch (p->cmd) {
+	case EC_AP_PWRSEQ_PROFILE_GET_STATE:
+		if (p->index >= AP_PWRSEQ_PROFILE_MAX_STATES) {
+			ret = EC_RES_INVALID_PARAM;
+			break;
+		}
+		state = &profile.states[p->index];
+		copy_hist(r, &state->residency);
+		r->last_entry_ms = state->last_entry_ms;
+		r->wait_ms = state->wait_ms;
+		r->slowest_wait_ms = state->slowest_wait_ms;
+		r->slowest_signal = state->slowest_signal;
+		break;
+
+	case EC_AP_PWRSEQ_PROFILE_GET_SIGNAL:
+		if (p->index >= POWER_SIGNAL_COUNT) {
+			ret = EC_RES_INVALID_PARAM;
+			break;
+		}
+		copy_hist(r, &profile.signals[p->index]);
+		break;
+
+	case EC_AP_PWRSEQ_PROFILE_CLEAR:
+		profile_clear();
+		profile.checksum = profile_checksum();
+		r->boots = 0;
+		break;
+
+	default:
+		ret = EC_RES_INVALID_PARAM;
+		break;
+	}
+	k_mutex_unlock(&profile_lock);
+
+	if (ret == EC_RES_SUCCESS) {
+		args->response_size = sizeof(*r);
+	}
+	return ret;
+}
+DECLARE_HOST_COMMAND(EC_CMD_AP_PWRSEQ_PROFILE, host_command_ap_pwrseq_profile,
+		     EC_VER_MASK(0));
@@ -0,0 +1,50 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+#ifndef __AP_PWRSEQ_PROFILE_H__
+#define __AP_PWRSEQ_PROFILE_H__
+
+#include "power_signals.h"
+
+#include <stdint.h>
+
+/*
+ * Number of power states the profile has room for. Both state machines check
+ * at build time that all their states fit.
+ */
+#define AP_PWRSEQ_PROFILE_MAX_STATES 24
+
+#ifdef CONFIG_AP_PWRSEQ_PROFILE
+/**
+ * @brief Record entry into a power state.
+ *
+ * Closes the residency of the previous state and starts timing the new one.
+ *
+ * @param state The power state number being entered.
+ */
+void ap_pwrseq_profile_enter_state(int state);
+
+/**
+ * @brief Record a wait on power signals.
+ *
+ * The wait is accounted to each signal in the mask and to the current state.
+ *
+ * @param signals Mask of the signals that had to change.
+ * @param wait_ms Time spent waiting, in ms.
+ */
+void ap_pwrseq_profile_signal_wait(power_signal_mask_t signals,
+				   uint32_t wait_ms);
+#else
+static inline void ap_pwrseq_profile_enter_state(int state)
+{
+}
+
+static inline void ap_pwrseq_profile_signal_wait(power_signal_mask_t signals,
+						 uint32_t wait_ms)
+{
+}
+#endif /* CONFIG_AP_PWRSEQ_PROFILE */
+
+#endif /* __AP_PWRSEQ_PROFILE_H__ */
@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "ap_pwrseq_profile.h"
 #include "common.h"
 #include "signal_adc.h"
 #include "signal_gpio.h"
@@ -89,6 +90,19 @@ static const struct ps_config sig_config[] = {
 static const uint8_t polled_signals[] = { DT_FOREACH_STATUS_OKAY(
 	intel_ap_pwrseq_external, PWR_SIGNAL_POLLED) };
 
+#define PWR_SIGNAL_POLLED_MASK(id) POWER_SIGNAL_MASK(PWR_SIGNAL_ENUM(id)) |
+
+static const power_signal_mask_t polled_mask =
+	DT_FOREACH_STATUS_OKAY(intel_ap_pwrseq_external,
+			       PWR_SIGNAL_POLLED_MASK) 0;
+
+/*
+ * One event per signal, posted whenever the signal is updated by an
+ * interrupt or an output is set. Waiters clear the events they are
+ * interested in before checking the signals, so a change can't be missed.
+ */
+K_EVENT_DEFINE(power_signal_events);
+
 /*
  * Bitmasks of power signals. A previous copy is held so that
  * logging of changes can occur if the signal is in the debug mask.
@@ -143,6 +157,7 @@ test_mockable void power_signal_interrupt(enum power_signal signal, int value)
 {
 	atomic_set_bit_to(&power_signals, signal, value);
 	check_debug(signal);
+	k_event_post(&power_signal_events, POWER_SIGNAL_MASK(signal));
 	ap_pwrseq_wake();
 }
 #else
@@ -152,26 +167,73 @@ test_mockable void power_signal_interrupt(enum power_signal signal, int value)
 
 	atomic_set_bit_to(&power_signals, signal, value);
 	check_debug(signal);
+	k_event_post(&power_signal_events, POWER_SIGNAL_MASK(signal));
 	if (!IS_ENABLED(CONFIG_EMUL_AP_PWRSEQ_DRIVER)) {
 		ap_pwrseq_post_event(ap_pwrseq_dev,
 				     AP_PWRSEQ_EVENT_POWER_SIGNAL);
 	}
 }
 #endif
-test_mockable int power_wait_mask_signals_timeout(power_signal_mask_t mask,
-						  power_signal_mask_t want,
-						  int timeout)
+
+static int wait_mask_signals_timeout(power_signal_mask_t mask,
+				     power_signal_mask_t want, int timeout)
 {
-	want &= mask;
-	while (timeout-- > 0) {
+	int64_t deadline;
+
+	/*
+	 * Polled signals don't raise an event when they change, so these
+	 * have to be sampled.
+	 */
+	if (mask & polled_mask) {
+		while (timeout-- > 0) {
+			if ((power_get_signals() & mask) == want) {
+				return 0;
+			}
+			k_msleep(1);
+		}
+		return -ETIMEDOUT;
+	}
+
+	/*
+	 * All the signals are updated from interrupts, so sleep until
+	 * one of them changes instead of polling.
+	 */
+	deadline = k_uptime_get() + timeout;
+	while (timeout > 0) {
+		k_event_clear(&power_signal_events, mask);
 		if ((power_get_signals() & mask) == want) {
 			return 0;
 		}
-		k_msleep(1);
+		k_event_wait(&power_signal_events, mask, false,
+			     K_MSEC(timeout));
+		timeout = deadline - k_uptime_get();
 	}
 	return -ETIMEDOUT;
 }
 
+test_mockable int power_wait_mask_signals_timeout(power_signal_mask_t mask,
+						  power_signal_mask_t want,
+						  int timeout)
+{
+	power_signal_mask_t waiting;
+	int64_t start;
+	int ret;
+
+	want &= mask;
+
+	if (!IS_ENABLED(CONFIG_AP_PWRSEQ_PROFILE)) {
+		return wait_mask_signals_timeout(mask, want, timeout);
+	}
+
+	/* Profile the wait against the signals that have to change. */
+	waiting = (power_get_signals() ^ want) & mask;
+	start = k_uptime_get();
+	ret = wait_mask_signals_timeout(mask, want, timeout);
+	ap_pwrseq_profile_signal_wait(waiting, k_uptime_get() - start);
+
+	return ret;
+}
+
 test_mockable int power_signal_get(enum power_signal signal)
 {
 	const struct ps_config *cp;
@@ -238,6 +300,7 @@ test_mockable int power_signal_set(enum power_signal signal, int value)
 	if (ret == 0) {
 		atomic_set_bit_to(&power_signals, signal, value);
 		check_debug(signal);
+		k_event_post(&power_signal_events, POWER_SIGNAL_MASK(signal));
 	}
 	return ret;
 }
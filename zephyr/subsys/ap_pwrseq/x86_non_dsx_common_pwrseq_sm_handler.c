@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "ap_pwrseq_profile.h"
 #include "ap_reset_log.h"
 #include "system_boot_time.h"
 #include "zephyr_console_shim.h"
@@ -76,6 +77,9 @@ static const char *const pwrsm_dbg[] = {
 	[SYS_POWER_STATE_S0S0ix] = "S0S0ix",
 #endif
 };
+BUILD_ASSERT(!IS_ENABLED(CONFIG_AP_PWRSEQ_PROFILE) ||
+		     ARRAY_SIZE(pwrsm_dbg) <= AP_PWRSEQ_PROFILE_MAX_STATES,
+	     "AP_PWRSEQ_PROFILE_MAX_STATES is too small for the power states");
 #else
 static void x86_non_dsx_timer_handler(struct k_timer *timer);
 
@@ -136,6 +140,7 @@ void pwr_sm_set_state(enum power_states_ndsx new_state)
 		pwr_sm_get_state_name(pwrseq_ctx.power_state),
 		pwr_sm_get_state_name(new_state));
 	pwrseq_ctx.power_state = new_state;
+	ap_pwrseq_profile_enter_state(new_state);
 }
 
 void ap_pwrseq_wake(void)
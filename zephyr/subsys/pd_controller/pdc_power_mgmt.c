@@ -26,6 +26,7 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/smf.h>
 #include <zephyr/sys/atomic.h>
+#include <zephyr/sys/barrier.h>
 #include <zephyr/sys_clock.h>
 
 #ifdef CONFIG_ZTEST
@@ -393,6 +394,7 @@ test_export_static const char *const pdc_cmd_names[] = {
 const int pdc_cmd_types = CMD_PDC_COUNT;
 
 BUILD_ASSERT(ARRAY_SIZE(pdc_cmd_names) == CMD_PDC_COUNT);
+BUILD_ASSERT(PDO_NUM <= PDO_MAX_OBJECTS);
 
 /**
  * @brief State Machine State Names
@@ -645,6 +647,10 @@ struct pdc_port_t {
 	enum src_attached_local_state_t src_attached_local_state;
 	/** State machine run event */
 	struct k_event sm_event;
+#ifdef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
+	/** Uptime (ms) at which the PDC thread next polls this port */
+	int64_t next_run_ms;
+#endif
 
 	/** Transitioning from last_state */
 	enum pdc_state_t last_state;
@@ -744,16 +750,24 @@ struct pdc_port_t {
 	bool frs_enable;
 	/** Store response to the GET_ATTENTION_VDO command */
 	union get_attention_vdo_t attention_vdo;
+	/** Connection state snapshots, the current one is snapshot[gen & 1] */
+	struct pdc_port_snapshot_t snapshot[2];
+	/** Generation of the current snapshot */
+	atomic_t snapshot_gen;
+	/** Snapshot generation + 1 at which SOP discovery was complete */
+	atomic_t disc_complete_gen;
 };
 
 /**
  * @brief Subsystem PDC Data
  */
 struct pdc_data_t {
+#ifndef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
 	/** This port's thread */
 	k_tid_t thread;
 	/** This port thread's data */
 	struct k_thread thread_data;
+#endif
 	/** Port data */
 	struct pdc_port_t port;
 };
@@ -766,7 +780,7 @@ struct pdc_config_t {
 	uint8_t connector_num;
 	/**
 	 * The usbc stack initializes this pointer that creates the
-	 * main thread for this port
+	 * main thread for this port. NULL when all ports share one thread.
 	 */
 	void (*create_thread)(const struct device *dev);
 };
@@ -867,6 +881,26 @@ static bool should_suspend(struct pdc_port_t *port)
 	__builtin_unreachable();
 }
 
+/**
+ * @brief Run one pass of a port's state machine
+ */
+static void pdc_run_port(struct pdc_port_t *port)
+{
+	if (should_suspend(port)) {
+		set_pdc_state(port, PDC_SUSPENDED);
+	}
+
+	/* Run port connection state machine */
+	smf_run_state(&port->ctx);
+
+	refresh_port_snapshot(port);
+}
+
+#ifdef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
+/* All ports are run by pdc_mgr_thread */
+#define PDC_THREAD_DEFINE(inst)
+#define PDC_THREAD_CREATE(inst) NULL
+#else
 /**
  * @brief PDC thread
  */
@@ -894,16 +928,11 @@ static ALWAYS_INLINE void pdc_thread(void *pdc_dev, void *unused1,
 			k_event_clear(&port->sm_event, PDC_SM_EVENT);
 		}
 
-		if (should_suspend(port)) {
-			set_pdc_state(port, PDC_SUSPENDED);
-		}
-
-		/* Run port connection state machine */
-		smf_run_state(&port->ctx);
+		pdc_run_port(port);
 	}
 }
 
-#define PDC_SUBSYS_INIT(inst)                                                \
+#define PDC_THREAD_DEFINE(inst)                                              \
 	K_THREAD_STACK_DEFINE(my_stack_area_##inst,                          \
 			      CONFIG_PDC_POWER_MGMT_STACK_SIZE);             \
                                                                              \
@@ -919,7 +948,12 @@ static ALWAYS_INLINE void pdc_thread(void *pdc_dev, void *unused1,
 			K_NO_WAIT);                                          \
 		k_thread_name_set(data->thread,                              \
 				  "PDC Power Mgmt" STRINGIFY(inst));         \
-	}                                                                    \
+	}
+#define PDC_THREAD_CREATE(inst) create_thread_##inst
+#endif /* CONFIG_PDC_POWER_MGMT_SINGLE_THREAD */
+
+#define PDC_SUBSYS_INIT(inst)                                                \
+	PDC_THREAD_DEFINE(inst)                                              \
                                                                              \
 	static struct pdc_data_t data_##inst = {                             \
 		.port.dev = DEVICE_DT_INST_GET(inst), /* Initial policy read \
@@ -937,7 +971,7 @@ static ALWAYS_INLINE void pdc_thread(void *pdc_dev, void *unused1,
                                                                              \
 	static struct pdc_config_t config_##inst = {                         \
 		.connector_num = USBC_PORT_NEW(DT_DRV_INST(inst)),           \
-		.create_thread = create_thread_##inst,                       \
+		.create_thread = PDC_THREAD_CREATE(inst),                    \
 	};                                                                   \
                                                                              \
 	DEVICE_DT_INST_DEFINE(inst, &pdc_subsys_init, NULL, &data_##inst,    \
@@ -955,6 +989,176 @@ DT_INST_FOREACH_STATUS_OKAY(PDC_SUBSYS_INIT)
 static struct pdc_data_t *pdc_data[] = { DT_INST_FOREACH_STATUS_OKAY(
 	PDC_DATA_INIT) };
 
+#ifdef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
+/**
+ * @brief Ports that have been woken. Bit N is set for connector N.
+ */
+K_EVENT_DEFINE(pdc_mgr_event);
+#endif
+
+/**
+ * @brief Wake the thread running the port's state machine
+ */
+static void pdc_sm_wake(struct pdc_port_t *port)
+{
+#ifdef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
+	const struct pdc_config_t *const config = port->dev->config;
+
+	k_event_post(&pdc_mgr_event, BIT(config->connector_num));
+#else
+	k_event_post(&port->sm_event, PDC_SM_EVENT);
+#endif
+}
+
+#ifdef CONFIG_PDC_POWER_MGMT_SINGLE_THREAD
+static bool atomic_bits_clear(const atomic_t *target, size_t words)
+{
+	for (size_t i = 0; i < words; i++) {
+		if (atomic_get(&target[i])) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Check whether a port has settled with no work outstanding, so that
+ *        it doesn't need to run again until pdc_sm_wake() is called.
+ */
+static bool pdc_port_is_idle(struct pdc_port_t *port)
+{
+	switch (get_pdc_state(port)) {
+	case PDC_UNATTACHED:
+		if (port->unattached_local_state != UNATTACHED_RUN) {
+			return false;
+		}
+		break;
+	case PDC_SNK_ATTACHED:
+		if (port->snk_attached_local_state != SNK_ATTACHED_RUN) {
+			return false;
+		}
+		break;
+	case PDC_SRC_ATTACHED:
+		if (port->src_attached_local_state != SRC_ATTACHED_RUN) {
+			return false;
+		}
+		break;
+	case PDC_SNK_TYPEC_ONLY:
+		if (port->snk_typec_attached_local_state !=
+		    SNK_TYPEC_ATTACHED_RUN) {
+			return false;
+		}
+		break;
+	case PDC_SRC_TYPEC_ONLY:
+		if (port->src_typec_attached_local_state !=
+		    SRC_TYPEC_ATTACHED_RUN) {
+			return false;
+		}
+		break;
+	case PDC_SUSPENDED:
+		/* Only a resume request moves the port out of suspend */
+		return atomic_get(&port->suspend);
+	default:
+		return false;
+	}
+
+	if (atomic_get(&port->suspend) || atomic_get(&port->hard_reset_sent)) {
+		return false;
+	}
+
+	if (port->send_cmd.public.pending || port->send_cmd.intern.pending) {
+		return false;
+	}
+
+	return atomic_bits_clear(port->cci_flags,
+				 ARRAY_SIZE(port->cci_flags)) &&
+	       atomic_bits_clear(port->una_policy.flags,
+				 ARRAY_SIZE(port->una_policy.flags)) &&
+	       atomic_bits_clear(port->snk_policy.flags,
+				 ARRAY_SIZE(port->snk_policy.flags)) &&
+	       atomic_bits_clear(port->src_policy.flags,
+				 ARRAY_SIZE(port->src_policy.flags));
+}
+
+/**
+ * @brief Get the uptime at which a port must be run again if it isn't woken
+ *        first, or INT64_MAX if it only needs to run when woken.
+ */
+static int64_t pdc_port_next_run(struct pdc_port_t *port, int64_t now)
+{
+	enum pdc_state_t state = get_pdc_state(port);
+	uint32_t remaining_ms;
+
+	if (pdc_port_is_idle(port)) {
+		return INT64_MAX;
+	}
+
+	/* Type-C only debounce has nothing to do until the timer expires */
+	if ((state == PDC_SNK_TYPEC_ONLY &&
+	     port->snk_typec_attached_local_state ==
+		     SNK_TYPEC_ATTACHED_DEBOUNCE) ||
+	    (state == PDC_SRC_TYPEC_ONLY &&
+	     port->src_typec_attached_local_state ==
+		     SRC_TYPEC_ATTACHED_DEBOUNCE)) {
+		remaining_ms = k_timer_remaining_get(&port->typec_only_timer);
+		if (remaining_ms > LOOP_DELAY_MS) {
+			return now + remaining_ms;
+		}
+	}
+
+	return now + LOOP_DELAY_MS;
+}
+
+/**
+ * @brief PDC thread shared by all ports
+ *
+ * Runs a port's state machine when it is woken by pdc_sm_wake() or when its
+ * poll deadline passes. Ports that are busy are polled every LOOP_DELAY_MS,
+ * as the per-port threads do. Idle ports have no deadline.
+ */
+static void pdc_mgr_thread(void *unused1, void *unused2, void *unused3)
+{
+	while (1) {
+		k_timeout_t timeout = K_FOREVER;
+		int64_t next = INT64_MAX;
+		uint32_t ready;
+		int64_t now;
+
+		for (int p = 0; p < CONFIG_USB_PD_PORT_MAX_COUNT; p++) {
+			next = MIN(next, pdc_data[p]->port.next_run_ms);
+		}
+
+		if (next != INT64_MAX) {
+			timeout = K_MSEC(MAX(next - k_uptime_get(), 0));
+		}
+
+		/* Wait for a port to be woken or for the next poll */
+		ready = k_event_wait(&pdc_mgr_event,
+				     BIT_MASK(CONFIG_USB_PD_PORT_MAX_COUNT),
+				     false, timeout);
+		k_event_clear(&pdc_mgr_event, ready);
+
+		now = k_uptime_get();
+		for (int p = 0; p < CONFIG_USB_PD_PORT_MAX_COUNT; p++) {
+			struct pdc_port_t *port = &pdc_data[p]->port;
+
+			if (!(ready & BIT(p)) && port->next_run_ms > now) {
+				continue;
+			}
+
+			pdc_run_port(port);
+			port->next_run_ms = pdc_port_next_run(port, now);
+		}
+	}
+}
+
+/* Static threads start after all devices have been initialized */
+K_THREAD_DEFINE(pdc_mgr_tid, CONFIG_PDC_POWER_MGMT_STACK_SIZE, pdc_mgr_thread,
+		NULL, NULL, NULL, CONFIG_PDC_POWER_MGMT_THREAD_PRIORTY,
+		K_ESSENTIAL, 0);
+#endif /* CONFIG_PDC_POWER_MGMT_SINGLE_THREAD */
+
 /**
  * @brief As a sink, this is the max voltage (in millivolts) we can request
  *        before getting source caps
@@ -988,6 +1192,60 @@ static void print_current_pdc_state(struct pdc_port_t *port)
 		pdc_state_names[get_pdc_state(port)]);
 }
 
+/**
+ * @brief Publish a new snapshot of the port's connection state if it changed
+ *
+ * Only the thread running the port's state machine calls this. The snapshot
+ * is built in the buffer that isn't current and then made current by bumping
+ * the generation, so readers don't need a lock.
+ */
+static void refresh_port_snapshot(struct pdc_port_t *port)
+{
+	atomic_val_t gen = atomic_get(&port->snapshot_gen);
+	const struct pdc_port_snapshot_t *cur = &port->snapshot[gen & 1];
+	struct pdc_port_snapshot_t *next = &port->snapshot[(gen + 1) & 1];
+	bool connected = port->attached_state != UNATTACHED_STATE;
+	bool snk_attached = port->attached_state == SNK_ATTACHED_STATE;
+
+	memset(next, 0, sizeof(*next));
+	next->connected = connected;
+	next->pd_capable = snk_attached ||
+			   port->attached_state == SRC_ATTACHED_STATE;
+	next->snk_attached = snk_attached;
+	next->power_role = (connected &&
+			    port->connector_status.power_direction) ?
+				   PD_ROLE_SOURCE :
+				   PD_ROLE_SINK;
+	if (!connected) {
+		next->data_role = PD_ROLE_DISCONNECTED;
+	} else if (port->connector_status.conn_partner_type == DFP_ATTACHED) {
+		next->data_role = PD_ROLE_UFP;
+	} else {
+		next->data_role = PD_ROLE_DFP;
+	}
+	next->polarity = port->connector_status.orientation ? POLARITY_CC2 :
+							      POLARITY_CC1;
+	next->connector_status = port->connector_status;
+	next->cable_prop = port->cable_prop;
+	if (snk_attached) {
+		if (port->snk_attached_local_state == SNK_ATTACHED_RUN) {
+			next->rdo = port->snk_policy.rdo;
+		}
+		next->src_cap_cnt = port->snk_policy.src.pdo_count;
+		memcpy(next->src_caps, port->snk_policy.src.pdos,
+		       sizeof(port->snk_policy.src.pdos));
+	}
+
+	/* Only start a new generation if something changed */
+	next->generation = cur->generation;
+	if (memcmp(next, cur, sizeof(*next)) == 0) {
+		return;
+	}
+
+	next->generation = gen + 1;
+	atomic_set(&port->snapshot_gen, gen + 1);
+}
+
 static void set_attached_pdc_state(struct pdc_port_t *port,
 				   enum attached_state_t attached_state)
 {
@@ -997,6 +1255,7 @@ static void set_attached_pdc_state(struct pdc_port_t *port,
 		port->attached_state = attached_state;
 		LOG_INF("C%d attached: %s", config->connector_num,
 			attached_state_names[port->attached_state]);
+		refresh_port_snapshot(port);
 	}
 }
 
@@ -1099,7 +1358,7 @@ static int queue_public_cmd(struct pdc_port_t *port, enum pdc_cmd_t pdc_cmd)
 	port->send_cmd.public.error = 0;
 	port->send_cmd.public.pending = true;
 	k_mutex_unlock(&port->mtx);
-	k_event_post(&port->sm_event, PDC_SM_EVENT);
+	pdc_sm_wake(port);
 	return 0;
 }
 
@@ -1114,7 +1373,7 @@ static void queue_internal_cmd(struct pdc_port_t *port, enum pdc_cmd_t pdc_cmd)
 	port->send_cmd.intern.error = 0;
 	port->send_cmd.intern.pending = true;
 	k_mutex_unlock(&port->mtx);
-	k_event_post(&port->sm_event, PDC_SM_EVENT);
+	pdc_sm_wake(port);
 
 	set_pdc_state(port, PDC_SEND_CMD_START);
 }
@@ -1327,7 +1586,7 @@ static void trigger_ppm_status_change(struct pdc_port_t *port)
 
 	/* If trigger CI, we should also refresh the connector status. */
 	atomic_set_bit(port->cci_flags, CCI_EVENT);
-	k_event_post(&port->sm_event, PDC_SM_EVENT);
+	pdc_sm_wake(port);
 
 	port->overlay_ppm_changes.raw_value |= status.raw_value;
 	trigger_ppm_ci(port);
@@ -2561,6 +2820,9 @@ static void pdc_send_cmd_wait_exit(void *obj)
 	atomic_clear_bit(port->cci_flags, CCI_CMD_COMPLETED);
 	port->cmd->pending = false;
 
+	/* The driver has finished writing the command's result */
+	refresh_port_snapshot(port);
+
 	switch (port->cmd->cmd) {
 	case CMD_PDC_GET_PDOS:
 		/* Get pointer to struct for pdos array and count */
@@ -2786,6 +3048,7 @@ static void enforce_pd_chipset_resume_policy_1(int port)
 	 */
 	atomic_set_bit(pdc_data[port]->port.snk_policy.flags,
 		       SNK_POLICY_EVAL_SWAP_TO_SRC);
+	pdc_sm_wake(&pdc_data[port]->port);
 }
 
 /*
@@ -3042,7 +3305,7 @@ static void pdc_cc_handler_cb(const struct device *dev,
 	}
 
 	if (post_event)
-		k_event_post(&port->sm_event, PDC_SM_EVENT);
+		pdc_sm_wake(port);
 }
 
 static void pdc_ci_handler_cb(const struct device *dev,
@@ -3066,7 +3329,7 @@ static void pdc_ci_handler_cb(const struct device *dev,
 	}
 
 	if (post_event)
-		k_event_post(&port->sm_event, PDC_SM_EVENT);
+		pdc_sm_wake(port);
 }
 
 static void init_port_variables(struct pdc_port_t *port,
@@ -3126,8 +3389,13 @@ static int pdc_subsys_init(const struct device *dev)
 	/* Initialize typec only timer */
 	k_timer_init(&port->typec_only_timer, NULL, NULL);
 
+	/* Publish the initial, unattached snapshot */
+	refresh_port_snapshot(port);
+
 	/* Create the thread for this port */
-	config->create_thread(dev);
+	if (config->create_thread) {
+		config->create_thread(dev);
+	}
 
 	return 0;
 }
@@ -3287,6 +3555,7 @@ int pdc_power_mgmt_set_active_charge_port(int charge_port)
 	for (int i = 0; i < CONFIG_USB_PD_PORT_MAX_COUNT; i++) {
 		atomic_set_bit(pdc_data[i]->port.snk_policy.flags,
 			       SNK_POLICY_SET_ACTIVE_CHARGE_PORT);
+		pdc_sm_wake(&pdc_data[i]->port);
 	}
 
 	return EC_SUCCESS;
@@ -3301,6 +3570,7 @@ int pdc_power_mgmt_set_new_power_request(int port)
 
 	atomic_set_bit(pdc_data[port]->port.snk_policy.flags,
 		       SNK_POLICY_NEW_POWER_REQUEST);
+	pdc_sm_wake(&pdc_data[port]->port);
 
 	return EC_SUCCESS;
 }
@@ -3478,42 +3748,42 @@ test_mockable void pdc_power_mgmt_request_power_swap(int port)
 	}
 }
 
+/*
+ * The role and polarity getters back the typec and usbpd host commands, so
+ * they read the snapshot to agree with the connector status reported with
+ * them.
+ */
 test_mockable enum tcpc_cc_polarity pdc_power_mgmt_pd_get_polarity(int port)
 {
-	if (pdc_data[port]->port.connector_status.orientation) {
-		return POLARITY_CC2;
+	struct pdc_port_snapshot_t snapshot;
+
+	if (pdc_power_mgmt_get_snapshot(port, &snapshot)) {
+		return POLARITY_CC1;
 	}
 
-	return POLARITY_CC1;
+	return snapshot.polarity;
 }
 
 test_mockable enum pd_data_role pdc_power_mgmt_pd_get_data_role(int port)
 {
-	/* Make sure port is connected */
-	if (!pdc_power_mgmt_is_connected(port)) {
-		return PD_ROLE_DISCONNECTED;
-	}
+	struct pdc_port_snapshot_t snapshot;
 
-	if (pdc_data[port]->port.connector_status.conn_partner_type ==
-	    DFP_ATTACHED) {
-		return PD_ROLE_UFP;
+	if (pdc_power_mgmt_get_snapshot(port, &snapshot)) {
+		return PD_ROLE_DISCONNECTED;
 	}
 
-	return PD_ROLE_DFP;
+	return snapshot.data_role;
 }
 
 test_mockable enum pd_power_role pdc_power_mgmt_get_power_role(int port)
 {
-	/* Make sure port is connected */
-	if (!pdc_power_mgmt_is_connected(port)) {
-		return PD_ROLE_SINK;
-	}
+	struct pdc_port_snapshot_t snapshot;
 
-	if (pdc_data[port]->port.connector_status.power_direction) {
-		return PD_ROLE_SOURCE;
+	if (pdc_power_mgmt_get_snapshot(port, &snapshot)) {
+		return PD_ROLE_SINK;
 	}
 
-	return PD_ROLE_SINK;
+	return snapshot.power_role;
 }
 
 enum pd_cc_states pdc_power_mgmt_get_task_cc_state(int port)
@@ -3638,38 +3908,56 @@ test_mockable int pdc_power_mgmt_reset(int port)
 
 test_mockable uint8_t pdc_power_mgmt_get_src_cap_cnt(int port)
 {
-	/* Make sure port is Sink connected */
-	if (!pdc_power_mgmt_is_sink_connected(port)) {
+	struct pdc_port_snapshot_t snapshot;
+
+	if (pdc_power_mgmt_get_snapshot(port, &snapshot)) {
 		return 0;
 	}
 
-	return pdc_data[port]->port.snk_policy.src.pdo_count;
+	return snapshot.src_cap_cnt;
 }
 
+/*
+ * The source caps are returned by pointer, so this points into the current
+ * snapshot instead of copying it. The PDC thread only rewrites that buffer
+ * two generations later, and a generation only starts when the connection
+ * state changes. Callers that need the count and caps to agree with each
+ * other under churn should use pdc_power_mgmt_get_snapshot().
+ */
 test_mockable const uint32_t *const pdc_power_mgmt_get_src_caps(int port)
 {
+	struct pdc_port_t *pdc;
+	atomic_val_t gen;
+
 	/* Make sure port is Sink connected */
 	if (!pdc_power_mgmt_is_sink_connected(port)) {
 		return NULL;
 	}
 
-	return (const uint32_t *const)pdc_data[port]->port.snk_policy.src.pdos;
+	pdc = &pdc_data[port]->port;
+	gen = atomic_get(&pdc->snapshot_gen);
+
+	return (const uint32_t *const)pdc->snapshot[gen & 1].src_caps;
 }
 
 test_mockable int pdc_power_mgmt_get_rdo(int port, uint32_t *rdo)
 {
+	struct pdc_port_snapshot_t snapshot;
+
 	if (rdo == NULL) {
 		return -EINVAL;
 	}
 
+	if (pdc_power_mgmt_get_snapshot(port, &snapshot)) {
+		return -ENODATA;
+	}
+
 	/* Make sure port is sink connected and in the run sub-state */
-	if (!(pdc_data[port]->port.attached_state == SNK_ATTACHED_STATE &&
-	      pdc_data[port]->port.snk_attached_local_state ==
-		      SNK_ATTACHED_RUN)) {
+	if (!snapshot.snk_attached || snapshot.rdo == 0) {
 		return -ENODATA;
 	}
 
-	*rdo = pdc_data[port]->port.snk_policy.rdo;
+	*rdo = snapshot.rdo;
 	return 0;
 }
 
@@ -3774,6 +4062,7 @@ test_mockable void pdc_power_mgmt_set_dual_role(int port,
 		       SNK_POLICY_UPDATE_ALLOW_PR_SWAP);
 
 	port_data->dual_role_state = state;
+	pdc_sm_wake(port_data);
 }
 
 test_mockable enum pd_dual_role_states pdc_power_mgmt_get_dual_role(int port)
@@ -4005,6 +4294,8 @@ struct rmdo pdc_power_mgmt_get_partner_rmdo(int port)
 enum pd_discovery_state
 pdc_power_mgmt_get_identity_discovery(int port, enum tcpci_msg_type type)
 {
+	struct pdc_port_t *pdc;
+	atomic_val_t gen;
 	enum pdc_cmd_t cmd;
 	int ret;
 
@@ -4026,14 +4317,28 @@ pdc_power_mgmt_get_identity_discovery(int port, enum tcpci_msg_type type)
 		return PD_DISC_FAIL;
 	}
 
+	/*
+	 * Discovery can't regress without the connection state changing, so
+	 * a completed discovery is good until the snapshot generation moves.
+	 */
+	pdc = &pdc_data[port]->port;
+	gen = atomic_get(&pdc->snapshot_gen);
+	if (atomic_get(&pdc->disc_complete_gen) == gen + 1) {
+		return PD_DISC_COMPLETE;
+	}
+
 	/* Block until command completes */
 	ret = public_api_block(port, cmd);
 	if (ret) {
 		return PD_DISC_NEEDED;
 	}
 
-	return pdc_data[port]->port.discovery_state ? PD_DISC_COMPLETE :
-						      PD_DISC_FAIL;
+	if (!pdc->discovery_state) {
+		return PD_DISC_FAIL;
+	}
+
+	atomic_set(&pdc->disc_complete_gen, gen + 1);
+	return PD_DISC_COMPLETE;
 }
 
 test_mockable int
@@ -4200,6 +4505,7 @@ test_mockable int pdc_power_mgmt_set_comms_state(bool enable_comms)
 		 */
 		for (int p = 0; p < CONFIG_USB_PD_PORT_MAX_COUNT; p++) {
 			atomic_set(&pdc_data[p]->port.suspend, 0);
+			pdc_sm_wake(&pdc_data[p]->port);
 		}
 
 		if (status == 0) {
@@ -4219,6 +4525,7 @@ test_mockable int pdc_power_mgmt_set_comms_state(bool enable_comms)
 		 */
 		for (int p = 0; p < CONFIG_USB_PD_PORT_MAX_COUNT; p++) {
 			atomic_set(&pdc_data[p]->port.suspend, 1);
+			pdc_sm_wake(&pdc_data[p]->port);
 		}
 
 		/* Wait for each PDC state machine to enter suspended state */
@@ -4255,23 +4562,51 @@ test_mockable int pdc_power_mgmt_set_comms_state(bool enable_comms)
 	return status;
 }
 
-test_mockable int
-pdc_power_mgmt_get_connector_status(int port,
-				    union connector_status_t *connector_status)
+int pdc_power_mgmt_get_snapshot(int port, struct pdc_port_snapshot_t *snapshot)
 {
 	struct pdc_port_t *pdc;
+	atomic_val_t gen;
 
 	if (!is_pdc_port_valid(port)) {
 		return -ERANGE;
 	}
 
-	if (connector_status == NULL) {
+	if (snapshot == NULL) {
 		return -EINVAL;
 	}
 
 	pdc = &pdc_data[port]->port;
 
-	*connector_status = pdc->connector_status;
+	/*
+	 * The PDC thread only rewrites this buffer after publishing a newer
+	 * generation, so retry if the generation moved during the copy.
+	 */
+	do {
+		gen = atomic_get(&pdc->snapshot_gen);
+		*snapshot = pdc->snapshot[gen & 1];
+		barrier_dmem_fence_full();
+	} while (atomic_get(&pdc->snapshot_gen) != gen);
+
+	return 0;
+}
+
+test_mockable int
+pdc_power_mgmt_get_connector_status(int port,
+				    union connector_status_t *connector_status)
+{
+	struct pdc_port_snapshot_t snapshot;
+	int rv;
+
+	if (connector_status == NULL) {
+		return -EINVAL;
+	}
+
+	rv = pdc_power_mgmt_get_snapshot(port, &snapshot);
+	if (rv) {
+		return rv;
+	}
+
+	*connector_status = snapshot.connector_status;
 
 	return 0;
 }
@@ -4348,15 +4683,19 @@ test_mockable void pdc_power_mgmt_request_source_voltage(int port, int mv)
 test_mockable int
 pdc_power_mgmt_get_cable_prop(int port, union cable_property_t *cable_prop)
 {
-	if (!is_pdc_port_valid(port)) {
-		return -ERANGE;
-	}
+	struct pdc_port_snapshot_t snapshot;
+	int rv;
 
 	if (cable_prop == NULL) {
 		return -EINVAL;
 	}
 
-	*cable_prop = pdc_data[port]->port.cable_prop;
+	rv = pdc_power_mgmt_get_snapshot(port, &snapshot);
+	if (rv) {
+		return rv;
+	}
+
+	*cable_prop = snapshot.cable_prop;
 
 	return 0;
 }
@@ -4431,6 +4770,8 @@ int pdc_power_mgmt_set_current_limit(int port_num,
 		break;
 	}
 
+	pdc_sm_wake(pdc);
+
 	return EC_SUCCESS;
 }
 
@@ -4449,6 +4790,7 @@ int pdc_power_mgmt_frs_enable(int port_num, bool enable)
 	LOG_INF("C%d, set FRS %d", port_num, enable);
 
 	atomic_set_bit(pdc->snk_policy.flags, SNK_POLICY_UPDATE_FRS);
+	pdc_sm_wake(pdc);
 
 	return EC_SUCCESS;
 }
@@ -4489,7 +4831,7 @@ int pdc_power_mgmt_resync_port_state_for_ppm(int port)
 
 	/* Trigger re-scan of connector status. */
 	atomic_set_bit(pdc->cci_flags, CCI_EVENT);
-	k_event_post(&pdc->sm_event, PDC_SM_EVENT);
+	pdc_sm_wake(pdc);
 
 	rv = k_event_wait(&pdc->sm_event, PDC_SM_SETTLED_EVENT, false,
 			  K_MSEC(PDC_SM_SETTLED_TIMEOUT_MS));
@@ -22,6 +22,9 @@
 
 LOG_MODULE_REGISTER(ppm_common, LOG_LEVEL_INF);
 
+/* Connector maps are 8 bits wide. */
+#define PPM_MAX_CONNECTORS 8
+
 enum last_error_type {
 	/* Error came from LPM; GET_ERROR_STATUS should query the LPM for a
 	 * value.
@@ -73,6 +76,23 @@ struct ucsi_ppm_device {
 	uint8_t last_connector_changed;
 	uint8_t alerted_connectors_map;
 
+	/* OPM has read the status of |last_connector_changed| since it was
+	 * notified.
+	 */
+	bool opm_read_status;
+
+	/* Change bits of |last_connector_changed| returned to the OPM by
+	 * GET_CONNECTOR_STATUS, which are the ones its ACK_CC_CI acks.
+	 */
+	uint16_t opm_read_change_bits;
+
+	/* Connectors with an alert not yet notified, and when it arrived. */
+	uint8_t timed_connectors_map;
+	int64_t alert_ticks[PPM_MAX_CONNECTORS];
+
+	/* Connector change event statistics. */
+	struct ucsi_ppm_event_stats stats;
+
 	/* Data dedicated to UCSI operation. */
 	struct ucsi_memory_region ucsi_data;
 
@@ -202,6 +222,111 @@ static int ppm_common_execute_command_unlocked(struct ucsi_ppm_device *dev,
 	return ret;
 }
 
+/*
+ * Read the status of a 0-indexed port into |per_port_status|. With |merge|,
+ * change bits that haven't been acked yet are kept so that no change is lost
+ * when several alerts are folded into one notification.
+ */
+static void ppm_common_read_connector_status(struct ucsi_ppm_device *dev,
+					     uint8_t port, bool merge)
+{
+	union connector_status_t *port_status = &dev->per_port_status[port];
+	uint16_t unacked =
+		merge ? port_status->raw_conn_status_change_bits : 0;
+	struct ucsi_control_t get_cs_cmd;
+
+	LOG_DBG("Calling GET_CONNECTOR_STATUS on port %d (alerts=0x%x)", port,
+		dev->alerted_connectors_map);
+
+	memset((void *)&get_cs_cmd, 0, sizeof(struct ucsi_control_t));
+	get_cs_cmd.command = UCSI_GET_CONNECTOR_STATUS;
+	get_cs_cmd.data_length = 0x0;
+	get_cs_cmd.command_specific[0] = port + 1;
+
+	/* Clear port status before reading. */
+	memset(port_status, 0, sizeof(union connector_status_t));
+
+	if (ppm_common_execute_command_unlocked(dev, &get_cs_cmd,
+						(uint8_t *)port_status) < 0) {
+		LOG_ERR("Failed to read port %d status. No recovery.",
+			port + 1);
+	} else {
+		LOG_DBG("Port status change on %d: 0x%x", port + 1,
+			port_status->raw_conn_status_change_bits);
+	}
+
+	port_status->raw_conn_status_change_bits |= unacked;
+
+	/* Alerts that the OPM isn't interested in are never notified. */
+	if (!(dev->change_mask.raw_value &
+	      port_status->raw_conn_status_change_bits)) {
+		dev->timed_connectors_map &= ~BIT(port);
+	}
+}
+
+/* Account for the alert to notification latency of a 0-indexed port. */
+static void ppm_common_record_latency(struct ucsi_ppm_device *dev,
+				      uint8_t port)
+{
+	struct ucsi_ppm_event_stats *stats = &dev->stats;
+	uint32_t latency_us;
+
+	stats->notifications++;
+
+	if (!(dev->timed_connectors_map & BIT(port))) {
+		return;
+	}
+
+	dev->timed_connectors_map &= ~BIT(port);
+	latency_us = k_ticks_to_us_floor32(k_uptime_ticks() -
+					   dev->alert_ticks[port]);
+
+	stats->last_latency_us = latency_us;
+	stats->max_latency_us = MAX(stats->max_latency_us, latency_us);
+	stats->total_latency_us += latency_us;
+
+	LOG_DBG("Connector %d notified %u us after alert", port + 1,
+		latency_us);
+}
+
+#ifdef CONFIG_UCSI_PPM_COALESCE_EVENTS
+/*
+ * Read the status of every alerted connector in one pass, so that the next
+ * connector to notify already has its status when the OPM acks the current
+ * one.
+ *
+ * Returns true if |last_connector_changed| must be notified again.
+ */
+static bool ppm_common_prefetch_alerted(struct ucsi_ppm_device *dev)
+{
+	bool renotify = false;
+	uint8_t port;
+
+	while (dev->alerted_connectors_map != 0) {
+		port = find_lsb_set(dev->alerted_connectors_map) - 1;
+		dev->alerted_connectors_map &= ~BIT(port);
+
+		ppm_common_read_connector_status(dev, port, true);
+
+		if (port + 1 != dev->last_connector_changed) {
+			continue;
+		}
+
+		/* Until the OPM reads the status, it will see the merged
+		 * status when it does, so there's nothing new to tell it.
+		 */
+		if (!dev->opm_read_status) {
+			dev->stats.coalesced++;
+			continue;
+		}
+
+		renotify = true;
+	}
+
+	return renotify;
+}
+#endif /* CONFIG_UCSI_PPM_COALESCE_EVENTS */
+
 static void ppm_common_handle_async_event(struct ucsi_ppm_device *dev)
 {
 	uint8_t port;
@@ -221,37 +346,24 @@ static void ppm_common_handle_async_event(struct ucsi_ppm_device *dev)
 	if (dev->ppm_state == PPM_STATE_NOT_READY ||
 	    dev->ppm_state == PPM_STATE_IDLE) {
 		dev->pending.async_event = 0;
+		dev->timed_connectors_map = 0;
 		return;
 	}
 
 	/* Read per-port status if this is a fresh async event from an
 	 * LPM alert.
 	 */
+#ifdef CONFIG_UCSI_PPM_COALESCE_EVENTS
+	if (ppm_common_prefetch_alerted(dev)) {
+		port = dev->last_connector_changed - 1;
+		alert_port = true;
+	}
+#else
 	if (dev->alerted_connectors_map != 0) {
-		struct ucsi_control_t get_cs_cmd;
 		/* Gets 1-indexed lsb and subtracts 1 to get 0-indexed port. */
 		port = find_lsb_set(dev->alerted_connectors_map) - 1;
 
-		LOG_DBG("Calling GET_CONNECTOR_STATUS on port %d (alerts=0x%x)",
-			port, dev->alerted_connectors_map);
-
-		memset((void *)&get_cs_cmd, 0, sizeof(struct ucsi_control_t));
-		get_cs_cmd.command = UCSI_GET_CONNECTOR_STATUS;
-		get_cs_cmd.data_length = 0x0;
-		get_cs_cmd.command_specific[0] = port + 1;
-
-		/* Clear port status before reading. */
-		port_status = &dev->per_port_status[port];
-		memset(port_status, 0, sizeof(union connector_status_t));
-
-		if (ppm_common_execute_command_unlocked(
-			    dev, &get_cs_cmd, (uint8_t *)port_status) < 0) {
-			LOG_ERR("Failed to read port %d status. No recovery.",
-				port + 1);
-		} else {
-			LOG_DBG("Port status change on %d: 0x%x", port + 1,
-				port_status->raw_conn_status_change_bits);
-		}
+		ppm_common_read_connector_status(dev, port, false);
 
 		/* We got alerted with a change for a port we already
 		 * sent notifications for but which has not yet acked.
@@ -263,6 +375,7 @@ static void ppm_common_handle_async_event(struct ucsi_ppm_device *dev)
 
 		dev->alerted_connectors_map &= ~BIT(port);
 	}
+#endif
 
 	/* If we are not already acting on an existing connector change,
 	 * notify the OS if there are any other connector changes.
@@ -299,7 +412,9 @@ static void ppm_common_handle_async_event(struct ucsi_ppm_device *dev)
 		 */
 		dev->last_connector_changed = port + 1;
 		dev->ucsi_data.cci.connector_change = port + 1;
+		dev->opm_read_status = false;
 		ppm_common_opm_notify(dev);
+		ppm_common_record_latency(dev, port);
 
 		/* Set PPM state to waiting for async event ack */
 		dev->ppm_state = PPM_STATE_WAITING_ASYNC_EV_ACK;
@@ -314,6 +429,9 @@ static void ppm_common_reset_data(struct ucsi_ppm_device *dev)
 	clear_last_error(dev);
 	dev->last_connector_changed = 0;
 	dev->alerted_connectors_map = 0;
+	dev->timed_connectors_map = 0;
+	dev->opm_read_status = false;
+	dev->opm_read_change_bits = 0;
 	dev->change_mask.raw_value = 0;
 	memset(&dev->pending, 0, sizeof(dev->pending));
 	memset(dev->per_port_status, 0,
@@ -328,6 +446,7 @@ static int ppm_common_execute_pending_cmd(struct ucsi_ppm_device *dev)
 	uint8_t ucsi_command = control->command;
 	union ack_cc_ci_t *ack_cmd;
 	union notification_enable_t notify;
+	uint8_t conn = control->command_specific[0] & 0x7F;
 	int ret = -1;
 	bool ack_ci = false;
 
@@ -371,6 +490,25 @@ static int ppm_common_execute_pending_cmd(struct ucsi_ppm_device *dev)
 		goto success;
 	case UCSI_CANCEL:
 		goto success;
+#ifdef CONFIG_UCSI_PPM_COALESCE_EVENTS
+	case UCSI_GET_CONNECTOR_STATUS:
+		/* The status of the notified connector was prefetched and is
+		 * current unless another alert is waiting for it.
+		 */
+		if (conn == 0 || conn != dev->last_connector_changed ||
+		    (dev->alerted_connectors_map & BIT(conn - 1))) {
+			break;
+		}
+
+		dev->opm_read_status = true;
+		dev->opm_read_change_bits |=
+			dev->per_port_status[conn - 1]
+				.raw_conn_status_change_bits;
+		ret = sizeof(union connector_status_t);
+		memcpy(message_in, &dev->per_port_status[conn - 1], ret);
+		memset(control, 0, sizeof(struct ucsi_control_t));
+		goto success;
+#endif
 	default:
 		break;
 	}
@@ -378,6 +516,14 @@ static int ppm_common_execute_pending_cmd(struct ucsi_ppm_device *dev)
 	/* Do driver specific execute command. */
 	ret = ppm_common_execute_command_unlocked(dev, control, message_in);
 
+	if (ucsi_command == UCSI_GET_CONNECTOR_STATUS && ret >= 0 &&
+	    conn == dev->last_connector_changed) {
+		dev->opm_read_status = true;
+		dev->opm_read_change_bits |=
+			((union connector_status_t *)message_in)
+				->raw_conn_status_change_bits;
+	}
+
 	/* Clear command since we just executed it. */
 	memset(control, 0, sizeof(struct ucsi_control_t));
 
@@ -438,8 +584,17 @@ success:
 	if (ack_ci) {
 		union connector_status_t *port_status =
 			&dev->per_port_status[dev->last_connector_changed - 1];
+#ifdef CONFIG_UCSI_PPM_COALESCE_EVENTS
+		/* Only the changes the OPM has read are acked, changes merged
+		 * in after that are notified again.
+		 */
+		port_status->raw_conn_status_change_bits &=
+			~dev->opm_read_change_bits;
+#else
 		/* Clear port status for acked connector. */
 		port_status->raw_conn_status_change_bits = 0;
+#endif
+		dev->opm_read_change_bits = 0;
 		dev->last_connector_changed = 0;
 		/* Flag a pending async event to process next event if it
 		 * exists.
@@ -631,10 +786,14 @@ static void ppm_common_handle_pending_command(struct ucsi_ppm_device *dev)
 static void ppm_common_taskloop(struct ucsi_ppm_device *dev)
 {
 	/* We will handle async events only in idle state if there is
-	 * one pending.
+	 * one pending. When coalescing, alerted connectors are also read
+	 * while waiting for a connector change ack.
 	 */
-	bool handle_async_event = (dev->ppm_state <= PPM_STATE_IDLE_NOTIFY) &&
-				  is_pending_async_event(dev);
+	bool async_state =
+		dev->ppm_state <= PPM_STATE_IDLE_NOTIFY ||
+		(IS_ENABLED(CONFIG_UCSI_PPM_COALESCE_EVENTS) &&
+		 dev->ppm_state == PPM_STATE_WAITING_ASYNC_EV_ACK);
+	bool handle_async_event = async_state && is_pending_async_event(dev);
 	/* Wait for a task from OPM unless we are already processing a
 	 * command or we need to fall through for a pending command or
 	 * handleable async event.
@@ -736,6 +895,9 @@ static void ppm_common_taskloop(struct ucsi_ppm_device *dev)
 				dev->ppm_state = PPM_STATE_IDLE_NOTIFY;
 			}
 			ppm_common_handle_pending_command(dev);
+		} else if (IS_ENABLED(CONFIG_UCSI_PPM_COALESCE_EVENTS) &&
+			   is_pending_async_event(dev)) {
+			ppm_common_handle_async_event(dev);
 		}
 		break;
 
@@ -806,6 +968,7 @@ int ucsi_ppm_init_and_wait(struct ucsi_ppm_device *dev)
 	       dev->num_ports * sizeof(union connector_status_t));
 	dev->last_connector_changed = 0;
 	dev->alerted_connectors_map = 0;
+	dev->timed_connectors_map = 0;
 
 	LOG_DBG("Ready to initialize PPM task!");
 
@@ -1005,6 +1168,21 @@ void ucsi_ppm_lpm_alert(struct ucsi_ppm_device *dev, uint8_t lpm_id)
 	k_mutex_lock(&dev->ppm_lock, K_FOREVER);
 
 	if (lpm_id != 0 && lpm_id <= dev->num_ports) {
+		dev->stats.alerts++;
+
+		/* Time from the first alert that hasn't been notified. */
+		if (!(dev->timed_connectors_map & BIT(lpm_id - 1))) {
+			dev->timed_connectors_map |= BIT(lpm_id - 1);
+			dev->alert_ticks[lpm_id - 1] = k_uptime_ticks();
+		}
+
+		/* A burst of alerts before the status is read costs a single
+		 * GET_CONNECTOR_STATUS.
+		 */
+		if (dev->alerted_connectors_map & BIT(lpm_id - 1)) {
+			dev->stats.coalesced++;
+		}
+
 		/* Set async event and mark port status as not read. */
 		dev->pending.async_event = 1;
 		dev->alerted_connectors_map |= BIT(lpm_id - 1);
@@ -1035,9 +1213,27 @@ struct ucsi_ppm_device *ppm_data_init(const struct ucsi_pd_driver *pd_driver,
 	dev.per_port_status = data;
 	dev.num_ports = num_ports;
 
+	__ASSERT(num_ports <= PPM_MAX_CONNECTORS, "Too many connectors: %d",
+		 num_ports);
+
 	return &dev;
 }
 
+void ucsi_ppm_get_event_stats(struct ucsi_ppm_device *dev,
+			      struct ucsi_ppm_event_stats *stats)
+{
+	k_mutex_lock(&dev->ppm_lock, K_FOREVER);
+	*stats = dev->stats;
+	k_mutex_unlock(&dev->ppm_lock);
+}
+
+void ucsi_ppm_clear_event_stats(struct ucsi_ppm_device *dev)
+{
+	k_mutex_lock(&dev->ppm_lock, K_FOREVER);
+	memset(&dev->stats, 0, sizeof(dev->stats));
+	k_mutex_unlock(&dev->ppm_lock);
+}
+
 #ifdef CONFIG_ZTEST
 
 enum ppm_states ppm_test_get_state(const struct ucsi_ppm_device *dev)
@@ -14,6 +14,32 @@
 #include <drivers/ucsi_v3.h>
 #include <usbc/ppm.h>
 
+/* Connector change event statistics. */
+struct ucsi_ppm_event_stats {
+	/* LPM alerts received for valid connectors. */
+	uint32_t alerts;
+
+	/* Connector change notifications sent to the OPM. */
+	uint32_t notifications;
+
+	/* Alerts folded into a status read or notification already pending. */
+	uint32_t coalesced;
+
+	/* Time from the first LPM alert on a connector to the OPM being
+	 * notified about it, in microseconds.
+	 */
+	uint32_t last_latency_us;
+	uint32_t max_latency_us;
+	uint64_t total_latency_us;
+};
+
+/* Get a copy of the connector change event statistics. */
+void ucsi_ppm_get_event_stats(struct ucsi_ppm_device *device,
+			      struct ucsi_ppm_event_stats *stats);
+
+/* Reset the connector change event statistics. */
+void ucsi_ppm_clear_event_stats(struct ucsi_ppm_device *device);
+
 /* Helper functions for testing. */
 #ifdef CONFIG_ZTEST
 /* Get the current state of the state machine. */
@@ -34,6 +34,8 @@ static int power_hard_off_count;
 static int power_shutdown_count;
 static int power_shutdown_complete_count;
 static int power_suspend_count;
+static int64_t power_resume_time;
+static int64_t power_suspend_time;
 
 #define S5_INACTIVITY_TIMEOUT_MS                                               \
 	COND_CODE_0(                                                           \
@@ -106,6 +108,7 @@ static void emul_ev_handler(struct ap_power_ev_callback *callback,
 	switch (data.event) {
 	case AP_POWER_RESUME:
 		power_resume_count++;
+		power_resume_time = k_uptime_get();
 		break;
 
 	case AP_POWER_STARTUP:
@@ -126,6 +129,7 @@ static void emul_ev_handler(struct ap_power_ev_callback *callback,
 
 	case AP_POWER_SUSPEND:
 		power_suspend_count++;
+		power_suspend_time = k_uptime_get();
 		break;
 	default:
 		break;
@@ -140,6 +144,8 @@ static void ap_pwrseq_reset_ev_counters(void)
 	power_shutdown_count = 0;
 	power_shutdown_complete_count = 0;
 	power_suspend_count = 0;
+	power_resume_time = 0;
+	power_suspend_time = 0;
 }
 
 static void verify_ap_inputs(bool in_s0)
@@ -474,6 +480,35 @@ ZTEST(ap_pwrseq, test_insufficient_power_blocks_s5)
 		chipset_in_or_transitioning_to_state(CHIPSET_STATE_HARD_OFF));
 }
 
+/*
+ * Benchmark the G3 to S0 and S0 to S3 transitions against the emulated power
+ * signals. The emulated signal delays are fixed, so any time above them is
+ * added by the power sequencing itself.
+ */
+ZTEST(ap_pwrseq, test_pwrseq_transition_timing)
+{
+	int64_t start;
+
+	zassert_equal(
+		0,
+		power_signal_emul_load(EMUL_POWER_SIGNAL_TEST_PLATFORM(
+			tp_sys_g3_to_s0_power_down)),
+		"Unable to load test platform `tp_sys_g3_to_s0_power_down`");
+
+	start = k_uptime_get();
+	ap_power_exit_hardoff();
+	k_sleep(K_MSEC(S5_INACTIVITY_TIMEOUT_MS * 1.5));
+
+	zassert_equal(1, power_resume_count,
+		      "AP_POWER_RESUME event not generated");
+	zassert_equal(1, power_suspend_count,
+		      "AP_POWER_SUSPEND event not generated");
+	zassert_true(power_suspend_time >= power_resume_time);
+
+	TC_PRINT("G3 to S0: %lld ms\n", power_resume_time - start);
+	TC_PRINT("S0 to S3: %lld ms\n", power_suspend_time - power_resume_time);
+}
+
 void ap_pwrseq_after_test(void *data)
 {
 	power_signal_emul_unload();
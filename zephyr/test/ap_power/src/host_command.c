@@ -3,6 +3,7 @@
  * found in the LICENSE file.
  */
 
+#include "ap_pwrseq_profile.h"
 #include "ec_commands.h"
 #include "emul/emul_stub_device.h"
 #include "host_command.h"
@@ -23,6 +24,53 @@ ZTEST(host_cmd, test_hibernate_get)
 	zassert_equal(123, response.hibernate_delay, NULL);
 }
 
+#ifdef CONFIG_AP_PWRSEQ_PROFILE
+ZTEST(host_cmd, test_ap_pwrseq_profile)
+{
+	struct ec_response_ap_pwrseq_profile response;
+	struct ec_params_ap_pwrseq_profile params = {
+		.cmd = EC_AP_PWRSEQ_PROFILE_CLEAR,
+	};
+
+	zassert_ok(ec_cmd_ap_pwrseq_profile(NULL, &params, &response));
+
+	/* A wait is accounted to the signal, 5 ms goes in the 4-7 ms bucket. */
+	ap_pwrseq_profile_signal_wait(POWER_SIGNAL_MASK(1), 5);
+
+	params.cmd = EC_AP_PWRSEQ_PROFILE_GET_SIGNAL;
+	params.index = 1;
+	zassert_ok(ec_cmd_ap_pwrseq_profile(NULL, &params, &response));
+	zassert_equal(POWER_SIGNAL_COUNT, response.num_signals);
+	zassert_equal(1, response.count);
+	zassert_equal(5, response.total_ms);
+	zassert_equal(5, response.max_ms);
+	zassert_equal(1, response.histogram[3]);
+
+	params.index = POWER_SIGNAL_COUNT;
+	zassert_equal(EC_RES_INVALID_PARAM,
+		      ec_cmd_ap_pwrseq_profile(NULL, &params, &response));
+
+	/* Leaving a state records its residency and the slowest signal. */
+	ap_pwrseq_profile_enter_state(2);
+	k_msleep(10);
+	ap_pwrseq_profile_signal_wait(POWER_SIGNAL_MASK(3), 7);
+	ap_pwrseq_profile_enter_state(3);
+
+	params.cmd = EC_AP_PWRSEQ_PROFILE_GET_STATE;
+	params.index = 2;
+	zassert_ok(ec_cmd_ap_pwrseq_profile(NULL, &params, &response));
+	zassert_equal(1, response.count);
+	zassert_true(response.total_ms >= 10);
+	zassert_equal(7, response.wait_ms);
+	zassert_equal(7, response.slowest_wait_ms);
+	zassert_equal(3, response.slowest_signal);
+
+	params.index = AP_PWRSEQ_PROFILE_MAX_STATES;
+	zassert_equal(EC_RES_INVALID_PARAM,
+		      ec_cmd_ap_pwrseq_profile(NULL, &params, &response));
+}
+#endif /* CONFIG_AP_PWRSEQ_PROFILE */
+
 ZTEST_SUITE(host_cmd, ap_power_predicate_post_main, NULL, NULL, NULL, NULL);
 
 /* These 2 lines are needed because we don't define an espi host driver */
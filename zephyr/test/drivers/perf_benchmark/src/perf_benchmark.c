@@ -0,0 +1,387 @@
+/* Copyright 2024 The ChromiumOS Authors
+ * Use of this source code is governed by a BSD-style license that can be
+ * found in the LICENSE file.
+ */
+
+/*
+ * End-to-end benchmarks of the EC drivers against the I2C emulators.
+ *
+ * Each workload reports its I2C transfers and bytes as seen by the emulator
+ * it talks to, and the time it took in ticks of the kernel clock. I2C
+ * transfers are the deterministic cost on native_sim, which doesn't advance
+ * time while code runs, so each workload fails when it goes over its budget
+ * of transfers. The PD workload also has a latency budget, as negotiation is
+ * paced by the protocol timers. The suite runs with the I2C timing model of
+ * the emulators, so the time includes the bus time of the transfers.
+ */
+
+#include "battery.h"
+#include "charger.h"
+#include "driver/charger/isl923x.h"
+#include "driver/accelgyro_bmi260.h"
+#include "driver/accelgyro_bmi_common.h"
+#include "emul/emul_bmi.h"
+#include "emul/emul_common_i2c.h"
+#include "emul/emul_isl923x.h"
+#include "emul/emul_smart_battery.h"
+#include "emul/tcpc/emul_tcpci.h"
+#include "emul/tcpc/emul_tcpci_partner_src.h"
+#include "i2c.h"
+#include "motion_sense.h"
+#include "motion_sense_fifo.h"
+#include "test/drivers/test_mocks.h"
+#include "test/drivers/test_state.h"
+#include "test/drivers/utils.h"
+#include "usb_pd.h"
+#include "usb_pe_sm.h"
+
+#include <string.h>
+
+#include <zephyr/fff.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#define BMI_NODE DT_NODELABEL(accel_bmi260)
+#define BMI_ACC_SENSOR_ID SENSOR_ID(DT_NODELABEL(ms_bmi260_accel))
+#define BMI_GYR_SENSOR_ID SENSOR_ID(DT_NODELABEL(ms_bmi260_gyro))
+#define BMI_INT_EVENT \
+	TASK_EVENT_MOTION_SENSOR_INTERRUPT(SENSOR_ID(DT_ALIAS(bmi260_int)))
+#define BATTERY_NODE DT_NODELABEL(battery)
+#define TEST_PORT 0
+
+/* Watermark interrupts handled by the sensor FIFO workload */
+#define FIFO_BATCHES 100
+/* Accel and gyro frames per watermark, fits in the driver FIFO buffer */
+#define FIFO_FRAMES_PER_BATCH 4
+/* Iterations of the charger loop workload */
+#define CHARGER_LOOPS 100
+/* Longest time to wait for an explicit contract */
+#define PD_NEGOTIATION_TIMEOUT_MS 5000
+
+/*
+ * Budgets of the workloads, per iteration. They leave headroom over the
+ * current drivers, so that only a real increase of the bus traffic fails.
+ */
+#define FIFO_BATCH_MAX_XFERS 6
+#define CHARGER_LOOP_MAX_XFERS 10
+#define BATTERY_LOOP_MAX_XFERS 24
+#define PD_NEGOTIATION_MAX_XFERS 1000
+#define PD_NEGOTIATION_MAX_MS 2000
+
+/** Cost of a workload on the emulator it talks to */
+struct perf_bench {
+	/** Name printed with the results */
+	const char *name;
+	/** Emulator whose transfers are counted */
+	struct i2c_common_emul_data *target;
+	/** Number of iterations of the workload */
+	uint32_t iterations;
+	/** Kernel ticks at the start and for the whole workload */
+	int64_t start_ticks;
+	int64_t ticks;
+	/** Transfers of the target during the workload */
+	struct i2c_common_emul_stats i2c;
+};
+
+static void perf_begin(struct perf_bench *bench)
+{
+	i2c_common_emul_reset_stats(bench->target);
+	bench->start_ticks = k_uptime_ticks();
+}
+
+static void perf_end(struct perf_bench *bench)
+{
+	bench->ticks = k_uptime_ticks() - bench->start_ticks;
+	i2c_common_emul_get_stats(bench->target, &bench->i2c);
+
+	TC_PRINT("%s: %u iterations in %lld us\n", bench->name,
+		 bench->iterations,
+		 (long long)k_ticks_to_us_floor64(bench->ticks));
+	TC_PRINT("%s: %u I2C transfers, %u written and %u read bytes\n",
+		 bench->name, bench->i2c.transfers, bench->i2c.bytes_written,
+		 bench->i2c.bytes_read);
+	TC_PRINT("%s: bus busy for %lld us\n", bench->name,
+		 (long long)(bench->i2c.bus_ns / NSEC_PER_USEC));
+}
+
+static void perf_check_xfers(struct perf_bench *bench, uint32_t budget)
+{
+	zassert_true(bench->i2c.transfers <= budget * bench->iterations,
+		     "%s: %u I2C transfers over %u iterations, budget is %u each",
+		     bench->name, bench->i2c.transfers, bench->iterations,
+		     budget);
+}
+
+/** Interrupt status reported by the BMI260 on the next read */
+static uint16_t bmi_interrupts;
+
+/** Make the BMI260 report a successful init */
+static int emul_bmi_init_ok(const struct emul *emul, int reg, uint8_t *val,
+			    int byte, void *data)
+{
+	bmi_emul_set_reg(emul, BMI260_INTERNAL_STATUS, BMI260_INIT_OK);
+
+	return 1;
+}
+
+/** Report pending interrupts once, like the watermark of a real FIFO */
+static int emul_bmi_interrupts(const struct emul *emul, int reg, uint8_t *val,
+			       int byte, void *data)
+{
+	if (reg + byte == BMI260_INT_STATUS_0) {
+		bmi_emul_set_reg(emul, BMI260_INT_STATUS_0,
+				 bmi_interrupts & 0xff);
+		bmi_interrupts &= 0xff00;
+	} else if (reg + byte == BMI260_INT_STATUS_1) {
+		bmi_emul_set_reg(emul, BMI260_INT_STATUS_1,
+				 (bmi_interrupts >> 8) & 0xff);
+		bmi_interrupts &= 0xff;
+	}
+
+	return 1;
+}
+
+static const void *init_rom_map_addr_passthru(const void *addr, int size)
+{
+	return addr;
+}
+
+ZTEST(perf_benchmark, test_sensor_fifo_max_odr)
+{
+	const struct emul *emul = EMUL_DT_GET(BMI_NODE);
+	struct i2c_common_emul_data *common_data =
+		emul_bmi_get_i2c_common_data(emul);
+	struct motion_sensor_t *ms_acc = &motion_sensors[BMI_ACC_SENSOR_ID];
+	struct motion_sensor_t *ms_gyr = &motion_sensors[BMI_GYR_SENSOR_ID];
+	struct bmi_emul_frame f[FIFO_FRAMES_PER_BATCH];
+	struct ec_response_motion_sensor_data vector;
+	struct perf_bench bench = {
+		.name = "sensor FIFO",
+		.target = common_data,
+		.iterations = FIFO_BATCHES,
+	};
+	uint32_t samples = 0;
+	uint32_t event;
+	uint16_t size;
+
+	RESET_FAKE(init_rom_map);
+	init_rom_map_fake.custom_fake = init_rom_map_addr_passthru;
+
+	i2c_common_emul_set_read_func(common_data, emul_bmi_init_ok, NULL);
+	zassert_ok(ms_acc->drv->init(ms_acc));
+	zassert_ok(ms_gyr->drv->init(ms_gyr));
+
+	/* Stage every sample, at the highest rate of both sensors */
+	ms_acc->oversampling_ratio = 1;
+	ms_gyr->oversampling_ratio = 1;
+	zassert_ok(ms_acc->drv->set_data_rate(ms_acc, BMI_ACCEL_MAX_FREQ, 0));
+	zassert_ok(ms_gyr->drv->set_data_rate(ms_gyr, BMI_GYRO_MAX_FREQ, 0));
+	motion_sense_fifo_reset();
+
+	i2c_common_emul_set_read_func(common_data, emul_bmi_interrupts, NULL);
+
+	memset(f, 0, sizeof(f));
+	for (int i = 0; i < FIFO_FRAMES_PER_BATCH; i++) {
+		f[i].type = BMI_EMUL_FRAME_ACC | BMI_EMUL_FRAME_GYR;
+		f[i].next = i + 1 < FIFO_FRAMES_PER_BATCH ? &f[i + 1] : NULL;
+	}
+
+	perf_begin(&bench);
+	for (int batch = 0; batch < FIFO_BATCHES; batch++) {
+		for (int i = 0; i < FIFO_FRAMES_PER_BATCH; i++) {
+			f[i].acc_x = BMI_EMUL_1G / (batch + 2);
+			f[i].acc_z = BMI_EMUL_1G;
+			f[i].gyr_y = BMI_EMUL_125_DEG_S / (i + 2);
+		}
+		bmi_emul_append_frame(emul, f);
+		bmi_interrupts = BMI260_FWM_INT;
+
+		event = BMI_INT_EVENT;
+		zassert_ok(ms_acc->drv->irq_handler(ms_acc, &event));
+
+		while (motion_sense_fifo_read(sizeof(vector), 1, &vector,
+					      &size)) {
+			if (vector.flags != MOTIONSENSE_SENSOR_FLAG_TIMESTAMP) {
+				samples++;
+			}
+		}
+	}
+	perf_end(&bench);
+
+	i2c_common_emul_set_read_func(common_data, NULL, NULL);
+	zassert_ok(ms_acc->drv->set_data_rate(ms_acc, 0, 0));
+	zassert_ok(ms_gyr->drv->set_data_rate(ms_gyr, 0, 0));
+
+	zassert_equal(samples, FIFO_BATCHES * FIFO_FRAMES_PER_BATCH * 2,
+		      "Lost samples, got %u", samples);
+	perf_check_xfers(&bench, FIFO_BATCH_MAX_XFERS);
+}
+
+ZTEST(perf_benchmark, test_charger_loop)
+{
+	struct i2c_common_emul_data *charger_data =
+		emul_isl923x_get_i2c_common_data(
+			EMUL_GET_USBC_BINDING(TEST_PORT, chg));
+	struct i2c_common_emul_data *battery_data =
+		emul_smart_battery_get_i2c_common_data(
+			EMUL_DT_GET(BATTERY_NODE));
+	struct perf_bench charger = {
+		.name = "charger loop",
+		.target = charger_data,
+		.iterations = CHARGER_LOOPS,
+	};
+	struct perf_bench battery = {
+		.name = "battery loop",
+		.target = battery_data,
+		.iterations = CHARGER_LOOPS,
+	};
+	struct charger_params chg;
+	struct batt_params batt;
+
+	/*
+	 * Both are timed together, as one iteration of the charge state
+	 * loop reads the charger and the battery back to back.
+	 */
+	perf_begin(&charger);
+	perf_begin(&battery);
+	for (int i = 0; i < CHARGER_LOOPS; i++) {
+		charger_get_params(&chg);
+		battery_get_params(&batt);
+	}
+	perf_end(&charger);
+	perf_end(&battery);
+
+	perf_check_xfers(&charger, CHARGER_LOOP_MAX_XFERS);
+	perf_check_xfers(&battery, BATTERY_LOOP_MAX_XFERS);
+}
+
+struct perf_benchmark_fixture {
+	struct tcpci_partner_data source;
+	struct tcpci_src_emul_data src_ext;
+	bool source_connected;
+	/* Charger bus configuration to restore after the timing test */
+	uint32_t chg_i2c_config;
+	bool chg_i2c_config_saved;
+};
+
+ZTEST_F(perf_benchmark, test_i2c_bus_timing)
+{
+	struct i2c_common_emul_data *common_data =
+		emul_isl923x_get_i2c_common_data(
+			EMUL_GET_USBC_BINDING(TEST_PORT, chg));
+	struct i2c_common_emul_stats stats;
+	uint32_t start;
+	int val;
+
+	zassert_ok(i2c_get_config(common_data->i2c, &fixture->chg_i2c_config));
+	fixture->chg_i2c_config_saved = true;
+
+	/* 10 us per bit, restored in perf_benchmark_after() */
+	zassert_ok(i2c_configure(common_data->i2c,
+				 I2C_SPEED_SET(I2C_SPEED_STANDARD) |
+					 I2C_MODE_CONTROLLER));
+
+	/*
+	 * Register read: START, address, register, repeated START, address,
+	 * two data bytes and STOP is 3 + 5 * 9 bit times.
+	 */
+	i2c_common_emul_reset_stats(common_data);
+	start = k_cycle_get_32();
+	zassert_ok(i2c_read16(chg_chips[0].i2c_port,
+			      chg_chips[0].i2c_addr_flags,
+			      ISL923X_REG_CHG_CURRENT, &val));
+	zassert_true(k_cyc_to_us_floor32(k_cycle_get_32() - start) >= 480);
+	i2c_common_emul_get_stats(common_data, &stats);
+	zassert_equal(stats.bus_ns, 480000, "Bus busy for %lld ns",
+		      (long long)stats.bus_ns);
+
+	/* Add 1 us of stretching per data byte and 50 us before the read */
+	i2c_common_emul_set_clock_stretch(common_data, 1000, 50000);
+	i2c_common_emul_reset_stats(common_data);
+	zassert_ok(i2c_read16(chg_chips[0].i2c_port,
+			      chg_chips[0].i2c_addr_flags,
+			      ISL923X_REG_CHG_CURRENT, &val));
+	i2c_common_emul_set_clock_stretch(common_data, 0, 0);
+	i2c_common_emul_get_stats(common_data, &stats);
+	zassert_equal(stats.bus_ns, 533000, "Bus busy for %lld ns",
+		      (long long)stats.bus_ns);
+}
+
+ZTEST_F(perf_benchmark, test_pd_negotiation)
+{
+	const struct emul *tcpci_emul = EMUL_GET_USBC_BINDING(TEST_PORT, tcpc);
+	const struct emul *charger_emul = EMUL_GET_USBC_BINDING(TEST_PORT, chg);
+	struct perf_bench bench = {
+		.name = "PD negotiation",
+		.target = emul_tcpci_generic_get_i2c_common_data(tcpci_emul),
+		.iterations = 1,
+	};
+	int64_t deadline;
+	int64_t elapsed_ms;
+
+	set_ac_enabled(true);
+
+	perf_begin(&bench);
+	zassert_ok(tcpci_partner_connect_to_tcpci(&fixture->source,
+						  tcpci_emul));
+	fixture->source_connected = true;
+	isl923x_emul_set_adc_vbus(charger_emul,
+				  PDO_FIXED_GET_VOLT(fixture->src_ext.pdo[1]));
+
+	deadline = k_uptime_get() + PD_NEGOTIATION_TIMEOUT_MS;
+	while (!pe_is_explicit_contract(TEST_PORT) &&
+	       k_uptime_get() < deadline) {
+		k_sleep(K_MSEC(1));
+	}
+	perf_end(&bench);
+
+	zassert_true(pe_is_explicit_contract(TEST_PORT),
+		     "No explicit contract after %d ms",
+		     PD_NEGOTIATION_TIMEOUT_MS);
+	elapsed_ms = k_ticks_to_ms_floor64(bench.ticks);
+	zassert_true(elapsed_ms <= PD_NEGOTIATION_MAX_MS,
+		     "PD negotiation took %lld ms, budget is %d ms",
+		     (long long)elapsed_ms, PD_NEGOTIATION_MAX_MS);
+	perf_check_xfers(&bench, PD_NEGOTIATION_MAX_XFERS);
+}
+
+static void *perf_benchmark_setup(void)
+{
+	static struct perf_benchmark_fixture fixture;
+
+	tcpci_partner_init(&fixture.source, PD_REV20);
+	fixture.source.extensions =
+		tcpci_src_emul_init(&fixture.src_ext, &fixture.source, NULL);
+	fixture.src_ext.pdo[1] =
+		PDO_FIXED(20000, 3000, PDO_FIXED_UNCONSTRAINED);
+
+	return &fixture;
+}
+
+static void perf_benchmark_after(void *data)
+{
+	struct perf_benchmark_fixture *fixture = data;
+
+	if (fixture->chg_i2c_config_saved) {
+		struct i2c_common_emul_data *common_data =
+			emul_isl923x_get_i2c_common_data(
+				EMUL_GET_USBC_BINDING(TEST_PORT, chg));
+
+		zassert_ok(i2c_configure(common_data->i2c,
+					 fixture->chg_i2c_config));
+		fixture->chg_i2c_config_saved = false;
+	}
+
+	if (!fixture->source_connected) {
+		return;
+	}
+
+	zassert_ok(tcpci_emul_disconnect_partner(
+		EMUL_GET_USBC_BINDING(TEST_PORT, tcpc)));
+	isl923x_emul_set_adc_vbus(EMUL_GET_USBC_BINDING(TEST_PORT, chg), 0);
+	set_ac_enabled(false);
+	fixture->source_connected = false;
+}
+
+ZTEST_SUITE(perf_benchmark, drivers_predicate_post_main, perf_benchmark_setup,
+	    NULL, perf_benchmark_after, NULL);
@@ -1579,6 +1579,60 @@ ZTEST_USER(pdc_power_mgmt_api, test_get_connector_status)
 				   PDC_TEST_TIMEOUT));
 }
 
+ZTEST_USER(pdc_power_mgmt_api, test_get_snapshot)
+{
+	struct pdc_port_snapshot_t before, after, again;
+	union connector_status_t in = { 0 };
+	union conn_status_change_bits_t in_conn_status_change_bits = { 0 };
+
+	zassert_equal(-ERANGE, pdc_power_mgmt_get_snapshot(
+				       CONFIG_USB_PD_PORT_MAX_COUNT, &before));
+	zassert_equal(-EINVAL, pdc_power_mgmt_get_snapshot(TEST_PORT, NULL));
+
+	zassert_ok(pdc_power_mgmt_get_snapshot(TEST_PORT, &before));
+	zassert_false(before.connected);
+	zassert_equal(PD_ROLE_DISCONNECTED, before.data_role);
+
+	in_conn_status_change_bits.connect_change = 1;
+	in.raw_conn_status_change_bits = in_conn_status_change_bits.raw_value;
+	in.conn_partner_type = UFP_ATTACHED;
+	in.orientation = 1;
+
+	emul_pdc_configure_src(emul, &in);
+	emul_pdc_connect_partner(emul, &in);
+	zassert_ok(pdc_power_mgmt_resync_port_state_for_ppm(TEST_PORT));
+
+	zassert_ok(pdc_power_mgmt_get_snapshot(TEST_PORT, &after));
+	zassert_not_equal(before.generation, after.generation);
+	zassert_true(after.connected);
+	zassert_equal(PD_ROLE_SOURCE, after.power_role);
+	zassert_equal(PD_ROLE_DFP, after.data_role);
+	zassert_equal(POLARITY_CC2, after.polarity);
+	zassert_equal(UFP_ATTACHED, after.connector_status.conn_partner_type);
+	zassert_false(after.snk_attached);
+
+	/* The role and polarity getters report the snapshot */
+	zassert_equal(after.power_role,
+		      pdc_power_mgmt_get_power_role(TEST_PORT));
+	zassert_equal(after.data_role,
+		      pdc_power_mgmt_pd_get_data_role(TEST_PORT));
+	zassert_equal(after.polarity,
+		      pdc_power_mgmt_pd_get_polarity(TEST_PORT));
+	zassert_equal(0, pdc_power_mgmt_get_src_cap_cnt(TEST_PORT));
+
+	/* Nothing changed, so the generation stays the same */
+	zassert_ok(pdc_power_mgmt_get_snapshot(TEST_PORT, &again));
+	zassert_equal(after.generation, again.generation);
+
+	emul_pdc_disconnect(emul);
+	zassert_true(TEST_WAIT_FOR(!pdc_power_mgmt_is_connected(TEST_PORT),
+				   PDC_TEST_TIMEOUT));
+
+	zassert_ok(pdc_power_mgmt_get_snapshot(TEST_PORT, &again));
+	zassert_false(again.connected);
+	zassert_not_equal(after.generation, again.generation);
+}
+
 ZTEST_USER(pdc_power_mgmt_api, test_new_pd_sink_contract)
 {
 	union connector_status_t in = { 0 };
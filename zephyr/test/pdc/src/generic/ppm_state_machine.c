@@ -1172,6 +1172,11 @@ ZTEST_USER_F(ppm_test, test_driver_to_ppm_error_map)
  */
 ZTEST_USER_F(ppm_test, test_simultaneous_lpm_alerts)
 {
+	/* Coalescing reads every alerted connector up front. */
+	if (IS_ENABLED(CONFIG_UCSI_PPM_COALESCE_EVENTS)) {
+		ztest_test_skip();
+	}
+
 	initialize_fake_to_idle_notify(fixture);
 
 	union conn_status_change_bits_t status_bits;
@@ -1270,3 +1275,167 @@ ZTEST_USER_F(ppm_test, test_simultaneous_lpm_alerts)
 	cci.connector_change = PDC_ALTERNATE_CONNECTOR;
 	zassert_true(check_cci_matches(fixture, &cci));
 }
+
+/*
+ * With event coalescing, a burst of alerts is read in a single pass and further
+ * alerts for the notified connector are folded into its pending notification
+ * until the OPM reads the connector status.
+ */
+ZTEST_USER_F(ppm_test, test_coalesce_lpm_alert_burst)
+{
+	union conn_status_change_bits_t status_bits;
+	struct ucsi_ppm_event_stats stats;
+	union connector_status_t *status;
+	uint8_t changed_port_num;
+	int notified_count = 0;
+
+	if (!IS_ENABLED(CONFIG_UCSI_PPM_COALESCE_EVENTS)) {
+		ztest_test_skip();
+	}
+
+	initialize_fake_to_idle_notify(fixture);
+	ucsi_ppm_clear_event_stats(fixture->ppm_dev);
+	fixture->notified_count = 0;
+
+	/* Both connectors are read before the first notification goes out. */
+	queue_expected_connector_change(fixture,
+					PDC_DEFAULT_CONNECTOR_STATUS_CHANGE);
+	queue_expected_connector_change(fixture,
+					PDC_DEFAULT_CONNECTOR_STATUS_CHANGE);
+	ucsi_ppm_lpm_alert(fixture->ppm_dev, PDC_DEFAULT_CONNECTOR);
+	ucsi_ppm_lpm_alert(fixture->ppm_dev, PDC_ALTERNATE_CONNECTOR);
+	zassert_true(wait_for_async_event_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+	zassert_true(k_queue_is_empty(fixture->cmd_queue));
+
+	union cci_event_t cci = { .acknowledge_command = 1,
+				  .connector_change = PDC_DEFAULT_CONNECTOR };
+	zassert_true(check_cci_matches(fixture, &cci));
+
+	/* A new change before the OPM has read the status isn't notified, but
+	 * is merged into the status the OPM will read.
+	 */
+	memset(&status_bits, 0, sizeof(status_bits));
+	status_bits.connect_change = 1;
+	queue_expected_connector_change(fixture, status_bits.raw_value);
+	ucsi_ppm_lpm_alert(fixture->ppm_dev, PDC_DEFAULT_CONNECTOR);
+	zassert_true(wait_for_async_event_to_process(fixture));
+	zassert_false(wait_for_notification(fixture, notified_count + 1));
+
+	zassert_true(ucsi_ppm_get_next_connector_status(
+		fixture->ppm_dev, &changed_port_num, &status));
+	zassert_equal(changed_port_num, PDC_DEFAULT_CONNECTOR);
+	zassert_equal(status->raw_conn_status_change_bits,
+		      PDC_DEFAULT_CONNECTOR_STATUS_CHANGE |
+			      status_bits.raw_value);
+
+	/* Acking notifies the already read alternate connector right away. */
+	queue_command_for_fake_driver(fixture, UCSI_ACK_CC_CI,
+				      /*result=*/0, /*lpm_data=*/NULL);
+	zassert_false(write_ack_command(fixture,
+					/*connector_change_ack*/ true,
+					/*command_complete_ack*/ false) < 0);
+	zassert_true(wait_for_cmd_to_process(fixture));
+	zassert_true(wait_for_async_event_to_process(fixture));
+	notified_count += 2;
+	zassert_true(wait_for_notification(fixture, notified_count));
+
+	cci.connector_change = PDC_ALTERNATE_CONNECTOR;
+	zassert_true(check_cci_matches(fixture, &cci));
+	zassert_true(k_queue_is_empty(fixture->cmd_queue));
+
+	ucsi_ppm_get_event_stats(fixture->ppm_dev, &stats);
+	zassert_equal(stats.alerts, 3);
+	zassert_equal(stats.notifications, 2);
+	zassert_equal(stats.coalesced, 1);
+	zassert_true(stats.max_latency_us >= stats.last_latency_us);
+	zassert_true(stats.total_latency_us >= stats.max_latency_us);
+}
+
+/*
+ * With event coalescing, the status of the notified connector is returned
+ * without asking the LPM, and a change after the OPM has read it is notified
+ * again and survives the ack of the change the OPM read.
+ */
+ZTEST_USER_F(ppm_test, test_coalesce_prefetched_connector_status)
+{
+	union conn_status_change_bits_t status_bits;
+	union connector_status_t status;
+	int notified_count = 0;
+
+	if (!IS_ENABLED(CONFIG_UCSI_PPM_COALESCE_EVENTS)) {
+		ztest_test_skip();
+	}
+
+	initialize_fake_to_idle_notify(fixture);
+	fixture->notified_count = 0;
+
+	trigger_expected_connector_change(fixture, PDC_DEFAULT_CONNECTOR);
+	zassert_true(wait_for_async_event_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+
+	/* Nothing is queued for the fake driver, so a call into it would block
+	 * and fail the command.
+	 */
+	struct ucsi_control_t control = {
+		.command = UCSI_GET_CONNECTOR_STATUS,
+		.data_length = 0,
+		.command_specific = { PDC_DEFAULT_CONNECTOR },
+	};
+	zassert_false(write_command(fixture, &control) < 0);
+	zassert_true(wait_for_cmd_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+
+	union cci_event_t cci = { .command_completed = 1,
+				  .data_len = sizeof(status),
+				  .connector_change = PDC_DEFAULT_CONNECTOR };
+	zassert_true(check_cci_matches(fixture, &cci));
+	zassert_false(read_command_result(fixture, (uint8_t *)&status,
+					  sizeof(status)) < 0);
+	zassert_equal(status.raw_conn_status_change_bits,
+		      PDC_DEFAULT_CONNECTOR_STATUS_CHANGE);
+
+	queue_command_for_fake_driver(fixture, UCSI_ACK_CC_CI,
+				      /*result=*/0, /*lpm_data=*/NULL);
+	zassert_false(write_ack_command(fixture,
+					/*connector_change_ack*/ false,
+					/*command_complete_ack*/ true) < 0);
+	zassert_true(wait_for_cmd_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+
+	/* The OPM has seen the status, so a new change is notified again. */
+	memset(&status_bits, 0, sizeof(status_bits));
+	status_bits.pwr_operation_mode = 1;
+	queue_expected_connector_change(fixture, status_bits.raw_value);
+	ucsi_ppm_lpm_alert(fixture->ppm_dev, PDC_DEFAULT_CONNECTOR);
+	zassert_true(wait_for_async_event_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+	zassert_equal(get_ppm_state(fixture), PPM_STATE_WAITING_ASYNC_EV_ACK);
+
+	/* Acking the change the OPM read keeps the new one pending, and the
+	 * connector is notified again for it.
+	 */
+	queue_command_for_fake_driver(fixture, UCSI_ACK_CC_CI,
+				      /*result=*/0, /*lpm_data=*/NULL);
+	zassert_false(write_ack_command(fixture,
+					/*connector_change_ack*/ true,
+					/*command_complete_ack*/ false) < 0);
+	zassert_true(wait_for_cmd_to_process(fixture));
+	zassert_true(wait_for_async_event_to_process(fixture));
+	notified_count += 2;
+	zassert_true(wait_for_notification(fixture, notified_count));
+
+	cci.command_completed = 0;
+	cci.acknowledge_command = 1;
+	cci.data_len = 0;
+	zassert_true(check_cci_matches(fixture, &cci));
+
+	zassert_false(write_command(fixture, &control) < 0);
+	zassert_true(wait_for_cmd_to_process(fixture));
+	zassert_true(wait_for_notification(fixture, ++notified_count));
+	zassert_false(read_command_result(fixture, (uint8_t *)&status,
+					  sizeof(status)) < 0);
+	zassert_equal(status.raw_conn_status_change_bits,
+		      status_bits.raw_value);
+	zassert_true(k_queue_is_empty(fixture->cmd_queue));
+}
@@ -191,6 +191,44 @@ ZTEST(usb_update, test_bad_digest)
 	zassert_equal(resp, 0);
 }
 
+ZTEST(usb_update, test_pipelined_blocks)
+{
+	const struct queue *rx_queue = usb_update.producer.queue;
+	const struct queue *tx_queue = usb_update.consumer.queue;
+	const struct device *flash_dev =
+		DEVICE_DT_GET(DT_NODELABEL(flashcontroller0));
+	size_t flash_size;
+	uint8_t *flash = flash_simulator_get_memory(flash_dev, &flash_size);
+	struct first_response_pdu first_response_pdu;
+	struct update_frame_header pdu;
+	uint8_t buf[5 + sizeof(pdu)];
+	uint8_t resp[2];
+
+	/* send first pdu */
+	send_pdu(0, 0, 0);
+	zassert_equal(queue_count(tx_queue), sizeof(first_response_pdu));
+	queue_remove_units(tx_queue, &first_response_pdu,
+			   sizeof(first_response_pdu));
+	zassert_equal(first_response_pdu.return_value, 0);
+
+	/* the end of the first block arrives along with the second header */
+	send_pdu(5, 0, CONFIG_RW_MEM_OFF);
+	pdu.block_size = sys_cpu_to_be32(sizeof(pdu) + 5);
+	pdu.cmd.block_digest = 0;
+	pdu.cmd.block_base = sys_cpu_to_be32(CONFIG_RW_MEM_OFF + 5);
+	memcpy(buf, "Hello", 5);
+	memcpy(buf + 5, &pdu, sizeof(pdu));
+	queue_add_units(rx_queue, buf, sizeof(buf));
+	queue_add_units(rx_queue, "World", 5);
+
+	/* both blocks are confirmed, in order */
+	zassert_equal(queue_count(tx_queue), 2);
+	queue_remove_units(tx_queue, resp, 2);
+	zassert_equal(resp[0], 0);
+	zassert_equal(resp[1], 0);
+	zassert_mem_equal(flash + CONFIG_RW_MEM_OFF, "HelloWorld", 10);
+}
+
 ZTEST(usb_update, test_rwsig_busy)
 {
 	const struct queue *tx_queue = usb_update.consumer.queue;
@@ -8,6 +8,7 @@
 #include "fakes.h"
 #include "queue.h"
 #include "rollback.h"
+#include "sha256.h"
 #include "system.h"
 #include "update_fw.h"
 #include "usb-stream.h"
@@ -243,6 +244,133 @@ ZTEST(vendor_command, test_unlock_rollback)
 	zassert_equal(resp, EC_SUCCESS);
 }
 
+ZTEST(vendor_command, test_get_flash_hash)
+{
+	const struct queue *tx_queue = usb_update.consumer.queue;
+	const struct device *flash_dev =
+		DEVICE_DT_GET(DT_NODELABEL(flashcontroller0));
+	size_t flash_size;
+	uint8_t *flash = flash_simulator_get_memory(flash_dev, &flash_size);
+	struct update_flash_hash_request req;
+	uint8_t resp[1 + SHA256_DIGEST_SIZE];
+	struct sha256_ctx ctx;
+
+	/* RO is running, so RW is the image that can be hashed */
+	system_get_image_copy_fake.return_val = EC_IMAGE_RO;
+	memset(flash + CONFIG_RW_MEM_OFF, 'A', CONFIG_FLASH_ERASE_SIZE);
+	SHA256_init(&ctx);
+	SHA256_update(&ctx, flash + CONFIG_RW_MEM_OFF, CONFIG_FLASH_ERASE_SIZE);
+
+	req.offset = sys_cpu_to_be32(CONFIG_RW_MEM_OFF);
+	req.size = sys_cpu_to_be32(CONFIG_FLASH_ERASE_SIZE);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), sizeof(resp));
+	queue_remove_units(tx_queue, resp, sizeof(resp));
+	zassert_equal(resp[0], EC_RES_SUCCESS);
+	zassert_mem_equal(resp + 1, SHA256_final(&ctx), SHA256_DIGEST_SIZE);
+
+	/* fail if the range is empty */
+	req.size = 0;
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+
+	/* fail if the range is not made of whole erase banks */
+	req.size = sys_cpu_to_be32(5);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+
+	req.offset = sys_cpu_to_be32(CONFIG_RW_MEM_OFF + 4);
+	req.size = sys_cpu_to_be32(CONFIG_FLASH_ERASE_SIZE);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+
+	/* fail outside of the image that can be updated */
+	req.offset = sys_cpu_to_be32(CONFIG_RO_MEM_OFF);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+
+	req.offset = sys_cpu_to_be32(CONFIG_ROLLBACK_OFF);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+
+	req.offset = sys_cpu_to_be32(CONFIG_RW_MEM_OFF + CONFIG_RW_SIZE -
+				     CONFIG_FLASH_ERASE_SIZE);
+	req.size = sys_cpu_to_be32(CONFIG_FLASH_ERASE_SIZE * 2);
+	send_vendor_command(UPDATE_EXTRA_CMD_GET_FLASH_HASH, &req,
+			    sizeof(req));
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, resp, 1);
+	zassert_equal(resp[0], UPDATE_GEN_ERROR);
+}
+
+ZTEST(vendor_command, test_sparse_update)
+{
+	const struct queue *rx_queue = usb_update.producer.queue;
+	const struct queue *tx_queue = usb_update.consumer.queue;
+	const struct device *flash_dev =
+		DEVICE_DT_GET(DT_NODELABEL(flashcontroller0));
+	size_t flash_size;
+	uint8_t *flash = flash_simulator_get_memory(flash_dev, &flash_size);
+	struct update_sparse_response sparse_resp;
+	struct first_response_pdu first_response_pdu;
+	struct update_frame_header pdu = {};
+	uint8_t resp;
+
+	system_get_image_copy_fake.return_val = EC_IMAGE_RO;
+	memset(flash + CONFIG_RW_MEM_OFF, 'A', CONFIG_FLASH_ERASE_SIZE * 2);
+
+	send_vendor_command(UPDATE_EXTRA_CMD_SPARSE_UPDATE, NULL, 0);
+	zassert_equal(queue_count(tx_queue), sizeof(sparse_resp));
+	queue_remove_units(tx_queue, &sparse_resp, sizeof(sparse_resp));
+	zassert_equal(sparse_resp.status, EC_RES_SUCCESS);
+	zassert_equal(sys_be32_to_cpu(sparse_resp.erase_size),
+		      CONFIG_FLASH_ERASE_SIZE);
+
+	/* send first pdu */
+	pdu.block_size = sys_cpu_to_be32(sizeof(pdu));
+	queue_add_units(rx_queue, &pdu, sizeof(pdu));
+	zassert_equal(queue_count(tx_queue), sizeof(first_response_pdu));
+	queue_remove_units(tx_queue, &first_response_pdu,
+			   sizeof(first_response_pdu));
+	zassert_equal(first_response_pdu.return_value, 0);
+
+	/* sparse mode can't be requested for a running session */
+	send_vendor_command(UPDATE_EXTRA_CMD_SPARSE_UPDATE, NULL, 0);
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, &resp, 1);
+	zassert_equal(resp, EC_RES_BUSY);
+
+	/* write to the first bank only */
+	pdu.block_size = sys_cpu_to_be32(sizeof(pdu) + 5);
+	pdu.cmd.block_base = sys_cpu_to_be32(CONFIG_RW_MEM_OFF);
+	queue_add_units(rx_queue, &pdu, sizeof(pdu));
+	queue_add_units(rx_queue, "Hello", 5);
+	zassert_equal(queue_count(tx_queue), 1);
+	queue_remove_units(tx_queue, &resp, 1);
+	zassert_equal(resp, 0);
+
+	/* the first bank was erased, the second one was left alone */
+	zassert_mem_equal(flash + CONFIG_RW_MEM_OFF, "Hello", 5);
+	zassert_equal(flash[CONFIG_RW_MEM_OFF + 5], 0xff);
+	zassert_equal(flash[CONFIG_RW_MEM_OFF + CONFIG_FLASH_ERASE_SIZE], 'A');
+}
+
 static void vendor_command_before(void *f)
 {
 	const struct device *flash_dev =